@@ -2,6 +2,9 @@
 
 
 #include "GTAIController.h"
+#include "GTCharacterMovementComponent.h"
+#include "GTPawnMovementManager.h"
+#include "GameFramework/Character.h"
 
 AGTAIController::AGTAIController()
 {
@@ -50,6 +53,23 @@ void AGTAIController::UpdateControlRotation(float DeltaTime, bool bUpdatePawn)
 	}
 }
 
+int32 AGTAIController::GetTargetUnitId() const
+{
+	// Targets are searched for every unit at once by the manager, the controller only reads its unit's result.
+	const ACharacter* Character = Cast<ACharacter>(GetPawn());
+	const UGTCharacterMovementComponent* MovementComponent = Character ? Cast<UGTCharacterMovementComponent>(Character->GetCharacterMovement()) : nullptr;
+	const AGTPawnMovementManager* Manager = MovementComponent ? AGTPawnMovementManager::Get(GetWorld()) : nullptr;
+	return Manager ? Manager->GetUnitTarget(MovementComponent->GetUnitId()) : INDEX_NONE;
+}
+
+APawn* AGTAIController::GetTargetPawn() const
+{
+	const int32 TargetUnitId = GetTargetUnitId();
+	const AGTPawnMovementManager* Manager = TargetUnitId != INDEX_NONE ? AGTPawnMovementManager::Get(GetWorld()) : nullptr;
+	const UGTCharacterMovementComponent* TargetMovement = Manager ? Manager->GetUnitMovementComponent(TargetUnitId) : nullptr;
+	return TargetMovement ? TargetMovement->GetPawnOwner() : nullptr;
+}
+
 void AGTAIController::BeginPlay()
 {
 	Super::BeginPlay();
@@ -13,6 +13,12 @@ class GITTEST_API AGTAIController : public AAIController
 
 	AGTAIController();
 	virtual void UpdateControlRotation(float DeltaTime, bool bUpdatePawn) override;
+public:
+	/** Unit id of the closest hostile unit in range of the controlled unit, INDEX_NONE without one. */
+	int32 GetTargetUnitId() const;
+
+	/** Pawn of that unit, nullptr without a target or while the target is an entity unit without an actor. */
+	APawn* GetTargetPawn() const;
 protected:
 	virtual void BeginPlay() override;
 };
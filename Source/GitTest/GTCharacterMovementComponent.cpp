@@ -33,16 +33,10 @@ void UGTCharacterMovementComponent::BeginPlay()
 	Super::BeginPlay();
 	SetComponentTickEnabled(false);
 
-	TArray<AActor*> Actors;
-	UGameplayStatics::GetAllActorsOfClass(GetWorld(), AGTPawnMovementManager::StaticClass(), Actors);
-
-	if(Actors.IsValidIndex(0)&&(Actors[0]))
+	if(AGTPawnMovementManager* MovementManager = AGTPawnMovementManager::Get(GetWorld()))
 	{
-		if(AGTPawnMovementManager* MovementManager = Cast<AGTPawnMovementManager>(Actors[0]))
-		{
-			PawnMovementManager = MovementManager;
-			MovementManager->MovementComponents.Add(this);
-		}
+		PawnMovementManager = MovementManager;
+		MovementManager->RegisterMovementComponent(this);
 	}
 	else
 	{
@@ -56,10 +50,59 @@ void UGTCharacterMovementComponent::EndPlay(const EEndPlayReason::Type EndPlayRe
 
 	if(IsValid(PawnMovementManager))
 	{
-		PawnMovementManager->MovementComponents.Remove(this);
+		PawnMovementManager->UnregisterMovementComponent(this);
 	}
 }
 
+bool UGTCharacterMovementComponent::CanUseHotNavWalking() const
+{
+	// Anything PerformMovement does besides following the navmesh at the requested velocity keeps the unit on it.
+	return HasValidData() && MovementMode == MOVE_NavWalking && !bProjectNavMeshWalking && !bUseRVOAvoidance
+		&& CharacterOwner->GetLocalRole() == ROLE_Authority && !CharacterOwner->IsPlayerControlled()
+		&& (CharacterOwner->Controller != nullptr || bRunPhysicsWithNoController)
+		&& !UpdatedComponent->IsSimulatingPhysics() && !IsAsyncCallbackRegistered()
+		&& !HasAnimRootMotion() && !CurrentRootMotion.HasActiveRootMotionSources()
+		&& PendingLaunchVelocity.IsZero() && PendingImpulseToApply.IsZero() && PendingForceToApply.IsZero();
+}
+
+void UGTCharacterMovementComponent::RefreshMovementState()
+{
+	if (IsValid(PawnMovementManager))
+	{
+		PawnMovementManager->MarkMovementStateDirty(UnitId);
+	}
+}
+
+void UGTCharacterMovementComponent::Launch(FVector const& LaunchVel)
+{
+	Super::Launch(LaunchVel);
+	RefreshMovementState();
+}
+
+void UGTCharacterMovementComponent::AddImpulse(FVector Impulse, bool bVelocityChange)
+{
+	Super::AddImpulse(Impulse, bVelocityChange);
+	RefreshMovementState();
+}
+
+void UGTCharacterMovementComponent::AddForce(FVector Force)
+{
+	Super::AddForce(Force);
+	RefreshMovementState();
+}
+
+void UGTCharacterMovementComponent::OnTeleported()
+{
+	Super::OnTeleported();
+	RefreshMovementState();
+}
+
+void UGTCharacterMovementComponent::OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode)
+{
+	Super::OnMovementModeChanged(PreviousMovementMode, PreviousCustomMode);
+	RefreshMovementState();
+}
+
 void UGTCharacterMovementComponent::PerformMovement(float DeltaSeconds)
 {
 	const UWorld* MyWorld = GetWorld();
@@ -34,13 +34,36 @@ public:
 	 */
 	virtual void ServerAutonomousProxyTick(float DeltaSeconds) { }
 
+	/** Id of this unit in the movement manager, INDEX_NONE while unregistered. */
+	int32 GetUnitId() const { return UnitId; }
+
+	/** Whether the movement manager can move this unit from its hot record instead of PerformMovement. */
+	bool CanUseHotNavWalking() const;
+
+	/**
+	 * Makes the movement manager read this component's state again before the unit's next update.
+	 * Call it after changing movement parameters such as MaxWalkSpeed or GroundFriction, after starting root motion, or
+	 * after moving the actor without teleporting it.
+	 */
+	void RefreshMovementState();
+
+	virtual void Launch(FVector const& LaunchVel) override;
+	virtual void AddImpulse(FVector Impulse, bool bVelocityChange = false) override;
+	virtual void AddForce(FVector Force) override;
+	virtual void OnTeleported() override;
+
 protected:
 	
 	virtual void BeginPlay() override;
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode) override;
 
 private:
+	friend class AGTPawnMovementManager;
+
 	UPROPERTY()
 	AGTPawnMovementManager* PawnMovementManager;
 
+	int32 UnitId = INDEX_NONE;
+
 };
@@ -18,7 +18,10 @@ AGTCharacterUnit::AGTCharacterUnit()
 	
 	SkeletalMeshComponent = CreateDefaultSubobject<USkeletalMeshComponent>("Skeletal Mesh");
 	SkeletalMeshComponent->SetupAttachment(CapsuleComponent);
-	SkeletalMeshComponent->PrimaryComponentTick.bCanEverTick = false;
+	// The manager's crowd animation decides whether and how often the mesh ticks.
+	SkeletalMeshComponent->PrimaryComponentTick.bCanEverTick = true;
+	SkeletalMeshComponent->PrimaryComponentTick.bStartWithTickEnabled = false;
+	SkeletalMeshComponent->bEnableUpdateRateOptimizations = true;
 	SkeletalMeshComponent->bUseAttachParentBound = true;
 	
 	PawnMovementComponent = CreateDefaultSubobject<UGTPawnMovementComponent>("Pawn");
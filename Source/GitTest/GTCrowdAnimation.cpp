@@ -0,0 +1,114 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GTCrowdAnimation.h"
+
+#include "Animation/AnimSequenceBase.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkeletalMesh.h"
+
+void FGTCrowdAnimation::SetOwnAnimation(FGTUnitAnimation& Unit, int32 UpdateRate) const
+{
+	const uint8 Rate = static_cast<uint8>(FMath::Clamp(UpdateRate, 1, static_cast<int32>(MAX_uint8)));
+	if (Unit.Leader == INDEX_NONE && Unit.UpdateRate == Rate)
+	{
+		return;
+	}
+
+	USkeletalMeshComponent& Mesh = *Unit.Mesh;
+	if (Unit.Leader != INDEX_NONE)
+	{
+		Mesh.SetLeaderPoseComponent(nullptr);
+		Unit.Leader = INDEX_NONE;
+	}
+
+	// The rate comes from the unit's budget rather than the mesh's screen size.
+	Mesh.bEnableUpdateRateOptimizations = true;
+	Mesh.EnableExternalTickRateControl(true);
+	Mesh.SetExternalTickRate(Rate);
+	Mesh.EnableExternalInterpolation(bInterpolateSkippedFrames && Rate > 1);
+	Mesh.SetComponentTickEnabled(true);
+	Unit.UpdateRate = Rate;
+}
+
+void FGTCrowdAnimation::SetSharedAnimation(FGTUnitAnimation& Unit, EGTCrowdAnimState State, int32 PhaseBucket, AActor& Owner)
+{
+	USkeletalMesh* SkeletalMesh = Unit.Mesh->GetSkeletalMeshAsset();
+	if (SkeletalMesh == nullptr)
+	{
+		return;
+	}
+
+	const int32 Leader = FindOrCreateLeader(*SkeletalMesh, State, PhaseBucket % FMath::Max(NumPhaseBuckets, 1), Owner);
+	if (Leader == Unit.Leader)
+	{
+		return;
+	}
+
+	Unit.Mesh->SetComponentTickEnabled(false);
+	Unit.Mesh->SetLeaderPoseComponent(Leaders[Leader]);
+	Unit.Leader = Leader;
+	Unit.UpdateRate = 0;
+}
+
+void FGTCrowdAnimation::Release(FGTUnitAnimation& Unit) const
+{
+	if (!IsValid(Unit.Mesh))
+	{
+		return;
+	}
+
+	if (Unit.Leader != INDEX_NONE)
+	{
+		Unit.Mesh->SetLeaderPoseComponent(nullptr);
+	}
+	Unit.Mesh->EnableExternalTickRateControl(false);
+	Unit.Mesh->SetComponentTickEnabled(false);
+	Unit.Leader = INDEX_NONE;
+	Unit.UpdateRate = 0;
+}
+
+void FGTCrowdAnimation::Reset()
+{
+	for (USkeletalMeshComponent* Leader : Leaders)
+	{
+		if (IsValid(Leader))
+		{
+			Leader->DestroyComponent();
+		}
+	}
+	Leaders.Reset();
+	LeaderIndices.Reset();
+}
+
+void FGTCrowdAnimation::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	Collector.AddReferencedObjects(Leaders);
+}
+
+int32 FGTCrowdAnimation::FindOrCreateLeader(USkeletalMesh& SkeletalMesh, EGTCrowdAnimState State, int32 PhaseBucket, AActor& Owner)
+{
+	const FLeaderKey Key{&SkeletalMesh, State, PhaseBucket};
+	if (const int32* Index = LeaderIndices.Find(Key))
+	{
+		return *Index;
+	}
+
+	// Never drawn, but evaluated every frame for the meshes that copy it.
+	USkeletalMeshComponent* Leader = NewObject<USkeletalMeshComponent>(&Owner);
+	Leader->SetSkeletalMesh(&SkeletalMesh);
+	Leader->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+	Leader->SetVisibility(false);
+	Leader->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Leader->RegisterComponent();
+
+	if (UAnimSequenceBase* Animation = State == EGTCrowdAnimState::Jog ? JogAnimation : IdleAnimation)
+	{
+		Leader->PlayAnimation(Animation, true);
+		Leader->SetPosition(Animation->GetPlayLength() * PhaseBucket / FMath::Max(NumPhaseBuckets, 1), false);
+	}
+
+	const int32 Index = Leaders.Add(Leader);
+	LeaderIndices.Add(Key, Index);
+	return Index;
+}
@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AActor;
+class UAnimSequenceBase;
+class USkeletalMesh;
+class USkeletalMeshComponent;
+
+/** Animation state a shared pose is played for, picked from the unit's speed. */
+enum class EGTCrowdAnimState : uint8
+{
+	Idle,
+	Jog,
+	Num
+};
+
+/** How the crowd animation last set up one unit's mesh. */
+struct FGTUnitAnimation
+{
+	USkeletalMeshComponent* Mesh = nullptr;
+	/** Leader the mesh copies its pose from, INDEX_NONE while it evaluates its own animation. */
+	int32 Leader = INDEX_NONE;
+	/** Frames between evaluations of the mesh's own animation, 0 while it was never given one. */
+	uint8 UpdateRate = 0;
+};
+
+/**
+ * Animation for meshes that do not tick on their own, set up per unit in one of two ways.
+ * A unit with its own animation ticks its mesh with update rate optimizations driven from outside: the anim instance
+ * is evaluated every UpdateRate frames and the bones are interpolated in between, so a unit further down the budget
+ * keeps moving smoothly at a fraction of the cost.
+ * A unit with a shared animation does not tick at all and copies the pose of a hidden leader mesh. There is one leader
+ * per skeletal mesh, state and phase bucket, so a crowd of a thousand joggers costs a handful of evaluations, and the
+ * phase buckets keep neighbours from stepping in lockstep.
+ */
+class GITTEST_API FGTCrowdAnimation
+{
+public:
+	/** Played by the leaders of each state, a state without an animation holds the reference pose. */
+	UAnimSequenceBase* IdleAnimation = nullptr;
+	UAnimSequenceBase* JogAnimation = nullptr;
+	/** Leaders per skeletal mesh and state, each starting its animation further along. */
+	int32 NumPhaseBuckets = 4;
+	bool bInterpolateSkippedFrames = true;
+
+	/** Evaluates the mesh's own animation every UpdateRate frames. */
+	void SetOwnAnimation(FGTUnitAnimation& Unit, int32 UpdateRate) const;
+
+	/** Makes the mesh copy the pose of the leader for State and PhaseBucket, created as a component of Owner if needed. */
+	void SetSharedAnimation(FGTUnitAnimation& Unit, EGTCrowdAnimState State, int32 PhaseBucket, AActor& Owner);
+
+	/** Hands the mesh back without a leader or ticking, as the unit's actor set it up. */
+	void Release(FGTUnitAnimation& Unit) const;
+
+	/** Destroys every leader. Meshes that followed them have to be released or set up again. */
+	void Reset();
+
+	TConstArrayView<USkeletalMeshComponent*> GetLeaders() const { return Leaders; }
+
+	void AddReferencedObjects(FReferenceCollector& Collector);
+
+private:
+	struct FLeaderKey
+	{
+		const USkeletalMesh* SkeletalMesh;
+		EGTCrowdAnimState State;
+		int32 PhaseBucket;
+
+		bool operator==(const FLeaderKey& Other) const
+		{
+			return SkeletalMesh == Other.SkeletalMesh && State == Other.State && PhaseBucket == Other.PhaseBucket;
+		}
+
+		friend uint32 GetTypeHash(const FLeaderKey& Key)
+		{
+			return HashCombine(HashCombine(GetTypeHash(Key.SkeletalMesh), GetTypeHash(Key.State)), GetTypeHash(Key.PhaseBucket));
+		}
+	};
+
+	int32 FindOrCreateLeader(USkeletalMesh& SkeletalMesh, EGTCrowdAnimState State, int32 PhaseBucket, AActor& Owner);
+
+	TArray<USkeletalMeshComponent*> Leaders;
+	TMap<FLeaderKey, int32> LeaderIndices;
+};
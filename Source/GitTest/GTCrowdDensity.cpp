@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GTCrowdDensity.h"
+#include "GTFrameArena.h"
+
+DECLARE_CYCLE_STAT(TEXT("FGTCrowdDensity Update"), STAT_FGTCrowdDensity_Update, STATGROUP_Game);
+
+void FGTCrowdDensity::Initialize(const FBox& Bounds)
+{
+	if (!Bounds.IsValid)
+	{
+		Densities.Reset();
+		Layout.Reset();
+		return;
+	}
+
+	Layout.Initialize(Bounds, CellSize, MaxCellsPerAxis);
+	Densities.SetNumZeroed(Layout.Num());
+}
+
+void FGTCrowdDensity::Update(TConstArrayView<FVector2f> Locations, float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FGTCrowdDensity_Update);
+	if (Densities.Num() == 0)
+	{
+		return;
+	}
+
+	FGTFrameArenaScope ArenaScope;
+	TGTFrameArray<uint16> Counts;
+	Counts.SetNumZeroed(Densities.Num());
+	for (const FVector2f& Location : Locations)
+	{
+		const int32 CellIndex = Layout.GetCellIndex(Location);
+		if (CellIndex != INDEX_NONE)
+		{
+			uint16& Count = Counts[CellIndex];
+			Count = Count < MAX_uint16 ? Count + 1 : Count;
+		}
+	}
+
+	const float Alpha = SmoothingTime > 0.f ? FMath::Min(DeltaTime / SmoothingTime, 1.f) : 1.f;
+	for (int32 CellIndex = 0; CellIndex < Densities.Num(); ++CellIndex)
+	{
+		Densities[CellIndex] += (Counts[CellIndex] - Densities[CellIndex]) * Alpha;
+	}
+}
+
+float FGTCrowdDensity::GetDensity(const FVector2f& Location) const
+{
+	const int32 CellIndex = Layout.GetCellIndex(Location);
+	return CellIndex != INDEX_NONE ? Densities[CellIndex] : 0.f;
+}
+
+#if WITH_RECAST
+FGTCongestionQueryFilter::FGTCongestionQueryFilter(const FRecastQueryFilter& Source, const TSharedPtr<const FGTCrowdDensity, ESPMode::ThreadSafe>& InDensity)
+	: FRecastQueryFilter(/*bIsVirtual=*/true)
+	, Density(InDensity)
+{
+	// Only the filter data is copied, the default filter is usually not virtual and getVirtualCost would never be called.
+	copyFrom(&Source);
+}
+
+INavigationQueryFilterInterface* FGTCongestionQueryFilter::CreateCopy() const
+{
+	return new FGTCongestionQueryFilter(*this);
+}
+
+dtReal FGTCongestionQueryFilter::getVirtualCost(const dtReal* pa, const dtReal* pb,
+                                                const dtPolyRef prevRef, const dtMeshTile* prevTile, const dtPoly* prevPoly,
+                                                const dtPolyRef curRef, const dtMeshTile* curTile, const dtPoly* curPoly,
+                                                const dtPolyRef nextRef, const dtMeshTile* nextTile, const dtPoly* nextPoly) const
+{
+	const dtReal Cost = FRecastQueryFilter::getVirtualCost(pa, pb, prevRef, prevTile, prevPoly, curRef, curTile, curPoly, nextRef, nextTile, nextPoly);
+	if (!Density.IsValid())
+	{
+		return Cost;
+	}
+
+	// Recast space is Y up with X and Z negated, the midpoint of the step in Unreal coordinates.
+	const FVector2f Midpoint(-(pa[0] + pb[0]) * 0.5f, -(pa[2] + pb[2]) * 0.5f);
+	return Cost * Density->GetCostMultiplier(Midpoint);
+}
+#endif // WITH_RECAST
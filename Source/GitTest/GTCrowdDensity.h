@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GTGridLayout.h"
+#include "NavMesh/RecastQueryFilter.h"
+
+/**
+ * Coarse grid of how many units stood in each cell lately, over a fixed area so a cell keeps its meaning from frame
+ * to frame. Counts are smoothed over SmoothingTime, so a crowd passing through fades instead of vanishing.
+ */
+class GITTEST_API FGTCrowdDensity
+{
+public:
+	/** Covers Bounds and clears every cell. */
+	void Initialize(const FBox& Bounds);
+	bool IsInitialized() const { return Densities.Num() > 0; }
+
+	/** Counts the units at Locations this frame and blends the counts into the smoothed densities. */
+	void Update(TConstArrayView<FVector2f> Locations, float DeltaTime);
+
+	/** Smoothed units in the cell containing Location, zero outside the grid. */
+	float GetDensity(const FVector2f& Location) const;
+
+	/** Multiplier on the cost of walking through Location, one in an empty cell. */
+	float GetCostMultiplier(const FVector2f& Location) const { return 1.f + CostPerUnit * GetDensity(Location); }
+
+	SIZE_T GetAllocatedSize() const { return Densities.GetAllocatedSize(); }
+
+	/** Cells are coarse, a crowd only has to raise the cost of the few polys around it, see FGTGridLayout. */
+	float CellSize = 800.f;
+	int32 MaxCellsPerAxis = 256;
+	float SmoothingTime = 1.f;
+	/** Extra cost per unit in a cell, relative to walking through it empty. */
+	float CostPerUnit = 0.05f;
+
+private:
+	FGTGridLayout Layout;
+	TArray<float> Densities;
+};
+
+#if WITH_RECAST
+/**
+ * Recast filter that makes crowded polys more expensive, so paths found while an army funnels through one gap take
+ * another way if it is not much longer. The cost of each step is scaled by the density at its midpoint, which only
+ * ever raises costs and keeps the search heuristic admissible.
+ */
+class GITTEST_API FGTCongestionQueryFilter : public FRecastQueryFilter
+{
+public:
+	/** Same area costs and flags as Source. Density is shared with every copy the navigation system makes. */
+	FGTCongestionQueryFilter(const FRecastQueryFilter& Source, const TSharedPtr<const FGTCrowdDensity, ESPMode::ThreadSafe>& InDensity);
+
+	virtual INavigationQueryFilterInterface* CreateCopy() const override;
+
+protected:
+	virtual dtReal getVirtualCost(const dtReal* pa, const dtReal* pb,
+	                              const dtPolyRef prevRef, const dtMeshTile* prevTile, const dtPoly* prevPoly,
+	                              const dtPolyRef curRef, const dtMeshTile* curTile, const dtPoly* curPoly,
+	                              const dtPolyRef nextRef, const dtMeshTile* nextTile, const dtPoly* nextPoly) const override;
+
+private:
+	TSharedPtr<const FGTCrowdDensity, ESPMode::ThreadSafe> Density;
+};
+#endif // WITH_RECAST
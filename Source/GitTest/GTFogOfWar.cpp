@@ -0,0 +1,246 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GTFogOfWar.h"
+#include "GTUnitMovementSim.h"
+
+void FGTFogOfWar::Initialize(const FBox& Bounds, const FGTNavHeightfield* Heightfield)
+{
+	Reset();
+	if (!Bounds.IsValid)
+	{
+		return;
+	}
+
+	Layout.Initialize(Bounds, CellSize, MaxCellsPerAxis);
+	Heights.SetNumUninitialized(Layout.Num());
+	for (int32 Y = 0; Y < Layout.NumCellsY; ++Y)
+	{
+		for (int32 X = 0; X < Layout.NumCellsX; ++X)
+		{
+			float Height;
+			const FIntPoint Cell(X, Y);
+			Heights[Layout.GetCellIndex(Cell)] = Heightfield && Heightfield->GetHeight(Layout.GetCellCenter(Cell), Height) ? Height : NoGround;
+		}
+	}
+}
+
+void FGTFogOfWar::Reset()
+{
+	Heights.Reset();
+	Layout.Reset();
+	Shapes.Reset();
+	Teams.Reset();
+	Viewers.Reset();
+}
+
+bool FGTFogOfWar::UpdateViewer(int32 ViewerId, const FVector& Location, const FGenericTeamId& TeamId, float SightRadius)
+{
+	const int32 Cell = GetCellIndex(Location);
+	if (Cell == INDEX_NONE || TeamId == FGenericTeamId::NoTeam)
+	{
+		const bool bWasStamped = Viewers.IsValidIndex(ViewerId) && Viewers[ViewerId].Cell != INDEX_NONE;
+		RemoveViewer(ViewerId);
+		return bWasStamped;
+	}
+
+	if (ViewerId >= Viewers.Num())
+	{
+		Viewers.SetNum(ViewerId + 1);
+	}
+
+	FViewer& Viewer = Viewers[ViewerId];
+	const uint16 RadiusCells = static_cast<uint16>(FMath::Clamp(FMath::CeilToInt(SightRadius / Layout.CellSize), 0, MaxCellsPerAxis));
+	if (Viewer.Cell == Cell && Viewer.TeamId == TeamId.GetId() && Viewer.RadiusCells == RadiusCells)
+	{
+		return false;
+	}
+
+	if (Viewer.Cell != INDEX_NONE)
+	{
+		Stamp(Viewer, -1);
+	}
+	Viewer.Cell = Cell;
+	Viewer.TeamId = TeamId.GetId();
+	Viewer.RadiusCells = RadiusCells;
+	Viewer.Height = Heights[Cell] != NoGround ? Heights[Cell] : static_cast<float>(Location.Z);
+	Stamp(Viewer, 1);
+	return true;
+}
+
+void FGTFogOfWar::RemoveViewer(int32 ViewerId)
+{
+	if (Viewers.IsValidIndex(ViewerId) && Viewers[ViewerId].Cell != INDEX_NONE)
+	{
+		Stamp(Viewers[ViewerId], -1);
+		Viewers[ViewerId].Cell = INDEX_NONE;
+	}
+}
+
+bool FGTFogOfWar::IsVisible(const FGenericTeamId& TeamId, const FVector& Location) const
+{
+	const int32 Cell = GetCellIndex(Location);
+	const TBitArray<>& Visible = GetVisibleCells(TeamId);
+	return Cell != INDEX_NONE && Visible.IsValidIndex(Cell) && Visible[Cell];
+}
+
+bool FGTFogOfWar::IsExplored(const FGenericTeamId& TeamId, const FVector& Location) const
+{
+	const int32 Cell = GetCellIndex(Location);
+	return Cell != INDEX_NONE && Teams.IsValidIndex(TeamId.GetId()) && Teams[TeamId.GetId()].Explored.IsValidIndex(Cell)
+		&& Teams[TeamId.GetId()].Explored[Cell];
+}
+
+const TBitArray<>& FGTFogOfWar::GetVisibleCells(const FGenericTeamId& TeamId) const
+{
+	return Teams.IsValidIndex(TeamId.GetId()) ? Teams[TeamId.GetId()].Visible : EmptyCells;
+}
+
+void FGTFogOfWar::GetVisibleCells(TConstArrayView<FGenericTeamId> TeamIds, TBitArray<>& OutVisibleCells) const
+{
+	OutVisibleCells.Init(false, Heights.Num());
+	for (const FGenericTeamId& TeamId : TeamIds)
+	{
+		const TBitArray<>& Visible = GetVisibleCells(TeamId);
+		if (Visible.Num() == OutVisibleCells.Num())
+		{
+			OutVisibleCells.CombineWithBitwiseOR(Visible, EBitwiseOperatorFlags::MaintainSize);
+		}
+	}
+}
+
+int32 FGTFogOfWar::GetCellIndex(const FVector& Location) const
+{
+	return Layout.GetCellIndex(FVector2f(Location.X, Location.Y));
+}
+
+SIZE_T FGTFogOfWar::GetAllocatedSize() const
+{
+	SIZE_T Size = Heights.GetAllocatedSize() + Teams.GetAllocatedSize() + Viewers.GetAllocatedSize() + Shapes.GetAllocatedSize();
+	for (const FTeam& Team : Teams)
+	{
+		Size += Team.Counts.GetAllocatedSize() + Team.Visible.GetAllocatedSize() + Team.Explored.GetAllocatedSize();
+	}
+	for (const TPair<int32, FShape>& Shape : Shapes)
+	{
+		Size += Shape.Value.Offsets.GetAllocatedSize() + Shape.Value.Parents.GetAllocatedSize();
+	}
+	return Size;
+}
+
+const FGTFogOfWar::FShape& FGTFogOfWar::FindOrAddShape(int32 RadiusCells)
+{
+	if (const FShape* Shape = Shapes.Find(RadiusCells))
+	{
+		return *Shape;
+	}
+
+	FShape& Shape = Shapes.Add(RadiusCells);
+	const int32 RadiusSquared = RadiusCells * RadiusCells + RadiusCells;
+	for (int32 Y = -RadiusCells; Y <= RadiusCells; ++Y)
+	{
+		for (int32 X = -RadiusCells; X <= RadiusCells; ++X)
+		{
+			if (X * X + Y * Y <= RadiusSquared)
+			{
+				Shape.Offsets.Emplace(X, Y);
+			}
+		}
+	}
+
+	// Rings outwards, a cell's parent is one ring further in and so always comes first.
+	Shape.Offsets.Sort([](const FIntPoint& A, const FIntPoint& B)
+	{
+		const int32 RingA = FMath::Max(FMath::Abs(A.X), FMath::Abs(A.Y));
+		const int32 RingB = FMath::Max(FMath::Abs(B.X), FMath::Abs(B.Y));
+		return RingA != RingB ? RingA < RingB : A.SizeSquared() < B.SizeSquared();
+	});
+
+	const int32 Width = 2 * RadiusCells + 1;
+	TArray<int32> OffsetIndices;
+	OffsetIndices.SetNumUninitialized(Width * Width);
+	for (int32 Index = 0; Index < Shape.Offsets.Num(); ++Index)
+	{
+		OffsetIndices[(Shape.Offsets[Index].Y + RadiusCells) * Width + Shape.Offsets[Index].X + RadiusCells] = Index;
+	}
+
+	Shape.Parents.SetNumUninitialized(Shape.Offsets.Num());
+	for (int32 Index = 0; Index < Shape.Offsets.Num(); ++Index)
+	{
+		const FIntPoint& Offset = Shape.Offsets[Index];
+		const int32 Ring = FMath::Max(FMath::Abs(Offset.X), FMath::Abs(Offset.Y));
+		if (Ring == 0)
+		{
+			Shape.Parents[Index] = INDEX_NONE;
+			continue;
+		}
+
+		// The cell the line back to the centre crosses on the next ring in. Neither coordinate grows, so it is in the shape.
+		const float Scale = static_cast<float>(Ring - 1) / Ring;
+		const int32 ParentX = FMath::RoundToInt(Offset.X * Scale);
+		const int32 ParentY = FMath::RoundToInt(Offset.Y * Scale);
+		Shape.Parents[Index] = OffsetIndices[(ParentY + RadiusCells) * Width + ParentX + RadiusCells];
+	}
+	return Shape;
+}
+
+FGTFogOfWar::FTeam& FGTFogOfWar::FindOrAddTeam(uint8 TeamId)
+{
+	if (TeamId >= Teams.Num())
+	{
+		Teams.SetNum(TeamId + 1);
+	}
+
+	FTeam& Team = Teams[TeamId];
+	if (Team.Counts.Num() != Heights.Num())
+	{
+		Team.Counts.SetNumZeroed(Heights.Num());
+		Team.Visible.Init(false, Heights.Num());
+		Team.Explored.Init(false, Heights.Num());
+	}
+	return Team;
+}
+
+void FGTFogOfWar::Stamp(const FViewer& Viewer, int32 Delta)
+{
+	const FShape& Shape = FindOrAddShape(Viewer.RadiusCells);
+	FTeam& Team = FindOrAddTeam(Viewer.TeamId);
+	const int32 CenterX = Viewer.Cell % Layout.NumCellsX;
+	const int32 CenterY = Viewer.Cell / Layout.NumCellsX;
+
+	// Bit I is set when sight goes on past offset I. Cells outside the grid are neither seen nor seen past.
+	ScratchSightPasses.Init(false, Shape.Offsets.Num());
+	for (int32 Index = 0; Index < Shape.Offsets.Num(); ++Index)
+	{
+		const int32 Parent = Shape.Parents[Index];
+		if (Parent != INDEX_NONE && !ScratchSightPasses[Parent])
+		{
+			continue;
+		}
+
+		const FIntPoint Cell(CenterX + Shape.Offsets[Index].X, CenterY + Shape.Offsets[Index].Y);
+		if (!Layout.IsValidCell(Cell))
+		{
+			continue;
+		}
+
+		// A blocking cell is seen itself, only what lies behind it is hidden. The viewer always sees past its own cell.
+		const int32 CellIndex = Layout.GetCellIndex(Cell);
+		ScratchSightPasses[Index] = Parent == INDEX_NONE || !BlocksSight(CellIndex, Viewer.Height);
+
+		uint16& Count = Team.Counts[CellIndex];
+		if (Delta > 0)
+		{
+			checkSlow(Count < MAX_uint16);
+			if (Count++ == 0)
+			{
+				Team.Visible[CellIndex] = true;
+				Team.Explored[CellIndex] = true;
+			}
+		}
+		else if (--Count == 0)
+		{
+			Team.Visible[CellIndex] = false;
+		}
+	}
+}
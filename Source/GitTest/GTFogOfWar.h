@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GenericTeamAgentInterface.h"
+#include "GTGridLayout.h"
+
+class FGTNavHeightfield;
+
+/**
+ * What each team sees, on a grid over the navmesh. Every viewer stamps a cached vision shape for its sight radius
+ * into per-cell counts of its team, and a cell is visible while its count is above zero. A viewer is only stamped
+ * again when it crosses into another cell, by taking its old stamp out and putting the new one in, so a frame costs
+ * in proportion to the viewers that crossed a cell rather than to every viewer.
+ *
+ * Sight is blocked by cells off the navmesh and by cells standing BlockingHeight above the viewer's cell. Both are
+ * read once from the navmesh heightfield when the grid is laid out, and a stamp only depends on them and on the
+ * viewer's cell, so the same stamp can be taken out again without remembering which cells it set.
+ */
+class GITTEST_API FGTFogOfWar
+{
+public:
+	/**
+	 * Covers Bounds and drops every viewer. Each cell takes the height Heightfield has at its centre, so the heightfield
+	 * units already walk on is reused rather than projecting the navmesh again. Without one no cell has ground.
+	 */
+	void Initialize(const FBox& Bounds, const FGTNavHeightfield* Heightfield);
+	bool IsInitialized() const { return Heights.Num() > 0; }
+
+	/** Drops the grid and every viewer, viewers are stamped again after the next Initialize. */
+	void Reset();
+
+	/**
+	 * Sets where the viewer ViewerId stands and how far it sees. Its stamp is only replaced when its cell, team or
+	 * radius in cells changed, returns whether it was.
+	 */
+	bool UpdateViewer(int32 ViewerId, const FVector& Location, const FGenericTeamId& TeamId, float SightRadius);
+	void RemoveViewer(int32 ViewerId);
+
+	/** Whether a viewer of TeamId sees the cell containing Location, false outside the grid. */
+	bool IsVisible(const FGenericTeamId& TeamId, const FVector& Location) const;
+
+	/** Whether a viewer of TeamId ever saw the cell containing Location since the grid was laid out. */
+	bool IsExplored(const FGenericTeamId& TeamId, const FVector& Location) const;
+
+	/**
+	 * One bit per cell, row by row, set where TeamId sees. Empty for a team without viewers. Replication can test the
+	 * cell of each actor against the bitset of the connection's team instead of tracing from its units.
+	 */
+	const TBitArray<>& GetVisibleCells(const FGenericTeamId& TeamId) const;
+
+	/** Cells any of TeamIds sees, for allied vision. Combined a word at a time. */
+	void GetVisibleCells(TConstArrayView<FGenericTeamId> TeamIds, TBitArray<>& OutVisibleCells) const;
+
+	/** Index of the cell containing Location in the bitsets, INDEX_NONE outside the grid. */
+	int32 GetCellIndex(const FVector& Location) const;
+
+	int32 GetNumCellsX() const { return Layout.NumCellsX; }
+	int32 GetNumCellsY() const { return Layout.NumCellsY; }
+	SIZE_T GetAllocatedSize() const;
+
+	/** Size of the cells sight is resolved in, see FGTGridLayout. Viewers are only stamped again when they leave one. */
+	float CellSize = 200.f;
+	int32 MaxCellsPerAxis = 512;
+	/** Cells this much higher than the viewer's cell block its sight, like a cliff it stands below. */
+	float BlockingHeight = 200.f;
+
+private:
+	/** Cells within a radius, ordered so each comes after the cell next to it on the line back to the centre. */
+	struct FShape
+	{
+		TArray<FIntPoint> Offsets;
+		/** Index of the cell sight passes through to reach each offset, INDEX_NONE for the centre. */
+		TArray<int32> Parents;
+	};
+
+	struct FViewer
+	{
+		int32 Cell = INDEX_NONE;
+		uint8 TeamId = FGenericTeamId::NoTeamId;
+		uint16 RadiusCells = 0;
+		/** Height sight is blocked relative to, kept so the stamp can be taken out as it was put in. */
+		float Height = 0.f;
+	};
+
+	struct FTeam
+	{
+		/** Viewers seeing each cell. */
+		TArray<uint16> Counts;
+		TBitArray<> Visible;
+		TBitArray<> Explored;
+	};
+
+	const FShape& FindOrAddShape(int32 RadiusCells);
+	FTeam& FindOrAddTeam(uint8 TeamId);
+
+	/** Adds Delta to the count of every cell the viewer sees. */
+	void Stamp(const FViewer& Viewer, int32 Delta);
+
+	bool BlocksSight(int32 CellIndex, float ViewerHeight) const
+	{
+		return Heights[CellIndex] == NoGround || Heights[CellIndex] > ViewerHeight + BlockingHeight;
+	}
+
+	static constexpr float NoGround = -UE_BIG_NUMBER;
+
+	FGTGridLayout Layout;
+	/** Navmesh height of each cell, NoGround off the navmesh. */
+	TArray<float> Heights;
+
+	TMap<int32, FShape> Shapes;
+	TArray<FTeam> Teams;
+	TArray<FViewer> Viewers;
+	/** Whether sight goes on past each offset of the shape being stamped, reused by every stamp. */
+	TBitArray<> ScratchSightPasses;
+	TBitArray<> EmptyCells;
+};
@@ -0,0 +1,177 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GTFormation.h"
+#include "GTFrameArena.h"
+
+#include "Async/ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("GTFormation AssignSlots"), STAT_GTFormation_AssignSlots, STATGROUP_Game);
+
+namespace GTFormation
+{
+	/** Appends Count slots in centered rows of Columns, starting at row X = FrontX and going back. */
+	void AddRows(float FrontX, int32 Count, int32 Columns, float Spacing, TArray<FVector2D>& OutSlots)
+	{
+		Columns = FMath::Max(Columns, 1);
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			const int32 Row = Index / Columns;
+			const int32 RowSize = FMath::Min(Columns, Count - Row * Columns);
+			const int32 Column = Index % Columns;
+			OutSlots.Add(FVector2D(FrontX - Row * Spacing, (Column - (RowSize - 1) * 0.5f) * Spacing));
+		}
+	}
+}
+
+void FGTFormationLayout::BuildLocalSlots(int32 NumSlots, TArray<FVector2D>& OutSlots) const
+{
+	OutSlots.Reset(NumSlots);
+	if (NumSlots <= 0)
+	{
+		return;
+	}
+
+	switch (Shape)
+	{
+	case EGTFormationShape::Line:
+		GTFormation::AddRows(0.f, NumSlots, NumSlots, Spacing, OutSlots);
+		break;
+
+	case EGTFormationShape::Box:
+		GTFormation::AddRows(0.f, NumSlots, Columns > 0 ? Columns : FMath::CeilToInt(FMath::Sqrt(static_cast<float>(NumSlots))), Spacing, OutSlots);
+		break;
+
+	case EGTFormationShape::Wedge:
+		// Row N holds N + 1 slots behind the tip.
+		for (int32 Row = 0; OutSlots.Num() < NumSlots; ++Row)
+		{
+			const int32 RowSize = FMath::Min(Row + 1, NumSlots - OutSlots.Num());
+			for (int32 Column = 0; Column < RowSize; ++Column)
+			{
+				OutSlots.Add(FVector2D(-Row * Spacing, (Column - (RowSize - 1) * 0.5f) * Spacing));
+			}
+		}
+		break;
+
+	case EGTFormationShape::Custom:
+	{
+		const int32 NumCustom = FMath::Min(CustomSlots.Num(), NumSlots);
+		float BackX = 0.f;
+		float Width = Spacing;
+		for (int32 Index = 0; Index < NumCustom; ++Index)
+		{
+			OutSlots.Add(CustomSlots[Index]);
+			BackX = FMath::Min(BackX, CustomSlots[Index].X);
+			Width = FMath::Max(Width, FMath::Abs(CustomSlots[Index].Y) * 2.f);
+		}
+
+		const int32 NumExtra = NumSlots - NumCustom;
+		GTFormation::AddRows(BackX - (NumCustom > 0 ? Spacing : 0.f), NumExtra, FMath::FloorToInt(Width / FMath::Max(Spacing, 1.f)) + 1, Spacing, OutSlots);
+		break;
+	}
+	}
+
+	FVector2D Center = FVector2D::ZeroVector;
+	for (const FVector2D& Slot : OutSlots)
+	{
+		Center += Slot;
+	}
+	Center /= OutSlots.Num();
+	for (FVector2D& Slot : OutSlots)
+	{
+		Slot -= Center;
+	}
+}
+
+FVector GTFormation::ToWorldOffset(const FVector2D& LocalSlot, const FVector& Direction)
+{
+	const FVector Forward = Direction.GetSafeNormal2D(UE_SMALL_NUMBER, FVector::ForwardVector);
+	const FVector Right(-Forward.Y, Forward.X, 0.f);
+	return Forward * LocalSlot.X + Right * LocalSlot.Y;
+}
+
+void GTFormation::AssignSlots(TConstArrayView<FVector> UnitLocations, TConstArrayView<FVector> SlotLocations, TArray<int32>& OutSlotForUnit, int32 MaxImprovementRounds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GTFormation_AssignSlots);
+
+	const int32 NumUnits = UnitLocations.Num();
+	const int32 NumSlots = SlotLocations.Num();
+	check(NumSlots >= NumUnits);
+
+	OutSlotForUnit.SetNumUninitialized(NumUnits);
+	if (NumUnits == 0)
+	{
+		return;
+	}
+
+	// Row per unit, filled in parallel along with each unit's best case.
+	FGTFrameArenaScope ArenaScope;
+	TGTFrameArray<float> Costs;
+	Costs.SetNumUninitialized(NumUnits * NumSlots);
+	TGTFrameArray<float> NearestCosts;
+	NearestCosts.SetNumUninitialized(NumUnits);
+	ParallelFor(NumUnits, [&](int32 Unit)
+	{
+		float* Row = Costs.GetData() + Unit * NumSlots;
+		float Nearest = TNumericLimits<float>::Max();
+		for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+		{
+			Row[Slot] = FVector::Dist2D(UnitLocations[Unit], SlotLocations[Slot]);
+			Nearest = FMath::Min(Nearest, Row[Slot]);
+		}
+		NearestCosts[Unit] = Nearest;
+	});
+
+	// Units far from every slot have the least to choose from, so they pick first.
+	TGTFrameArray<int32> UnitOrder;
+	UnitOrder.SetNumUninitialized(NumUnits);
+	for (int32 Unit = 0; Unit < NumUnits; ++Unit)
+	{
+		UnitOrder[Unit] = Unit;
+	}
+	UnitOrder.Sort([&NearestCosts](int32 A, int32 B) { return NearestCosts[A] > NearestCosts[B]; });
+
+	TBitArray<TGTFrameAllocator<>> TakenSlots(false, NumSlots);
+	for (const int32 Unit : UnitOrder)
+	{
+		const float* Row = Costs.GetData() + Unit * NumSlots;
+		int32 BestSlot = INDEX_NONE;
+		for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+		{
+			if (!TakenSlots[Slot] && (BestSlot == INDEX_NONE || Row[Slot] < Row[BestSlot]))
+			{
+				BestSlot = Slot;
+			}
+		}
+		TakenSlots[BestSlot] = true;
+		OutSlotForUnit[Unit] = BestSlot;
+	}
+
+	// Round robin schedule: every round pairs each unit with a different partner and no unit is in two pairs,
+	// so the swaps of one round can run in parallel.
+	const int32 NumPlayers = NumUnits + (NumUnits & 1);
+	const int32 NumRounds = FMath::Min(MaxImprovementRounds, NumPlayers - 1);
+	for (int32 Round = 0; Round < NumRounds; ++Round)
+	{
+		ParallelFor(NumPlayers / 2, [&](int32 Pair)
+		{
+			const int32 A = Pair == 0 ? NumPlayers - 1 : (Round + Pair) % (NumPlayers - 1);
+			const int32 B = Pair == 0 ? Round : (Round + NumPlayers - 1 - Pair) % (NumPlayers - 1);
+			if (A >= NumUnits || B >= NumUnits)
+			{
+				return;
+			}
+
+			const int32 SlotA = OutSlotForUnit[A];
+			const int32 SlotB = OutSlotForUnit[B];
+			const float* RowA = Costs.GetData() + A * NumSlots;
+			const float* RowB = Costs.GetData() + B * NumSlots;
+			if (RowA[SlotB] + RowB[SlotA] < RowA[SlotA] + RowB[SlotB] - UE_KINDA_SMALL_NUMBER)
+			{
+				OutSlotForUnit[A] = SlotB;
+				OutSlotForUnit[B] = SlotA;
+			}
+		});
+	}
+}
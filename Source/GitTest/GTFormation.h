@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GTFormation.generated.h"
+
+UENUM(BlueprintType)
+enum class EGTFormationShape : uint8
+{
+	Line,
+	Box,
+	Wedge,
+	/** Uses FGTFormationLayout::CustomSlots. */
+	Custom
+};
+
+/** Slot layout of a squad. Slots are built in the formation's frame: X points along the move direction, Y to its right. */
+USTRUCT(BlueprintType)
+struct GITTEST_API FGTFormationLayout
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EGTFormationShape Shape = EGTFormationShape::Box;
+
+	/** Distance between neighbouring slots. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Spacing = 150.f;
+
+	/** Slots per row for Box, 0 picks a square-ish box. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 Columns = 0;
+
+	/** Slot offsets for Custom, in the formation's frame. Units past the last slot are put in rows behind it. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<FVector2D> CustomSlots;
+
+	/** Builds NumSlots offsets in the formation's frame, centered on the origin. */
+	void BuildLocalSlots(int32 NumSlots, TArray<FVector2D>& OutSlots) const;
+};
+
+namespace GTFormation
+{
+	/** Offsets in the formation's frame rotated to Direction, Direction only needs to be valid in 2D. */
+	GITTEST_API FVector ToWorldOffset(const FVector2D& LocalSlot, const FVector& Direction);
+
+	/**
+	 * Assigns each unit a slot so the total 2D travel distance is close to minimal. OutSlotForUnit[Unit] is the slot index.
+	 * A greedy pass on a cost matrix built in parallel is followed by parallel rounds of pairwise swaps on disjoint pairs,
+	 * each round pairing every unit with a new partner. Needs at least as many slots as units.
+	 */
+	GITTEST_API void AssignSlots(TConstArrayView<FVector> UnitLocations, TConstArrayView<FVector> SlotLocations, TArray<int32>& OutSlotForUnit, int32 MaxImprovementRounds = 32);
+}
@@ -0,0 +1,134 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GTFrameArena.h"
+
+#include <atomic>
+
+namespace GTFrameArena
+{
+	std::atomic<SIZE_T> TotalReservedBytes{0};
+	std::atomic<uint32> TotalChunkAllocations{0};
+
+#if GT_FRAME_ARENA_CHECK_ESCAPES
+	constexpr uint8 PoisonByte = 0xDD;
+#endif
+}
+
+FGTFrameArena::~FGTFrameArena()
+{
+	checkf(NumScopes == 0, TEXT("Frame arena destroyed with %d scopes still open"), NumScopes);
+	for (const FChunk& Chunk : Chunks)
+	{
+		GTFrameArena::TotalReservedBytes -= Chunk.Size;
+		FMemory::Free(Chunk.Data);
+	}
+}
+
+void* FGTFrameArena::Allocate(SIZE_T Size, SIZE_T Alignment)
+{
+	checkf(NumScopes > 0, TEXT("Frame arena allocation outside of an FGTFrameArenaScope"));
+
+	while (true)
+	{
+		if (Chunks.IsValidIndex(ChunkIndex))
+		{
+			const FChunk& Chunk = Chunks[ChunkIndex];
+			const SIZE_T Offset = Align(Chunk.Data + ChunkOffset, Alignment) - Chunk.Data;
+			if (Offset + Size <= Chunk.Size)
+			{
+				UsedBytes += Offset + Size - ChunkOffset;
+				PeakBytes = FMath::Max(PeakBytes, UsedBytes);
+				ChunkOffset = Offset + Size;
+				return Chunk.Data + Offset;
+			}
+
+			// The rest of the chunk counts as used, so closing the scope brings UsedBytes back exactly.
+			UsedBytes += Chunk.Size - ChunkOffset;
+			++ChunkIndex;
+			ChunkOffset = 0;
+			continue;
+		}
+
+		const SIZE_T NewChunkSize = FMath::Max(ChunkSize, Size + Alignment);
+		Chunks.Add({static_cast<uint8*>(FMemory::Malloc(NewChunkSize, PLATFORM_CACHE_LINE_SIZE)), NewChunkSize});
+		GTFrameArena::TotalReservedBytes += NewChunkSize;
+		++GTFrameArena::TotalChunkAllocations;
+	}
+}
+
+bool FGTFrameArena::TryGrow(void* Data, SIZE_T OldSize, SIZE_T NewSize)
+{
+	if (!Chunks.IsValidIndex(ChunkIndex))
+	{
+		return false;
+	}
+
+	const FChunk& Chunk = Chunks[ChunkIndex];
+	const SIZE_T ScopeStart = ChunkIndex == ScopeChunkIndex ? ScopeChunkOffset : 0;
+	const uint8* Start = static_cast<const uint8*>(Data);
+	if (Start + OldSize != Chunk.Data + ChunkOffset || Start < Chunk.Data + ScopeStart)
+	{
+		return false;
+	}
+
+	const SIZE_T NewOffset = ChunkOffset - OldSize + NewSize;
+	if (NewOffset > Chunk.Size)
+	{
+		return false;
+	}
+
+	UsedBytes = UsedBytes - OldSize + NewSize;
+	PeakBytes = FMath::Max(PeakBytes, UsedBytes);
+	ChunkOffset = NewOffset;
+	return true;
+}
+
+SIZE_T FGTFrameArena::GetTotalReservedBytes()
+{
+	return GTFrameArena::TotalReservedBytes;
+}
+
+uint32 FGTFrameArena::GetTotalChunkAllocations()
+{
+	return GTFrameArena::TotalChunkAllocations;
+}
+
+FGTFrameArenaScope::FGTFrameArenaScope()
+	: Arena(FGTFrameArena::Get())
+	, SavedChunkIndex(Arena.ChunkIndex)
+	, SavedChunkOffset(Arena.ChunkOffset)
+	, SavedUsedBytes(Arena.UsedBytes)
+	, SavedScopeChunkIndex(Arena.ScopeChunkIndex)
+	, SavedScopeChunkOffset(Arena.ScopeChunkOffset)
+#if GT_FRAME_ARENA_CHECK_ESCAPES
+	, SavedLiveContainers(Arena.NumLiveContainers)
+#endif
+{
+	Arena.ScopeChunkIndex = Arena.ChunkIndex;
+	Arena.ScopeChunkOffset = Arena.ChunkOffset;
+	++Arena.NumScopes;
+}
+
+FGTFrameArenaScope::~FGTFrameArenaScope()
+{
+#if GT_FRAME_ARENA_CHECK_ESCAPES
+	checkf(Arena.NumLiveContainers == SavedLiveContainers, TEXT("%d frame arena containers outlive the scope they allocated in"), Arena.NumLiveContainers - SavedLiveContainers);
+
+	// Anything still pointing into the released range reads garbage instead of data that looks valid.
+	for (int32 Index = SavedChunkIndex; Index <= Arena.ChunkIndex && Index < Arena.Chunks.Num(); ++Index)
+	{
+		const FGTFrameArena::FChunk& Chunk = Arena.Chunks[Index];
+		const SIZE_T Start = Index == SavedChunkIndex ? SavedChunkOffset : 0;
+		const SIZE_T End = Index == Arena.ChunkIndex ? Arena.ChunkOffset : Chunk.Size;
+		FMemory::Memset(Chunk.Data + Start, GTFrameArena::PoisonByte, End - Start);
+	}
+#endif
+
+	--Arena.NumScopes;
+	Arena.ChunkIndex = SavedChunkIndex;
+	Arena.ChunkOffset = SavedChunkOffset;
+	Arena.UsedBytes = SavedUsedBytes;
+	Arena.ScopeChunkIndex = SavedScopeChunkIndex;
+	Arena.ScopeChunkOffset = SavedScopeChunkOffset;
+}
@@ -0,0 +1,243 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSingleton.h"
+
+/** Poisons released arena memory and asserts when an arena container outlives the scope that allocated it. */
+#ifndef GT_FRAME_ARENA_CHECK_ESCAPES
+#define GT_FRAME_ARENA_CHECK_ESCAPES UE_BUILD_DEBUG
+#endif
+
+/**
+ * Linear allocator for scratch data that lives no longer than an FGTFrameArenaScope, one per thread so task workers
+ * never share one. Allocating bumps an offset, and closing a scope gives back everything allocated since it was opened.
+ * Chunks are kept once allocated, so after the first frames reach their peak, scratch data no longer touches the heap.
+ */
+class GITTEST_API FGTFrameArena : public TThreadSingleton<FGTFrameArena>
+{
+public:
+	virtual ~FGTFrameArena() override;
+
+	void* Allocate(SIZE_T Size, SIZE_T Alignment);
+
+	/** Grows the latest allocation of the innermost scope in place, false for any other allocation or a full chunk. */
+	bool TryGrow(void* Data, SIZE_T OldSize, SIZE_T NewSize);
+
+	int32 GetScopeDepth() const { return NumScopes; }
+	SIZE_T GetUsedBytes() const { return UsedBytes; }
+
+	/** Highest usage since the last ResetPeak. */
+	SIZE_T GetPeakBytes() const { return PeakBytes; }
+	void ResetPeak() { PeakBytes = UsedBytes; }
+
+	/** Chunk memory held by the arenas of every thread. */
+	static SIZE_T GetTotalReservedBytes();
+	/** Chunks allocated by the arenas of every thread so far, stops growing once every arena reached its peak. */
+	static uint32 GetTotalChunkAllocations();
+
+	static constexpr SIZE_T ChunkSize = 256 * 1024;
+
+#if GT_FRAME_ARENA_CHECK_ESCAPES
+	int32 NumLiveContainers = 0;
+#endif
+
+private:
+	friend class FGTFrameArenaScope;
+
+	struct FChunk
+	{
+		uint8* Data;
+		SIZE_T Size;
+	};
+
+	TArray<FChunk, TInlineAllocator<8>> Chunks;
+	int32 ChunkIndex = 0;
+	SIZE_T ChunkOffset = 0;
+	SIZE_T UsedBytes = 0;
+	SIZE_T PeakBytes = 0;
+
+	/** Where the innermost scope started, nothing allocated before it may grow in place. */
+	int32 ScopeChunkIndex = 0;
+	SIZE_T ScopeChunkOffset = 0;
+	int32 NumScopes = 0;
+};
+
+/** Everything allocated from the calling thread's arena while the scope is open is released when it closes. */
+class GITTEST_API FGTFrameArenaScope
+{
+public:
+	FGTFrameArenaScope();
+	~FGTFrameArenaScope();
+
+	UE_NONCOPYABLE(FGTFrameArenaScope);
+
+private:
+	FGTFrameArena& Arena;
+	int32 SavedChunkIndex;
+	SIZE_T SavedChunkOffset;
+	SIZE_T SavedUsedBytes;
+	int32 SavedScopeChunkIndex;
+	SIZE_T SavedScopeChunkOffset;
+#if GT_FRAME_ARENA_CHECK_ESCAPES
+	int32 SavedLiveContainers;
+#endif
+};
+
+/**
+ * Container allocator drawing from the calling thread's frame arena. Containers have to be declared inside the scope
+ * they allocate in and used on the thread that declared them. Shrinking keeps the memory, growing the latest allocation
+ * extends it in place.
+ */
+template<uint32 Alignment = 16>
+class TGTFrameAllocator
+{
+public:
+	using SizeType = int32;
+
+	enum { NeedsElementType = true };
+	enum { RequireRangeCheck = true };
+
+	class ForAnyElementType
+	{
+	public:
+		ForAnyElementType() = default;
+		ForAnyElementType(const ForAnyElementType&) = delete;
+		ForAnyElementType& operator=(const ForAnyElementType&) = delete;
+
+		~ForAnyElementType()
+		{
+			Release();
+		}
+
+		void MoveToEmpty(ForAnyElementType& Other)
+		{
+			checkSlow(this != &Other);
+			Release();
+			Data = Other.Data;
+			AllocatedBytes = Other.AllocatedBytes;
+#if GT_FRAME_ARENA_CHECK_ESCAPES
+			ScopeDepth = Other.ScopeDepth;
+#endif
+			Other.Data = nullptr;
+			Other.AllocatedBytes = 0;
+		}
+
+		FORCEINLINE FScriptContainerElement* GetAllocation() const
+		{
+			return Data;
+		}
+
+		void ResizeAllocation(SizeType PreviousNumElements, SizeType NumElements, SIZE_T NumBytesPerElement)
+		{
+			const SIZE_T NewBytes = static_cast<SIZE_T>(NumElements) * NumBytesPerElement;
+			if (NewBytes == 0)
+			{
+				Release();
+				return;
+			}
+
+			FGTFrameArena& Arena = FGTFrameArena::Get();
+			if (Data)
+			{
+#if GT_FRAME_ARENA_CHECK_ESCAPES
+				checkf(ScopeDepth == Arena.GetScopeDepth(), TEXT("Frame arena container resized in another scope than the one it allocated in, its memory would be released while it is in use"));
+#endif
+				if (NewBytes <= AllocatedBytes || Arena.TryGrow(Data, AllocatedBytes, NewBytes))
+				{
+					AllocatedBytes = FMath::Max(AllocatedBytes, NewBytes);
+					return;
+				}
+			}
+
+			void* NewData = Arena.Allocate(NewBytes, Alignment);
+			if (Data)
+			{
+				FMemory::Memcpy(NewData, Data, FMath::Min(static_cast<SIZE_T>(PreviousNumElements) * NumBytesPerElement, NewBytes));
+			}
+			else
+			{
+#if GT_FRAME_ARENA_CHECK_ESCAPES
+				++Arena.NumLiveContainers;
+				ScopeDepth = Arena.GetScopeDepth();
+#endif
+			}
+			Data = static_cast<FScriptContainerElement*>(NewData);
+			AllocatedBytes = NewBytes;
+		}
+
+		SizeType CalculateSlackReserve(SizeType NumElements, SIZE_T NumBytesPerElement) const
+		{
+			return NumElements;
+		}
+
+		SizeType CalculateSlackShrink(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+		{
+			return NumAllocatedElements;
+		}
+
+		SizeType CalculateSlackGrow(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+		{
+			return DefaultCalculateSlackGrow(NumElements, NumAllocatedElements, NumBytesPerElement, false, Alignment);
+		}
+
+		SIZE_T GetAllocatedSize(SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+		{
+			return static_cast<SIZE_T>(NumAllocatedElements) * NumBytesPerElement;
+		}
+
+		bool HasAllocation() const
+		{
+			return Data != nullptr;
+		}
+
+		SizeType GetInitialCapacity() const
+		{
+			return 0;
+		}
+
+	private:
+		void Release()
+		{
+			if (Data)
+			{
+#if GT_FRAME_ARENA_CHECK_ESCAPES
+				--FGTFrameArena::Get().NumLiveContainers;
+#endif
+				Data = nullptr;
+				AllocatedBytes = 0;
+			}
+		}
+
+		FScriptContainerElement* Data = nullptr;
+		SIZE_T AllocatedBytes = 0;
+#if GT_FRAME_ARENA_CHECK_ESCAPES
+		int32 ScopeDepth = 0;
+#endif
+	};
+
+	template<typename ElementType>
+	class ForElementType : public ForAnyElementType
+	{
+	public:
+		FORCEINLINE ElementType* GetAllocation() const
+		{
+			return static_cast<ElementType*>(ForAnyElementType::GetAllocation());
+		}
+	};
+};
+
+template<uint32 Alignment>
+struct TAllocatorTraits<TGTFrameAllocator<Alignment>> : TAllocatorTraitsBase<TGTFrameAllocator<Alignment>>
+{
+	enum { SupportsMove = true };
+};
+
+using FGTFrameSetAllocator = TSetAllocator<TSparseArrayAllocator<TGTFrameAllocator<>, TGTFrameAllocator<>>, TGTFrameAllocator<>>;
+
+template<typename ElementType>
+using TGTFrameArray = TArray<ElementType, TGTFrameAllocator<(alignof(ElementType) > 16 ? alignof(ElementType) : 16)>>;
+
+template<typename KeyType, typename ValueType>
+using TGTFrameMap = TMap<KeyType, ValueType, FGTFrameSetAllocator>;
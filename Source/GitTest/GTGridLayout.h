@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Where the cells of a uniform 2D grid over an area lie, shared by the grids that bucket units and navmesh samples.
+ * Cells are square and at least the requested size, they grow when the area spans more than a cap per axis so a
+ * huge map cannot blow up the cell count. Cells are indexed row by row.
+ */
+struct FGTGridLayout
+{
+	FVector2f Origin = FVector2f::ZeroVector;
+	float CellSize = 0.f;
+	int32 NumCellsX = 0;
+	int32 NumCellsY = 0;
+
+	/** Covers Bounds with cells of at least MinCellSize, no more than MaxCellsPerAxis of them along either axis. */
+	void Initialize(const FBox2D& Bounds, float MinCellSize, int32 MaxCellsPerAxis)
+	{
+		const FVector2D Size = Bounds.GetSize();
+		CellSize = FMath::Max3(MinCellSize, static_cast<float>(Size.X) / MaxCellsPerAxis, static_cast<float>(Size.Y) / MaxCellsPerAxis);
+		Origin = FVector2f(Bounds.Min);
+		NumCellsX = FMath::FloorToInt(Size.X / CellSize) + 1;
+		NumCellsY = FMath::FloorToInt(Size.Y / CellSize) + 1;
+	}
+
+	void Initialize(const FBox& Bounds, float MinCellSize, int32 MaxCellsPerAxis)
+	{
+		Initialize(FBox2D(FVector2D(Bounds.Min), FVector2D(Bounds.Max)), MinCellSize, MaxCellsPerAxis);
+	}
+
+	void Reset() { NumCellsX = NumCellsY = 0; }
+	int32 Num() const { return NumCellsX * NumCellsY; }
+
+	/** Cell containing Location, which may lie outside the grid. */
+	FIntPoint GetCell(const FVector2f& Location) const
+	{
+		return FIntPoint(FMath::FloorToInt((Location.X - Origin.X) / CellSize), FMath::FloorToInt((Location.Y - Origin.Y) / CellSize));
+	}
+
+	/** Cell containing Location, or the closest cell on the border for locations outside the grid. */
+	FIntPoint GetClampedCell(const FVector2f& Location) const
+	{
+		const FIntPoint Cell = GetCell(Location);
+		return FIntPoint(FMath::Clamp(Cell.X, 0, NumCellsX - 1), FMath::Clamp(Cell.Y, 0, NumCellsY - 1));
+	}
+
+	bool IsValidCell(const FIntPoint& Cell) const { return Cell.X >= 0 && Cell.Y >= 0 && Cell.X < NumCellsX && Cell.Y < NumCellsY; }
+	int32 GetCellIndex(const FIntPoint& Cell) const { return Cell.Y * NumCellsX + Cell.X; }
+
+	/** Index of the cell containing Location, INDEX_NONE outside the grid. */
+	int32 GetCellIndex(const FVector2f& Location) const
+	{
+		const FIntPoint Cell = GetCell(Location);
+		return IsValidCell(Cell) ? GetCellIndex(Cell) : INDEX_NONE;
+	}
+
+	FVector2f GetCellMin(const FIntPoint& Cell) const { return Origin + FVector2f(Cell.X * CellSize, Cell.Y * CellSize); }
+	FVector2f GetCellCenter(const FIntPoint& Cell) const { return GetCellMin(Cell) + FVector2f(CellSize * 0.5f); }
+};
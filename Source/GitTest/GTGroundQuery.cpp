@@ -0,0 +1,192 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GTGroundQuery.h"
+
+#include "NavigationData.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("FGTGroundQuery TraceRay"), STAT_FGTGroundQuery_TraceRay, STATGROUP_Game);
+DECLARE_CYCLE_STAT(TEXT("FGTGroundQuery SnapToGround"), STAT_FGTGroundQuery_SnapToGround, STATGROUP_Game);
+
+namespace GTGroundQuery
+{
+	constexpr int32 MaxMarchSteps = 1024;
+	constexpr int32 RefineSteps = 8;
+}
+
+FGTGroundQuery::FGTGroundQuery()
+{
+	DynamicObjectTypes.AddObjectTypesToQuery(ECC_PhysicsBody);
+	DynamicObjectTypes.AddObjectTypesToQuery(ECC_Vehicle);
+	DynamicObjectTypes.AddObjectTypesToQuery(ECC_Destructible);
+}
+
+void FGTGroundQuery::Initialize(UWorld& InWorld, const ANavigationData& InNavData)
+{
+	World = &InWorld;
+	NavData = &InNavData;
+	Invalidate();
+}
+
+void FGTGroundQuery::Invalidate()
+{
+	Tiles.Reset();
+	bHasLastRay = false;
+	NavBounds = NavData.IsValid() ? NavData->GetBounds() : FBox(ForceInit);
+}
+
+float FGTGroundQuery::SampleCell(const FIntPoint& Cell)
+{
+	++Stats.SampledCells;
+	const FVector Center((Cell.X + 0.5f) * CellSize, (Cell.Y + 0.5f) * CellSize, NavBounds.GetCenter().Z);
+	const FVector Extent(CellSize * 0.5f, CellSize * 0.5f, NavBounds.GetExtent().Z + 100.f);
+
+	FNavLocation NavLocation;
+	return NavData->ProjectPoint(Center, NavLocation, Extent) ? NavLocation.Location.Z : NoGround;
+}
+
+bool FGTGroundQuery::GetGroundHeight(const FVector2D& Location, float& OutHeight)
+{
+	if (!NavData.IsValid())
+	{
+		return false;
+	}
+
+	const FIntPoint Cell(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+	const FIntPoint TileCoord(FMath::FloorToInt(static_cast<float>(Cell.X) / TileSize), FMath::FloorToInt(static_cast<float>(Cell.Y) / TileSize));
+
+	FTile* Tile = Tiles.Find(TileCoord);
+	if (Tile == nullptr)
+	{
+		Tile = &Tiles.Add(TileCoord);
+		for (float& Height : Tile->Heights)
+		{
+			Height = NotSampled;
+		}
+	}
+
+	float& Height = Tile->Heights[(Cell.Y - TileCoord.Y * TileSize) * TileSize + (Cell.X - TileCoord.X * TileSize)];
+	if (Height == NotSampled)
+	{
+		Height = SampleCell(Cell);
+	}
+
+	OutHeight = Height;
+	return Height != NoGround;
+}
+
+bool FGTGroundQuery::MarchHeightfield(const FVector& Origin, const FVector& Direction, FVector& OutLocation)
+{
+	if (!NavBounds.IsValid || Direction.Z > -UE_KINDA_SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	// Only the part of the ray between the top and bottom of the navmesh can meet it.
+	const float TopZ = NavBounds.Max.Z + 100.f;
+	const float BottomZ = NavBounds.Min.Z - 100.f;
+	const float StartT = FMath::Max(0.f, (TopZ - Origin.Z) / Direction.Z);
+	const float EndT = (BottomZ - Origin.Z) / Direction.Z;
+	if (EndT < StartT)
+	{
+		return false;
+	}
+
+	const float HorizontalSpeed = Direction.Size2D();
+	float Height;
+	if (HorizontalSpeed < UE_KINDA_SMALL_NUMBER)
+	{
+		if (GetGroundHeight(FVector2D(Origin), Height) && Height <= Origin.Z)
+		{
+			OutLocation = FVector(Origin.X, Origin.Y, Height);
+			return true;
+		}
+		return false;
+	}
+
+	// Half a cell per step so no cell is skipped, then bisection between the last step above ground and the first below.
+	const float StepT = FMath::Max(CellSize * 0.5f / HorizontalSpeed, (EndT - StartT) / GTGroundQuery::MaxMarchSteps);
+	float AboveT = StartT;
+	for (float T = StartT; T <= EndT + StepT; T += StepT)
+	{
+		const FVector Point = Origin + Direction * FMath::Min(T, EndT);
+		if (!GetGroundHeight(FVector2D(Point), Height) || Point.Z > Height)
+		{
+			AboveT = T;
+			continue;
+		}
+
+		float BelowT = FMath::Min(T, EndT);
+		for (int32 Step = 0; Step < GTGroundQuery::RefineSteps; ++Step)
+		{
+			const float MidT = (AboveT + BelowT) * 0.5f;
+			const FVector MidPoint = Origin + Direction * MidT;
+			if (GetGroundHeight(FVector2D(MidPoint), Height) && MidPoint.Z <= Height)
+			{
+				BelowT = MidT;
+			}
+			else
+			{
+				AboveT = MidT;
+			}
+		}
+
+		const FVector HitPoint = Origin + Direction * BelowT;
+		GetGroundHeight(FVector2D(HitPoint), Height);
+		OutLocation = FVector(HitPoint.X, HitPoint.Y, Height);
+		return true;
+	}
+	return false;
+}
+
+bool FGTGroundQuery::TraceRay(const FVector& Origin, const FVector& Direction, FVector& OutLocation)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FGTGroundQuery_TraceRay);
+
+	// A cursor and camera that did not move give the same ray, and the same answer.
+	if (bHasLastRay && Origin.Equals(LastRayOrigin, 0.01f) && Direction.Equals(LastRayDirection, 1.e-5f))
+	{
+		++Stats.RepeatedRays;
+		OutLocation = LastRayLocation;
+		return bLastRayHit;
+	}
+
+	FVector GroundLocation;
+	const bool bGroundHit = MarchHeightfield(Origin, Direction, GroundLocation);
+
+	bool bDynamicHit = false;
+	FHitResult Hit;
+	UWorld* WorldPtr = World.Get();
+	if (WorldPtr && DynamicObjectTypes.IsValid())
+	{
+		const FVector TraceEnd = bGroundHit ? GroundLocation : Origin + Direction * WORLD_MAX;
+		bDynamicHit = WorldPtr->LineTraceSingleByObjectType(Hit, Origin, TraceEnd, DynamicObjectTypes);
+	}
+
+	const bool bHit = bGroundHit || bDynamicHit;
+	OutLocation = bDynamicHit ? Hit.Location : GroundLocation;
+	Stats.DynamicHits += bDynamicHit ? 1 : 0;
+	Stats.HeightfieldHits += bGroundHit && !bDynamicHit ? 1 : 0;
+	Stats.Misses += bHit ? 0 : 1;
+
+	bHasLastRay = true;
+	LastRayOrigin = Origin;
+	LastRayDirection = Direction;
+	LastRayLocation = OutLocation;
+	bLastRayHit = bHit;
+	return bHit;
+}
+
+void FGTGroundQuery::SnapToGround(TArrayView<FVector> Locations)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FGTGroundQuery_SnapToGround);
+	for (FVector& Location : Locations)
+	{
+		float Height;
+		if (GetGroundHeight(FVector2D(Location), Height))
+		{
+			Location.Z = Height;
+		}
+	}
+}
@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "CollisionQueryParams.h"
+
+class ANavigationData;
+
+/**
+ * Answers "where does this ray or column meet walkable ground" from a heightfield sampled off the navmesh.
+ * Tiles are sampled the first time they are needed and dropped when the navmesh is rebuilt. A ray equal to the last one
+ * reuses its answer, and physics is only traced against dynamic object types, which the navmesh does not know about.
+ * The heightfield holds one navmesh layer per cell, so overlapping floors resolve to whichever one ProjectPoint finds.
+ */
+class GITTEST_API FGTGroundQuery
+{
+public:
+	struct FStats
+	{
+		int32 RepeatedRays = 0;
+		int32 HeightfieldHits = 0;
+		int32 DynamicHits = 0;
+		int32 Misses = 0;
+		int32 SampledCells = 0;
+	};
+
+	FGTGroundQuery();
+
+	void Initialize(UWorld& InWorld, const ANavigationData& InNavData);
+	bool IsInitialized() const { return NavData.IsValid(); }
+
+	/** Drops every sampled tile, call after the navmesh changed. */
+	void Invalidate();
+
+	/** Finds where the ray first meets the ground, or dynamic geometry standing on it. Direction has to be normalized. */
+	bool TraceRay(const FVector& Origin, const FVector& Direction, FVector& OutLocation);
+
+	bool GetGroundHeight(const FVector2D& Location, float& OutHeight);
+
+	/** Moves each location to the ground below or above it, locations without ground are left where they are. */
+	void SnapToGround(TArrayView<FVector> Locations);
+
+	const FStats& GetStats() const { return Stats; }
+	SIZE_T GetAllocatedSize() const { return Tiles.GetAllocatedSize(); }
+
+	/** Size of a heightfield cell, the horizontal precision of every answer. */
+	float CellSize = 100.f;
+
+	/** Object types traced for along the ray, static world geometry is covered by the navmesh. */
+	FCollisionObjectQueryParams DynamicObjectTypes;
+
+private:
+	static constexpr int32 TileSize = 16;
+	static constexpr int32 CellsPerTile = TileSize * TileSize;
+	static constexpr float NoGround = -UE_BIG_NUMBER;
+	static constexpr float NotSampled = UE_BIG_NUMBER;
+
+	struct FTile
+	{
+		float Heights[CellsPerTile];
+	};
+
+	float SampleCell(const FIntPoint& Cell);
+	bool MarchHeightfield(const FVector& Origin, const FVector& Direction, FVector& OutLocation);
+
+	TWeakObjectPtr<UWorld> World;
+	TWeakObjectPtr<const ANavigationData> NavData;
+	FBox NavBounds;
+
+	TMap<FIntPoint, FTile> Tiles;
+
+	FVector LastRayOrigin = FVector::ZeroVector;
+	FVector LastRayDirection = FVector::ZeroVector;
+	FVector LastRayLocation = FVector::ZeroVector;
+	bool bLastRayHit = false;
+	bool bHasLastRay = false;
+
+	FStats Stats;
+};
@@ -0,0 +1,912 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GTCharacterMovementComponent.h"
+#include "GTCharacterUnit.h"
+#include "GTCrowdAnimation.h"
+#include "GTFogOfWar.h"
+#include "GTNewCharacter.h"
+#include "GTPawnMovementManager.h"
+#include "GTSpatialGrid.h"
+#include "GTTargetAcquisition.h"
+#include "GTUnitProxyMeshes.h"
+#include "GTUnitMovementSim.h"
+#include "GTUnitMovementState.h"
+#include "GTUnitSeparation.h"
+#include "Animation/AnimSequenceBase.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "NavigationSystem.h"
+#include "Math/RandomStream.h"
+
+namespace GTMovementBenchmark
+{
+	/** Fixed seed so runs on different builds measure the same layout. */
+	constexpr int32 RandomSeed = 1337;
+
+	bool IsInsideQuad(const FVector2D (&Corners)[4], const FVector2D& Point)
+	{
+		const double Winding = FVector2D::CrossProduct(Corners[1] - Corners[0], Corners[2] - Corners[1]) >= 0.0 ? 1.0 : -1.0;
+		for (int32 Edge = 0; Edge < 4; ++Edge)
+		{
+			if (FVector2D::CrossProduct(Corners[(Edge + 1) % 4] - Corners[Edge], Point - Corners[Edge]) * Winding < 0.0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * GT.Benchmark.Selection [NumUnits] [NumQueries]
+	 * Times drag-box selections over NumUnits units through the unit grid against testing every unit, which is what
+	 * projecting each unit to the screen amounts to.
+	 */
+	void RunSelectionBenchmark(const TArray<FString>& Args)
+	{
+		const int32 NumUnits = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 20000;
+		const int32 NumQueries = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 1000;
+		const float WorldSize = FMath::Sqrt(static_cast<float>(NumUnits)) * 150.f;
+
+		FRandomStream Random(RandomSeed);
+		TArray<FVector> Locations;
+		TArray<int32> Ids;
+		Locations.SetNumUninitialized(NumUnits);
+		Ids.SetNumUninitialized(NumUnits);
+		for (int32 Index = 0; Index < NumUnits; ++Index)
+		{
+			Locations[Index] = FVector(Random.FRandRange(0.f, WorldSize), Random.FRandRange(0.f, WorldSize), 0.f);
+			Ids[Index] = Index;
+		}
+
+		// Perspective boxes from a top-down camera, wider at the far edge.
+		TArray<FVector2D> Quads;
+		Quads.SetNumUninitialized(NumQueries * 4);
+		for (int32 Query = 0; Query < NumQueries; ++Query)
+		{
+			const FVector2D Center(Random.FRandRange(0.f, WorldSize), Random.FRandRange(0.f, WorldSize));
+			const float HalfWidth = Random.FRandRange(200.f, 3000.f);
+			const float HalfDepth = Random.FRandRange(200.f, 3000.f);
+			const float FarWidth = HalfWidth * Random.FRandRange(1.f, 1.5f);
+			Quads[Query * 4 + 0] = Center + FVector2D(-HalfDepth, -HalfWidth);
+			Quads[Query * 4 + 1] = Center + FVector2D(HalfDepth, -FarWidth);
+			Quads[Query * 4 + 2] = Center + FVector2D(HalfDepth, FarWidth);
+			Quads[Query * 4 + 3] = Center + FVector2D(-HalfDepth, HalfWidth);
+		}
+
+		FGTSpatialGrid Grid;
+		double StartTime = FPlatformTime::Seconds();
+		Grid.Build(Locations, Ids);
+		const double BuildMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		TArray<int32> Selection;
+		Selection.Reserve(NumUnits);
+		int64 NumSelected = 0;
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Query = 0; Query < NumQueries; ++Query)
+		{
+			const FVector2D Corners[4] = {Quads[Query * 4], Quads[Query * 4 + 1], Quads[Query * 4 + 2], Quads[Query * 4 + 3]};
+			Selection.Reset();
+			Grid.QueryConvexQuad(Corners, Selection);
+			NumSelected += Selection.Num();
+		}
+		const double GridMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / FMath::Max(NumQueries, 1);
+
+		int64 NumSelectedBruteForce = 0;
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Query = 0; Query < NumQueries; ++Query)
+		{
+			const FVector2D Corners[4] = {Quads[Query * 4], Quads[Query * 4 + 1], Quads[Query * 4 + 2], Quads[Query * 4 + 3]};
+			Selection.Reset();
+			for (int32 Index = 0; Index < NumUnits; ++Index)
+			{
+				if (IsInsideQuad(Corners, FVector2D(Locations[Index])))
+				{
+					Selection.Add(Ids[Index]);
+				}
+			}
+			NumSelectedBruteForce += Selection.Num();
+		}
+		const double BruteForceMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / FMath::Max(NumQueries, 1);
+
+		UE_LOG(LogTemp, Display, TEXT("Selection benchmark, %d units, %d queries: grid build %.3f ms, grid query %.4f ms, every unit %.4f ms, %.1f units selected on average (%lld / %lld)"),
+		       NumUnits, NumQueries, BuildMs, GridMs, BruteForceMs, static_cast<double>(NumSelected) / FMath::Max(NumQueries, 1), NumSelected, NumSelectedBruteForce);
+	}
+
+	/**
+	 * GT.Benchmark.SpatialOrder [NumUnits] [Iterations]
+	 * Times a per-unit pass that reads the terrain cells around each unit, the access pattern of nav tile and heightfield
+	 * lookups, with units in registration order and in the order AGTPawnMovementManager::GetSpatialSlotOrder puts them
+	 * in, and times that sort itself. Only wall time is reported, L2 misses have to be read from a hardware profiler
+	 * attached to the run.
+	 */
+	void RunSpatialOrderBenchmark(const TArray<FString>& Args)
+	{
+		const int32 NumUnits = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 20000;
+		const int32 NumIterations = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 20;
+		constexpr int32 TerrainSize = 2048;
+		constexpr float CellSize = 100.f;
+
+		FRandomStream Random(RandomSeed);
+		TArray<float> Terrain;
+		Terrain.SetNumUninitialized(TerrainSize * TerrainSize);
+		for (float& Height : Terrain)
+		{
+			Height = Random.FRand();
+		}
+
+		TArray<FVector> Locations;
+		Locations.SetNumUninitialized(NumUnits);
+		for (FVector& Location : Locations)
+		{
+			Location = FVector(Random.FRandRange(CellSize, (TerrainSize - 1) * CellSize), Random.FRandRange(CellSize, (TerrainSize - 1) * CellSize), 0.f);
+		}
+
+		const auto RunPass = [&Terrain, NumIterations](TArray<FVector>& Units)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+			{
+				for (FVector& Unit : Units)
+				{
+					const int32 CellX = static_cast<int32>(Unit.X / CellSize);
+					const int32 CellY = static_cast<int32>(Unit.Y / CellSize);
+					float Height = 0.f;
+					for (int32 Y = -1; Y <= 1; ++Y)
+					{
+						for (int32 X = -1; X <= 1; ++X)
+						{
+							Height += Terrain[(CellY + Y) * TerrainSize + CellX + X];
+						}
+					}
+					Unit.Z = Height / 9.f;
+				}
+			}
+			return (FPlatformTime::Seconds() - StartTime) * 1000.0 / FMath::Max(NumIterations, 1);
+		};
+
+		const double RegistrationOrderMs = RunPass(Locations);
+
+		TArray<FGTUnitMovementHot, TAlignedHeapAllocator<alignof(FGTUnitMovementHot)>> MovementStates;
+		MovementStates.SetNum(NumUnits);
+		for (int32 Index = 0; Index < NumUnits; ++Index)
+		{
+			MovementStates[Index].Location = FVector3f(Locations[Index]);
+		}
+		TArray<int32> SlotOrder;
+		SlotOrder.SetNumUninitialized(NumUnits);
+		const double SortStartTime = FPlatformTime::Seconds();
+		AGTPawnMovementManager::GetSpatialSlotOrder(MovementStates, GetDefault<AGTPawnMovementManager>()->SpatialSortCellSize, SlotOrder);
+		const double SortMs = (FPlatformTime::Seconds() - SortStartTime) * 1000.0;
+
+		TArray<FVector> SortedLocations;
+		SortedLocations.Reserve(NumUnits);
+		for (const int32 Slot : SlotOrder)
+		{
+			SortedLocations.Add(Locations[Slot]);
+		}
+		Locations = MoveTemp(SortedLocations);
+		const double SpatialOrderMs = RunPass(Locations);
+
+		UE_LOG(LogTemp, Display, TEXT("Spatial order benchmark, %d units, %d iterations: registration order %.3f ms, Z-order %.3f ms per pass, sort %.3f ms"),
+		       NumUnits, NumIterations, RegistrationOrderMs, SpatialOrderMs, SortMs);
+	}
+
+	/**
+	 * GT.Benchmark.MovementState [NumUnits] [Iterations]
+	 * Prints the bytes per unit of the hot movement record against the movement component, and times the same velocity
+	 * and location update over packed hot records and over records spread one component apart, which is how the fields
+	 * sit when every unit's component is updated in turn. Cache misses are not sampled here, run it under a hardware
+	 * profiler to read them.
+	 */
+	void RunMovementStateBenchmark(const TArray<FString>& Args)
+	{
+		const int32 NumUnits = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 20000;
+		const int32 NumIterations = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 20;
+		constexpr float DeltaTime = 1.f / 30.f;
+
+		// Rounded up to whole records so every record in the spread layout stays aligned.
+		const int32 ComponentStride = FMath::DivideAndRoundUp<int32>(sizeof(UGTCharacterMovementComponent), sizeof(FGTUnitMovementHot));
+
+		FRandomStream Random(RandomSeed);
+		TArray<FGTUnitMovementHot, TAlignedHeapAllocator<alignof(FGTUnitMovementHot)>> Packed;
+		TArray<FGTUnitMovementHot, TAlignedHeapAllocator<alignof(FGTUnitMovementHot)>> Spread;
+		Packed.SetNum(NumUnits);
+		Spread.SetNum(NumUnits * ComponentStride);
+		for (int32 Index = 0; Index < NumUnits; ++Index)
+		{
+			FGTUnitMovementHot& State = Packed[Index];
+			State.Location = FVector3f(Random.FRandRange(0.f, 100000.f), Random.FRandRange(0.f, 100000.f), 0.f);
+			State.RequestedVelocity = FVector3f(Random.GetUnitVector()) * 600.f;
+			State.MaxSpeed = 600.f;
+			State.MaxAcceleration = 2048.f;
+			State.GroundFriction = 8.f;
+			State.BrakingDeceleration = 2048.f;
+			Spread[Index * ComponentStride] = State;
+		}
+
+		const auto RunPass = [NumUnits, NumIterations](FGTUnitMovementHot* States, int32 Stride)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+			{
+				for (int32 Index = 0; Index < NumUnits; ++Index)
+				{
+					FGTUnitMovementHot& State = States[Index * Stride];
+					const FVector3f Direction = State.RequestedVelocity.GetSafeNormal();
+					State.Velocity -= (State.Velocity - Direction * State.Velocity.Size()) * FMath::Min(DeltaTime * State.GroundFriction, 1.f);
+					State.Velocity = (State.Velocity + Direction * State.MaxAcceleration * DeltaTime).GetClampedToMaxSize(State.MaxSpeed);
+					State.Location += State.Velocity * DeltaTime;
+				}
+			}
+			return (FPlatformTime::Seconds() - StartTime) * 1000.0 / FMath::Max(NumIterations, 1);
+		};
+
+		const double PackedMs = RunPass(Packed.GetData(), 1);
+		const double SpreadMs = RunPass(Spread.GetData(), ComponentStride);
+
+		UE_LOG(LogTemp, Display, TEXT("Movement state benchmark, %d units, %d iterations: hot record %d bytes, movement component %d bytes, packed %.3f ms, component stride %.3f ms per pass"),
+		       NumUnits, NumIterations, static_cast<int32>(sizeof(FGTUnitMovementHot)), static_cast<int32>(sizeof(UGTCharacterMovementComponent)), PackedMs, SpreadMs);
+	}
+
+	/**
+	 * GT.Benchmark.MovementTypes [NumUnits] [Iterations]
+	 * Spawns NumUnits character units and NumUnits pawn units walking in random directions, times each movement bucket
+	 * of the manager on its own, then destroys them. Units already in the world are part of their bucket's cost.
+	 */
+	void RunMovementTypesBenchmark(const TArray<FString>& Args, UWorld* World)
+	{
+		AGTPawnMovementManager* Manager = AGTPawnMovementManager::Get(World);
+		if (Manager == nullptr)
+		{
+			UE_LOG(LogTemp, Error, TEXT("GT.Benchmark.MovementTypes needs a world with a movement manager"));
+			return;
+		}
+
+		const int32 NumUnits = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 2000;
+		const int32 NumIterations = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 20;
+		constexpr float DeltaTime = 1.f / 30.f;
+		constexpr float Spacing = 150.f;
+
+		FRandomStream Random(RandomSeed);
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		const int32 Columns = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(NumUnits)));
+
+		TArray<APawn*> Characters;
+		TArray<APawn*> Pawns;
+		Manager->ReserveUnits(NumUnits * 2);
+		for (int32 Index = 0; Index < NumUnits; ++Index)
+		{
+			const FVector Location((Index % Columns) * Spacing, (Index / Columns) * Spacing, 200.f);
+			if (APawn* Character = World->SpawnActor<AGTNewCharacter>(Location, FRotator::ZeroRotator, SpawnParameters))
+			{
+				Character->SpawnDefaultController();
+				Characters.Add(Character);
+			}
+			if (APawn* Pawn = World->SpawnActor<AGTCharacterUnit>(Location + FVector(0.f, 0.f, 400.f), FRotator::ZeroRotator, SpawnParameters))
+			{
+				Pawn->SpawnDefaultController();
+				Pawns.Add(Pawn);
+			}
+		}
+
+		double CharacterMs = 0.0;
+		double PawnMs = 0.0;
+		const auto RandomDirection = [&Random]()
+		{
+			return FVector(Random.FRandRange(-1.f, 1.f), Random.FRandRange(-1.f, 1.f), 0.f).GetSafeNormal();
+		};
+
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			for (APawn* Character : Characters)
+			{
+				const UGTCharacterMovementComponent* MovementComponent = CastChecked<UGTCharacterMovementComponent>(Character->GetMovementComponent());
+				Manager->RequestUnitVelocity(MovementComponent->GetUnitId(), RandomDirection() * 400.f);
+			}
+			for (APawn* Pawn : Pawns)
+			{
+				Pawn->AddMovementInput(RandomDirection());
+			}
+
+			double StartTime = FPlatformTime::Seconds();
+			Manager->UpdateCharacterMovement(DeltaTime);
+			CharacterMs += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+			StartTime = FPlatformTime::Seconds();
+			Manager->UpdatePawnMovement(DeltaTime);
+			PawnMs += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+		}
+
+		const int32 NumCharacters = Manager->GetNumUnits();
+		const int32 NumPawns = Manager->PawnMovementComponents.Num();
+		UE_LOG(LogTemp, Display, TEXT("Movement types benchmark, %d iterations: character bucket %d units %.3f us per unit, pawn bucket %d units %.3f us per unit"),
+		       NumIterations, NumCharacters, CharacterMs * 1000.0 / FMath::Max(NumIterations * NumCharacters, 1),
+		       NumPawns, PawnMs * 1000.0 / FMath::Max(NumIterations * NumPawns, 1));
+
+		for (APawn* Unit : Characters)
+		{
+			Unit->Destroy();
+		}
+		for (APawn* Unit : Pawns)
+		{
+			Unit->Destroy();
+		}
+	}
+
+	/**
+	 * GT.Benchmark.Separation [NumUnits] [Frames]
+	 * Drops NumUnits units of two teams into a blob a quarter of the area they need and times the separation pass
+	 * relaxing it frame by frame, printing how much overlap is left.
+	 */
+	void RunSeparationBenchmark(const TArray<FString>& Args)
+	{
+		const int32 NumUnits = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 5000;
+		const int32 NumFrames = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 30;
+		constexpr float UnitRadius = 40.f;
+		const float BlobRadius = FMath::Sqrt(static_cast<float>(NumUnits)) * UnitRadius * 0.5f;
+
+		FRandomStream Random(RandomSeed);
+		TArray<FGTSeparationBody> Bodies;
+		Bodies.SetNum(NumUnits);
+		for (FGTSeparationBody& Body : Bodies)
+		{
+			const float Angle = Random.FRandRange(0.f, UE_TWO_PI);
+			const float Distance = BlobRadius * FMath::Sqrt(Random.FRand());
+			Body.Position = FVector2f(FMath::Cos(Angle), FMath::Sin(Angle)) * Distance;
+			Body.Radius = UnitRadius;
+			Body.TeamId = FGenericTeamId(Random.RandHelper(2));
+			Body.bMoving = Random.FRand() < 0.5f;
+		}
+
+		TArray<FVector2f> Pushes;
+		Pushes.SetNumZeroed(NumUnits);
+		const float StartOverlap = FGTUnitSeparation::MeasureOverlap(Bodies, Pushes);
+
+		FGTUnitSeparation Separation;
+		double SolveMs = 0.0;
+		uint64 SolveCycles = 0;
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			Separation.Solve(Bodies, NumUnits, Pushes);
+			SolveMs += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+			SolveCycles += Separation.GetLastSolveCycles();
+
+			for (int32 Index = 0; Index < NumUnits; ++Index)
+			{
+				Bodies[Index].Position += Pushes[Index];
+			}
+		}
+
+		Pushes.SetNumZeroed(NumUnits);
+		const float EndOverlap = FGTUnitSeparation::MeasureOverlap(Bodies, Pushes);
+		UE_LOG(LogTemp, Display, TEXT("Separation benchmark, %d units, %d frames of %d iterations: %.3f ms per frame, %.3f ms CPU over every worker, overlap %.0f -> %.0f (%.1f%% left)"),
+		       NumUnits, NumFrames, Separation.Iterations, SolveMs / FMath::Max(NumFrames, 1),
+		       FPlatformTime::ToMilliseconds64(SolveCycles) / FMath::Max(NumFrames, 1), StartOverlap, EndOverlap,
+		       StartOverlap > 0.f ? EndOverlap * 100.f / StartOverlap : 0.f);
+	}
+
+	/**
+	 * GT.Benchmark.CrowdAnimation [NumUnits] [Frames] [UpdateRate]
+	 * Spawns NumUnits character units playing the jog and times their animation over Frames frames three ways: every
+	 * mesh evaluating its own animation every frame, every UpdateRate frames, and copying shared leader poses.
+	 */
+	void RunCrowdAnimationBenchmark(const TArray<FString>& Args, UWorld* World)
+	{
+		AGTPawnMovementManager* Manager = AGTPawnMovementManager::Get(World);
+		if (Manager == nullptr)
+		{
+			UE_LOG(LogTemp, Error, TEXT("GT.Benchmark.CrowdAnimation needs a world with a movement manager"));
+			return;
+		}
+
+		UAnimSequenceBase* JogAnimation = Manager->JogAnimation.LoadSynchronous();
+		USkeletalMesh* DefaultMesh = LoadObject<USkeletalMesh>(nullptr, TEXT("/Game/Characters/Mannequins/Meshes/SK_Mannequin.SK_Mannequin"));
+		if (JogAnimation == nullptr || DefaultMesh == nullptr)
+		{
+			UE_LOG(LogTemp, Error, TEXT("GT.Benchmark.CrowdAnimation could not load the mannequin or the manager's jog animation"));
+			return;
+		}
+
+		const int32 NumUnits = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 2000;
+		const int32 NumFrames = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 60;
+		const int32 UpdateRate = Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 4;
+		constexpr float DeltaTime = 1.f / 30.f;
+		constexpr float Spacing = 150.f;
+
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		const int32 Columns = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(NumUnits)));
+
+		TArray<ACharacter*> Characters;
+		TArray<FGTUnitAnimation> Units;
+		Manager->ReserveUnits(NumUnits);
+		for (int32 Index = 0; Index < NumUnits; ++Index)
+		{
+			const FVector Location((Index % Columns) * Spacing, (Index / Columns) * Spacing, 200.f);
+			if (ACharacter* Character = World->SpawnActor<AGTNewCharacter>(Location, FRotator::ZeroRotator, SpawnParameters))
+			{
+				USkeletalMeshComponent* Mesh = Character->GetMesh();
+				if (Mesh->GetSkeletalMeshAsset() == nullptr)
+				{
+					Mesh->SetSkeletalMesh(DefaultMesh);
+				}
+				// Nothing is rendered during the benchmark, the meshes have to animate regardless.
+				Mesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+				Mesh->PlayAnimation(JogAnimation, true);
+				Characters.Add(Character);
+				Units.AddDefaulted_GetRef().Mesh = Mesh;
+			}
+		}
+
+		FGTCrowdAnimation CrowdAnimation;
+		CrowdAnimation.IdleAnimation = Manager->IdleAnimation.LoadSynchronous();
+		CrowdAnimation.JogAnimation = JogAnimation;
+		CrowdAnimation.NumPhaseBuckets = Manager->AnimationPhaseBuckets;
+
+		// The update rate optimizations skip frames by the frame counter, which does not move while the command runs.
+		const auto TimeFrames = [&Units, &CrowdAnimation, NumFrames, DeltaTime]()
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+			{
+				++GFrameCounter;
+				for (USkeletalMeshComponent* Leader : CrowdAnimation.GetLeaders())
+				{
+					Leader->TickComponent(DeltaTime, LEVELTICK_All, nullptr);
+				}
+				for (const FGTUnitAnimation& Unit : Units)
+				{
+					if (Unit.Mesh->IsComponentTickEnabled())
+					{
+						Unit.Mesh->TickComponent(DeltaTime, LEVELTICK_All, nullptr);
+					}
+				}
+			}
+			return (FPlatformTime::Seconds() - StartTime) * 1000.0 / FMath::Max(NumFrames, 1);
+		};
+
+		for (FGTUnitAnimation& Unit : Units)
+		{
+			CrowdAnimation.SetOwnAnimation(Unit, 1);
+		}
+		const double EveryFrameMs = TimeFrames();
+
+		for (FGTUnitAnimation& Unit : Units)
+		{
+			CrowdAnimation.SetOwnAnimation(Unit, UpdateRate);
+		}
+		const double UpdateRateMs = TimeFrames();
+
+		for (int32 Index = 0; Index < Units.Num(); ++Index)
+		{
+			CrowdAnimation.SetSharedAnimation(Units[Index], EGTCrowdAnimState::Jog, Index, *Manager);
+		}
+		const double SharedMs = TimeFrames();
+
+		const int32 NumSpawned = FMath::Max(Units.Num(), 1);
+		UE_LOG(LogTemp, Display, TEXT("Crowd animation benchmark, %d units, %d frames: every frame %.3f ms (%.3f us per unit), every %d frames %.3f ms (%.3f us per unit), shared %.3f ms (%.3f us per unit) over %d leaders"),
+		       Units.Num(), NumFrames, EveryFrameMs, EveryFrameMs * 1000.0 / NumSpawned, UpdateRate, UpdateRateMs, UpdateRateMs * 1000.0 / NumSpawned,
+		       SharedMs, SharedMs * 1000.0 / NumSpawned, CrowdAnimation.GetLeaders().Num());
+
+		for (FGTUnitAnimation& Unit : Units)
+		{
+			CrowdAnimation.Release(Unit);
+		}
+		CrowdAnimation.Reset();
+		for (ACharacter* Unit : Characters)
+		{
+			Unit->Destroy();
+		}
+	}
+
+	/** Registered components of Actors, each of which costs its share of the scene and tick setup. */
+	int32 CountRegisteredComponents(TConstArrayView<ACharacter*> Actors)
+	{
+		int32 NumRegistered = 0;
+		for (const ACharacter* Actor : Actors)
+		{
+			for (const UActorComponent* Component : Actor->GetComponents())
+			{
+				NumRegistered += Component && Component->IsRegistered() ? 1 : 0;
+			}
+		}
+		return NumRegistered;
+	}
+
+	/**
+	 * GT.Benchmark.UnitProxies [NumUnits] [Frames]
+	 * Spawns NumUnits character units, turns all of them into instanced mesh proxies and times gathering and committing
+	 * the proxy transforms of Frames moving frames, printing the registered components before and after.
+	 */
+	void RunUnitProxiesBenchmark(const TArray<FString>& Args, UWorld* World)
+	{
+		AGTPawnMovementManager* Manager = AGTPawnMovementManager::Get(World);
+		UStaticMesh* ProxyMesh = Manager ? Manager->DefaultUnitProxyMesh.LoadSynchronous() : nullptr;
+		if (ProxyMesh == nullptr)
+		{
+			UE_LOG(LogTemp, Error, TEXT("GT.Benchmark.UnitProxies needs a world with a movement manager that has a default proxy mesh"));
+			return;
+		}
+
+		const int32 NumUnits = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 2000;
+		const int32 NumFrames = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 60;
+		constexpr float Spacing = 150.f;
+
+		FRandomStream Random(RandomSeed);
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		const int32 Columns = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(NumUnits)));
+
+		TArray<ACharacter*> Characters;
+		TArray<FGTUnitProxy> Units;
+		TArray<FVector> Locations;
+		Manager->ReserveUnits(NumUnits);
+		for (int32 Index = 0; Index < NumUnits; ++Index)
+		{
+			const FVector Location((Index % Columns) * Spacing, (Index / Columns) * Spacing, 200.f);
+			if (ACharacter* Character = World->SpawnActor<AGTNewCharacter>(Location, FRotator::ZeroRotator, SpawnParameters))
+			{
+				Characters.Add(Character);
+				Units.AddDefaulted_GetRef().Mesh = Character->GetMesh();
+				Locations.Add(Location);
+			}
+		}
+
+		const int32 FullComponents = CountRegisteredComponents(Characters);
+
+		FGTUnitProxyMeshes ProxyMeshes;
+		double SetProxyMs = FPlatformTime::Seconds();
+		for (FGTUnitProxy& Unit : Units)
+		{
+			ProxyMeshes.SetProxy(Unit, *ProxyMesh, *Manager);
+		}
+		SetProxyMs = (FPlatformTime::Seconds() - SetProxyMs) * 1000.0;
+		const int32 ProxyComponents = CountRegisteredComponents(Characters);
+
+		double UpdateMs = 0.0;
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			for (FVector& Location : Locations)
+			{
+				Location += FVector(Random.FRandRange(-10.f, 10.f), Random.FRandRange(-10.f, 10.f), 0.f);
+			}
+
+			const double StartTime = FPlatformTime::Seconds();
+			for (int32 Index = 0; Index < Units.Num(); ++Index)
+			{
+				ProxyMeshes.AddInstance(Units[Index], Locations[Index]);
+			}
+			ProxyMeshes.CommitInstances();
+			UpdateMs += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+		}
+
+		const int32 NumSpawned = FMath::Max(Units.Num(), 1);
+		UE_LOG(LogTemp, Display, TEXT("Unit proxies benchmark, %d units, %d frames: registered components %d -> %d (+%d instanced meshes), switching %.3f ms, instance update %.3f ms per frame (%.3f us per unit), %d instances"),
+		       Units.Num(), NumFrames, FullComponents, ProxyComponents, ProxyMeshes.GetNumTypes(), SetProxyMs,
+		       UpdateMs / FMath::Max(NumFrames, 1), UpdateMs * 1000.0 / FMath::Max(NumFrames, 1) / NumSpawned, ProxyMeshes.GetNumInstances());
+
+		for (FGTUnitProxy& Unit : Units)
+		{
+			ProxyMeshes.SetFullActor(Unit);
+		}
+		ProxyMeshes.Reset();
+		for (ACharacter* Unit : Characters)
+		{
+			Unit->Destroy();
+		}
+	}
+
+	/**
+	 * GT.Benchmark.Entities [NumUnits] [Frames]
+	 * Creates NumUnits entity units on the navmesh around the origin, walks them in random directions and times the
+	 * character update over Frames frames, printing how many of them have an actor.
+	 */
+	void RunEntitiesBenchmark(const TArray<FString>& Args, UWorld* World)
+	{
+		AGTPawnMovementManager* Manager = AGTPawnMovementManager::Get(World);
+		UNavigationSystemV1* NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World);
+		if (Manager == nullptr || NavigationSystem == nullptr)
+		{
+			UE_LOG(LogTemp, Error, TEXT("GT.Benchmark.Entities needs a world with a movement manager and a navmesh"));
+			return;
+		}
+
+		const int32 NumUnits = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 50000;
+		const int32 NumFrames = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 60;
+		constexpr float DeltaTime = 1.f / 30.f;
+		constexpr float Spacing = 120.f;
+		const FVector ProjectionExtent(Spacing, Spacing, 1000.f);
+
+		FRandomStream Random(RandomSeed);
+		const int32 Columns = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(NumUnits)));
+		const FVector Origin(-Columns * Spacing * 0.5f, -Columns * Spacing * 0.5f, 0.f);
+
+		TArray<int32> UnitIds;
+		UnitIds.Reserve(NumUnits);
+		Manager->ReserveUnits(NumUnits);
+		double CreateMs = FPlatformTime::Seconds();
+		for (int32 Index = 0; Index < NumUnits; ++Index)
+		{
+			FNavLocation NavLocation;
+			const FVector Location = Origin + FVector((Index % Columns) * Spacing, (Index / Columns) * Spacing, 0.f);
+			if (NavigationSystem->ProjectPointToNavigation(Location, NavLocation, ProjectionExtent))
+			{
+				UnitIds.Add(Manager->CreateUnitEntity(AGTNewCharacter::StaticClass(), NavLocation.Location, FGenericTeamId(Random.RandHelper(2))));
+			}
+		}
+		CreateMs = (FPlatformTime::Seconds() - CreateMs) * 1000.0;
+
+		double UpdateMs = 0.0;
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			for (const int32 UnitId : UnitIds)
+			{
+				Manager->RequestUnitVelocity(UnitId, FVector(Random.FRandRange(-1.f, 1.f), Random.FRandRange(-1.f, 1.f), 0.f).GetSafeNormal() * 300.f);
+			}
+
+			const double StartTime = FPlatformTime::Seconds();
+			Manager->UpdateCharacterMovement(DeltaTime);
+			UpdateMs += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+		}
+
+		int32 NumHydrated = 0;
+		for (const int32 UnitId : UnitIds)
+		{
+			NumHydrated += Manager->IsUnitHydrated(UnitId) ? 1 : 0;
+		}
+		UE_LOG(LogTemp, Display, TEXT("Entities benchmark, %d units (%d with an actor), %d frames: created in %.3f ms, update %.3f ms per frame (%.3f us per unit)"),
+		       UnitIds.Num(), NumHydrated, NumFrames, CreateMs, UpdateMs / FMath::Max(NumFrames, 1),
+		       UpdateMs * 1000.0 / FMath::Max(NumFrames, 1) / FMath::Max(UnitIds.Num(), 1));
+
+		for (const int32 UnitId : UnitIds)
+		{
+			Manager->DestroyUnit(UnitId);
+		}
+	}
+
+	/**
+	 * GT.Benchmark.FogOfWar [NumViewers] [Frames] [MovingShare]
+	 * Scatters NumViewers viewers of two teams over the navmesh and walks MovingShare of them each frame, timing the
+	 * incremental update against stamping every viewer again.
+	 */
+	void RunFogOfWarBenchmark(const TArray<FString>& Args, UWorld* World)
+	{
+		UNavigationSystemV1* NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World);
+		const ANavigationData* NavData = NavigationSystem ? NavigationSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+		if (NavData == nullptr || !NavData->GetBounds().IsValid)
+		{
+			UE_LOG(LogTemp, Error, TEXT("GT.Benchmark.FogOfWar needs a world with a navmesh"));
+			return;
+		}
+
+		const int32 NumViewers = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 5000;
+		const int32 NumFrames = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 60;
+		const float MovingShare = Args.Num() > 2 ? FCString::Atof(*Args[2]) : 0.2f;
+		constexpr float SightRadius = 1500.f;
+		constexpr float StepLength = 60.f;
+
+		// Sampled from the heightfield the manager walks units on, as AGTPawnMovementManager::UpdateFogOfWar does.
+		double HeightfieldMs = FPlatformTime::Seconds();
+		const TSharedPtr<const FGTNavHeightfield, ESPMode::ThreadSafe> Heightfield = FGTNavHeightfield::Build(*NavData, GetDefault<AGTPawnMovementManager>()->PhysicsThreadNavCellSize);
+		HeightfieldMs = (FPlatformTime::Seconds() - HeightfieldMs) * 1000.0;
+
+		FGTFogOfWar FogOfWar;
+		double InitializeMs = FPlatformTime::Seconds();
+		FogOfWar.Initialize(NavData->GetBounds(), Heightfield.Get());
+		InitializeMs = (FPlatformTime::Seconds() - InitializeMs) * 1000.0;
+
+		const FBox Bounds = NavData->GetBounds();
+		FRandomStream Random(RandomSeed);
+		TArray<FVector> Locations;
+		Locations.SetNumUninitialized(NumViewers);
+		for (FVector& Location : Locations)
+		{
+			Location = FVector(Random.FRandRange(Bounds.Min.X, Bounds.Max.X), Random.FRandRange(Bounds.Min.Y, Bounds.Max.Y), Bounds.GetCenter().Z);
+		}
+
+		double StampMs = FPlatformTime::Seconds();
+		for (int32 Viewer = 0; Viewer < NumViewers; ++Viewer)
+		{
+			FogOfWar.UpdateViewer(Viewer, Locations[Viewer], FGenericTeamId(Viewer % 2), SightRadius);
+		}
+		StampMs = (FPlatformTime::Seconds() - StampMs) * 1000.0;
+
+		double IncrementalMs = 0.0;
+		int64 NumRestamped = 0;
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			for (int32 Viewer = 0; Viewer < NumViewers; ++Viewer)
+			{
+				if (Random.FRand() < MovingShare)
+				{
+					const float Angle = Random.FRandRange(0.f, 2.f * PI);
+					Locations[Viewer] += FVector(FMath::Cos(Angle) * StepLength, FMath::Sin(Angle) * StepLength, 0.f);
+				}
+			}
+
+			const double StartTime = FPlatformTime::Seconds();
+			for (int32 Viewer = 0; Viewer < NumViewers; ++Viewer)
+			{
+				NumRestamped += FogOfWar.UpdateViewer(Viewer, Locations[Viewer], FGenericTeamId(Viewer % 2), SightRadius) ? 1 : 0;
+			}
+			IncrementalMs += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+		}
+
+		// What a grid cleared and stamped from scratch every frame would pay.
+		double FullMs = 0.0;
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			for (int32 Viewer = 0; Viewer < NumViewers; ++Viewer)
+			{
+				FogOfWar.RemoveViewer(Viewer);
+			}
+			for (int32 Viewer = 0; Viewer < NumViewers; ++Viewer)
+			{
+				FogOfWar.UpdateViewer(Viewer, Locations[Viewer], FGenericTeamId(Viewer % 2), SightRadius);
+			}
+			FullMs += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+		}
+
+		UE_LOG(LogTemp, Display, TEXT("Fog of war benchmark, %d viewers, %d frames, %.0f%% moving, %dx%d cells (%.1f KiB): heightfield %.3f ms, initialize %.3f ms, first stamp %.3f ms, incremental %.3f ms per frame (%.1f restamped), every viewer %.3f ms per frame, team 0 sees %d cells, team 1 %d"),
+		       NumViewers, NumFrames, MovingShare * 100.f, FogOfWar.GetNumCellsX(), FogOfWar.GetNumCellsY(), FogOfWar.GetAllocatedSize() / 1024.0,
+		       HeightfieldMs, InitializeMs, StampMs, IncrementalMs / FMath::Max(NumFrames, 1), static_cast<double>(NumRestamped) / FMath::Max(NumFrames, 1),
+		       FullMs / FMath::Max(NumFrames, 1), FogOfWar.GetVisibleCells(FGenericTeamId(0)).CountSetBits(),
+		       FogOfWar.GetVisibleCells(FGenericTeamId(1)).CountSetBits());
+	}
+
+	/**
+	 * GT.Benchmark.Targeting [UnitsPerTeam] [Frames]
+	 * Lines up two armies of UnitsPerTeam units in contact along one front and times the batched closest-enemy search
+	 * with every unit searching each frame, and with searches throttled like the default significance buckets. One
+	 * frame is checked against testing every enemy of every unit.
+	 */
+	void RunTargetingBenchmark(const TArray<FString>& Args)
+	{
+		const int32 UnitsPerTeam = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 5000;
+		const int32 NumFrames = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 30;
+		constexpr float Spacing = 100.f;
+		constexpr float Range = 1500.f;
+		const int32 Rows = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(UnitsPerTeam)));
+
+		// Team 0 stands at negative X and team 1 at positive X, their front ranks a spacing apart.
+		FRandomStream Random(RandomSeed);
+		TArray<FGTTargetingBody> Bodies;
+		Bodies.SetNum(UnitsPerTeam * 2);
+		TArray<int32> Intervals;
+		Intervals.SetNumUninitialized(Bodies.Num());
+		for (int32 Index = 0; Index < Bodies.Num(); ++Index)
+		{
+			const int32 Team = Index / UnitsPerTeam;
+			const int32 Rank = (Index % UnitsPerTeam) / Rows;
+			const int32 File = (Index % UnitsPerTeam) % Rows;
+			const float X = (Rank + 0.5f) * Spacing * (Team == 0 ? -1.f : 1.f);
+			Bodies[Index].Position = FVector2f(X, (File - Rows * 0.5f) * Spacing);
+			Bodies[Index].TeamId = FGenericTeamId(static_cast<uint8>(Team));
+
+			// Share of units in the high, medium, low and culled buckets of a battle under the camera.
+			const float Bucket = Random.FRand();
+			Intervals[Index] = Bucket < 0.1f ? 1 : Bucket < 0.3f ? 2 : Bucket < 0.6f ? 4 : 8;
+		}
+
+		FGTTargetAcquisition TargetAcquisition;
+		TargetAcquisition.Range = Range;
+		TArray<int32> Targets;
+		Targets.Init(INDEX_NONE, Bodies.Num());
+
+		double EveryFrameMs = 0.0;
+		uint64 EveryFrameCycles = 0;
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			for (FGTTargetingBody& Body : Bodies)
+			{
+				Body.Position += FVector2f(Random.FRandRange(-5.f, 5.f), Random.FRandRange(-5.f, 5.f));
+				Body.bSearching = true;
+			}
+
+			const double StartTime = FPlatformTime::Seconds();
+			TargetAcquisition.Acquire(Bodies, Targets);
+			EveryFrameMs += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+			EveryFrameCycles += TargetAcquisition.GetLastAcquireCycles();
+		}
+
+		// Nearest hostile of each unit by testing every unit of the other team.
+		double BruteForceMs = FPlatformTime::Seconds();
+		int32 NumMismatches = 0;
+		int32 NumWithTarget = 0;
+		for (int32 Index = 0; Index < Bodies.Num(); ++Index)
+		{
+			float NearestDistanceSquared = FMath::Square(Range);
+			bool bFound = false;
+			for (int32 Other = 0; Other < Bodies.Num(); ++Other)
+			{
+				if (Bodies[Other].TeamId != Bodies[Index].TeamId)
+				{
+					const float DistanceSquared = FVector2f::DistSquared(Bodies[Other].Position, Bodies[Index].Position);
+					bFound |= DistanceSquared <= NearestDistanceSquared;
+					NearestDistanceSquared = FMath::Min(NearestDistanceSquared, DistanceSquared);
+				}
+			}
+			const float FoundDistanceSquared = Targets[Index] != INDEX_NONE ? FVector2f::DistSquared(Bodies[Targets[Index]].Position, Bodies[Index].Position) : -1.f;
+			NumMismatches += bFound != (Targets[Index] != INDEX_NONE) || (bFound && !FMath::IsNearlyEqual(FoundDistanceSquared, NearestDistanceSquared, 1.f)) ? 1 : 0;
+			NumWithTarget += bFound ? 1 : 0;
+		}
+		BruteForceMs = (FPlatformTime::Seconds() - BruteForceMs) * 1000.0;
+
+		double ThrottledMs = 0.0;
+		int64 NumSearches = 0;
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			for (int32 Index = 0; Index < Bodies.Num(); ++Index)
+			{
+				Bodies[Index].Position += FVector2f(Random.FRandRange(-5.f, 5.f), Random.FRandRange(-5.f, 5.f));
+				Bodies[Index].bSearching = (Frame + Index) % Intervals[Index] == 0;
+				NumSearches += Bodies[Index].bSearching ? 1 : 0;
+			}
+
+			const double StartTime = FPlatformTime::Seconds();
+			TargetAcquisition.Acquire(Bodies, Targets);
+			ThrottledMs += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+		}
+
+		UE_LOG(LogTemp, Display, TEXT("Targeting benchmark, 2x%d units in contact, %d frames: every unit %.3f ms per frame (%.3f ms CPU over every worker), throttled %.3f ms per frame (%.0f searches), every enemy tested %.3f ms, %d units with a target, %d mismatches"),
+		       UnitsPerTeam, NumFrames, EveryFrameMs / FMath::Max(NumFrames, 1), FPlatformTime::ToMilliseconds64(EveryFrameCycles) / FMath::Max(NumFrames, 1),
+		       ThrottledMs / FMath::Max(NumFrames, 1), static_cast<double>(NumSearches) / FMath::Max(NumFrames, 1), BruteForceMs, NumWithTarget, NumMismatches);
+	}
+
+	FAutoConsoleCommand SelectionBenchmarkCommand(
+		TEXT("GT.Benchmark.Selection"),
+		TEXT("Times box selection through the unit grid. Args: [NumUnits=20000] [NumQueries=1000]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunSelectionBenchmark));
+
+	FAutoConsoleCommand SpatialOrderBenchmarkCommand(
+		TEXT("GT.Benchmark.SpatialOrder"),
+		TEXT("Times a terrain reading pass over units in registration order and in Z-order. Args: [NumUnits=20000] [Iterations=20]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunSpatialOrderBenchmark));
+
+	FAutoConsoleCommand MovementStateBenchmarkCommand(
+		TEXT("GT.Benchmark.MovementState"),
+		TEXT("Prints the per-unit movement state sizes and times an update over packed and component-spaced records. Args: [NumUnits=20000] [Iterations=20]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunMovementStateBenchmark));
+
+	FAutoConsoleCommandWithWorldAndArgs MovementTypesBenchmarkCommand(
+		TEXT("GT.Benchmark.MovementTypes"),
+		TEXT("Spawns character and pawn units and times each movement bucket per unit. Args: [NumUnits=2000] [Iterations=20]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunMovementTypesBenchmark));
+
+	FAutoConsoleCommand SeparationBenchmarkCommand(
+		TEXT("GT.Benchmark.Separation"),
+		TEXT("Times the separation pass relaxing a packed blob of two teams. Args: [NumUnits=5000] [Frames=30]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunSeparationBenchmark));
+
+	FAutoConsoleCommandWithWorldAndArgs CrowdAnimationBenchmarkCommand(
+		TEXT("GT.Benchmark.CrowdAnimation"),
+		TEXT("Spawns jogging character units and times their animation evaluated every frame, at a reduced update rate, and shared. Args: [NumUnits=2000] [Frames=60] [UpdateRate=4]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunCrowdAnimationBenchmark));
+
+	FAutoConsoleCommandWithWorldAndArgs UnitProxiesBenchmarkCommand(
+		TEXT("GT.Benchmark.UnitProxies"),
+		TEXT("Spawns character units, draws them as instanced mesh proxies and prints the component counts and instance update time. Args: [NumUnits=2000] [Frames=60]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunUnitProxiesBenchmark));
+
+	FAutoConsoleCommandWithWorldAndArgs EntitiesBenchmarkCommand(
+		TEXT("GT.Benchmark.Entities"),
+		TEXT("Creates entity units without actors on the navmesh and times the character update walking them. Args: [NumUnits=50000] [Frames=60]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunEntitiesBenchmark));
+
+	FAutoConsoleCommandWithWorldAndArgs FogOfWarBenchmarkCommand(
+		TEXT("GT.Benchmark.FogOfWar"),
+		TEXT("Times the incremental fog of war update against stamping every viewer again. Args: [NumViewers=5000] [Frames=60] [MovingShare=0.2]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunFogOfWarBenchmark));
+
+	FAutoConsoleCommand TargetingBenchmarkCommand(
+		TEXT("GT.Benchmark.Targeting"),
+		TEXT("Times the batched closest-enemy search over two armies in contact, every frame and throttled. Args: [UnitsPerTeam=5000] [Frames=30]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunTargetingBenchmark));
+}
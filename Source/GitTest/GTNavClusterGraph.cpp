@@ -0,0 +1,283 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GTNavClusterGraph.h"
+#include "GTFrameArena.h"
+
+#include "NavigationData.h"
+#include "NavigationSystem.h"
+#include "NavMesh/NavMeshPath.h"
+#include "Algo/Reverse.h"
+
+DECLARE_CYCLE_STAT(TEXT("FGTNavClusterGraph Update"), STAT_FGTNavClusterGraph_Update, STATGROUP_Game);
+DECLARE_CYCLE_STAT(TEXT("FGTNavClusterGraph FindRoute"), STAT_FGTNavClusterGraph_FindRoute, STATGROUP_Game);
+
+namespace GTNavClusterGraph
+{
+	const FIntPoint NeighbourOffsets[] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+
+	/** Edge searches are cut off past this many cluster sizes, a longer detour is not a real connection between neighbours. */
+	constexpr float MaxEdgeCostInClusters = 4.f;
+}
+
+FGTNavClusterGraph::~FGTNavClusterGraph()
+{
+	Reset();
+}
+
+void FGTNavClusterGraph::Reset()
+{
+	for (TPair<uint64, FEdge>& Pair : Edges)
+	{
+		if (Pair.Value.Path.IsValid())
+		{
+			Pair.Value.Path->RemoveObserver(Pair.Value.ObserverHandle);
+		}
+	}
+	Nodes.Reset();
+	Edges.Reset();
+	PathToEdge.Reset();
+	DirtyNodes.Reset();
+	DirtyEdges.Reset();
+	NavData.Reset();
+	NavigationSystem.Reset();
+}
+
+void FGTNavClusterGraph::Initialize(UNavigationSystemV1& InNavigationSystem, ANavigationData& InNavData, float InClusterSize)
+{
+	Reset();
+	NavigationSystem = &InNavigationSystem;
+	NavData = &InNavData;
+	ClusterSize = FMath::Max(InClusterSize, 100.f);
+
+	const FBox Bounds = InNavData.GetBounds();
+	if (!Bounds.IsValid)
+	{
+		return;
+	}
+
+	const FIntPoint Min = GetCluster(Bounds.Min);
+	const FIntPoint Max = GetCluster(Bounds.Max);
+	for (int32 Y = Min.Y; Y <= Max.Y; ++Y)
+	{
+		for (int32 X = Min.X; X <= Max.X; ++X)
+		{
+			DirtyNodes.Add(FIntPoint(X, Y));
+		}
+	}
+}
+
+uint64 FGTNavClusterGraph::MakeEdgeKey(const FIntPoint& A, const FIntPoint& B)
+{
+	// Clusters are ordered so both directions share one undirected edge.
+	const bool bSwap = A.Y > B.Y || (A.Y == B.Y && A.X > B.X);
+	const FIntPoint& First = bSwap ? B : A;
+	const FIntPoint& Second = bSwap ? A : B;
+	return (static_cast<uint64>(static_cast<uint16>(First.X)) << 48) | (static_cast<uint64>(static_cast<uint16>(First.Y)) << 32)
+		| (static_cast<uint64>(static_cast<uint16>(Second.X)) << 16) | static_cast<uint64>(static_cast<uint16>(Second.Y));
+}
+
+FIntPoint FGTNavClusterGraph::GetCluster(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / ClusterSize), FMath::FloorToInt(Location.Y / ClusterSize));
+}
+
+void FGTNavClusterGraph::UpdateNode(const FIntPoint& Cluster)
+{
+	const ANavigationData* NavDataPtr = NavData.Get();
+	const FBox Bounds = NavDataPtr->GetBounds();
+	const FVector Center((Cluster.X + 0.5f) * ClusterSize, (Cluster.Y + 0.5f) * ClusterSize, Bounds.GetCenter().Z);
+	const FVector Extent(ClusterSize * 0.5f, ClusterSize * 0.5f, Bounds.GetExtent().Z + 100.f);
+
+	FNavLocation NavLocation;
+	const bool bNavigable = NavDataPtr->ProjectPoint(Center, NavLocation, Extent) && GetCluster(NavLocation.Location) == Cluster;
+
+	const FNode* ExistingNode = Nodes.Find(Cluster);
+	if (bNavigable && ExistingNode && ExistingNode->NodeRef == NavLocation.NodeRef)
+	{
+		return;
+	}
+
+	if (bNavigable)
+	{
+		Nodes.Add(Cluster, {NavLocation.Location, NavLocation.NodeRef});
+	}
+	else
+	{
+		Nodes.Remove(Cluster);
+	}
+
+	for (const FIntPoint& Offset : GTNavClusterGraph::NeighbourOffsets)
+	{
+		if (Nodes.Contains(Cluster + Offset))
+		{
+			DirtyEdges.Add(MakeEdgeKey(Cluster, Cluster + Offset));
+		}
+	}
+}
+
+void FGTNavClusterGraph::RemoveEdge(uint64 EdgeKey)
+{
+	FEdge Edge;
+	if (Edges.RemoveAndCopyValue(EdgeKey, Edge) && Edge.Path.IsValid())
+	{
+		Edge.Path->RemoveObserver(Edge.ObserverHandle);
+		PathToEdge.Remove(Edge.Path.Get());
+	}
+}
+
+void FGTNavClusterGraph::UpdateEdge(uint64 EdgeKey)
+{
+	RemoveEdge(EdgeKey);
+
+	const FIntPoint A(static_cast<int16>(EdgeKey >> 48), static_cast<int16>(EdgeKey >> 32));
+	const FIntPoint B(static_cast<int16>(EdgeKey >> 16), static_cast<int16>(EdgeKey));
+	const FNode* NodeA = Nodes.Find(A);
+	const FNode* NodeB = Nodes.Find(B);
+	if (NodeA == nullptr || NodeB == nullptr)
+	{
+		return;
+	}
+
+	ANavigationData* NavDataPtr = NavData.Get();
+	FNavPathSharedPtr Path = MakeShared<FNavMeshPath, ESPMode::ThreadSafe>();
+	const FPathFindingQuery Query(nullptr, *NavDataPtr, NodeA->Location, NodeB->Location, nullptr, Path, ClusterSize * GTNavClusterGraph::MaxEdgeCostInClusters);
+	const FPathFindingResult Result = NavigationSystem->FindPathSync(Query);
+	if (!Result.IsSuccessful() || Result.IsPartial())
+	{
+		return;
+	}
+
+	FEdge& Edge = Edges.Add(EdgeKey);
+	Edge.Cost = Result.Path->GetLength();
+	Edge.Path = Result.Path;
+	Edge.ObserverHandle = Result.Path->AddObserver(FNavigationPath::FPathObserverDelegate::FDelegate::CreateRaw(this, &FGTNavClusterGraph::OnEdgePathEvent));
+	PathToEdge.Add(Result.Path.Get(), EdgeKey);
+	// The graph rebuilds dirty edges itself, a repath by the navigation data would only be thrown away.
+	Result.Path->EnableRecalculationOnInvalidation(false);
+	NavDataPtr->RegisterActivePath(Result.Path);
+}
+
+void FGTNavClusterGraph::OnEdgePathEvent(FNavigationPath* Path, ENavPathEvent::Type Event)
+{
+	if (Event != ENavPathEvent::Invalidated)
+	{
+		return;
+	}
+
+	// A tile on this edge was rebuilt, the node it joins may have moved too.
+	if (const uint64* EdgeKey = PathToEdge.Find(Path))
+	{
+		DirtyEdges.Add(*EdgeKey);
+		DirtyNodes.Add(FIntPoint(static_cast<int16>(*EdgeKey >> 48), static_cast<int16>(*EdgeKey >> 32)));
+		DirtyNodes.Add(FIntPoint(static_cast<int16>(*EdgeKey >> 16), static_cast<int16>(*EdgeKey)));
+	}
+}
+
+void FGTNavClusterGraph::Update(double BudgetMs)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FGTNavClusterGraph_Update);
+	if (!NavData.IsValid() || !NavigationSystem.IsValid() || !IsBuilding())
+	{
+		return;
+	}
+
+	const double EndTime = FPlatformTime::Seconds() + BudgetMs * 0.001;
+
+	// Nodes first, they decide which edges need to be searched.
+	while (DirtyNodes.Num() > 0 && FPlatformTime::Seconds() < EndTime)
+	{
+		const FIntPoint Cluster = *DirtyNodes.CreateConstIterator();
+		DirtyNodes.Remove(Cluster);
+		UpdateNode(Cluster);
+	}
+
+	while (DirtyNodes.Num() == 0 && DirtyEdges.Num() > 0 && FPlatformTime::Seconds() < EndTime)
+	{
+		const uint64 EdgeKey = *DirtyEdges.CreateConstIterator();
+		DirtyEdges.Remove(EdgeKey);
+		UpdateEdge(EdgeKey);
+	}
+}
+
+bool FGTNavClusterGraph::FindRoute(const FVector& Start, const FVector& Goal, TArray<FVector>& OutRoute) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_FGTNavClusterGraph_FindRoute);
+	OutRoute.Reset();
+
+	const FIntPoint StartCluster = GetCluster(Start);
+	const FIntPoint GoalCluster = GetCluster(Goal);
+	const FIntPoint Delta = GoalCluster - StartCluster;
+	if (FMath::Max(FMath::Abs(Delta.X), FMath::Abs(Delta.Y)) <= 1 || !Nodes.Contains(StartCluster))
+	{
+		return false;
+	}
+
+	const FNode* GoalNode = Nodes.Find(GoalCluster);
+	if (GoalNode == nullptr)
+	{
+		return false;
+	}
+
+	struct FOpenNode
+	{
+		float EstimatedCost;
+		FIntPoint Cluster;
+	};
+	const auto OpenPredicate = [](const FOpenNode& A, const FOpenNode& B) { return A.EstimatedCost < B.EstimatedCost; };
+
+	FGTFrameArenaScope ArenaScope;
+	TGTFrameArray<FOpenNode> OpenList;
+	TGTFrameMap<FIntPoint, float> CostSoFar;
+	TGTFrameMap<FIntPoint, FIntPoint> CameFrom;
+
+	OpenList.HeapPush({0.f, StartCluster}, OpenPredicate);
+	CostSoFar.Add(StartCluster, 0.f);
+
+	bool bFound = false;
+	while (OpenList.Num() > 0)
+	{
+		FOpenNode Current;
+		OpenList.HeapPop(Current, OpenPredicate, false);
+		if (Current.Cluster == GoalCluster)
+		{
+			bFound = true;
+			break;
+		}
+
+		const float CurrentCost = CostSoFar.FindChecked(Current.Cluster);
+		for (const FIntPoint& Offset : GTNavClusterGraph::NeighbourOffsets)
+		{
+			const FIntPoint Neighbour = Current.Cluster + Offset;
+			const FEdge* Edge = Edges.Find(MakeEdgeKey(Current.Cluster, Neighbour));
+			if (Edge == nullptr)
+			{
+				continue;
+			}
+
+			const float NewCost = CurrentCost + Edge->Cost;
+			const float* KnownCost = CostSoFar.Find(Neighbour);
+			if (KnownCost == nullptr || NewCost < *KnownCost)
+			{
+				CostSoFar.Add(Neighbour, NewCost);
+				CameFrom.Add(Neighbour, Current.Cluster);
+				const float Heuristic = FVector::Dist2D(Nodes.FindChecked(Neighbour).Location, GoalNode->Location);
+				OpenList.HeapPush({NewCost + Heuristic, Neighbour}, OpenPredicate);
+			}
+		}
+	}
+
+	if (!bFound)
+	{
+		return false;
+	}
+
+	// Walk back from the goal, leaving out both the start and goal nodes: the unit starts and ends at its own locations.
+	OutRoute.Add(Goal);
+	for (FIntPoint Cluster = CameFrom.FindChecked(GoalCluster); Cluster != StartCluster; Cluster = CameFrom.FindChecked(Cluster))
+	{
+		OutRoute.Add(Nodes.FindChecked(Cluster).Location);
+	}
+	Algo::Reverse(OutRoute);
+	return true;
+}
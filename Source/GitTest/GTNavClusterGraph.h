@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AI/Navigation/NavigationTypes.h"
+
+class ANavigationData;
+class UNavigationSystemV1;
+
+/**
+ * Coarse navigation graph over square clusters of the navmesh.
+ * Each navigable cluster has one node projected near its center and abstract edges to its eight neighbours, costed by
+ * a real path between the two nodes. Edge paths are registered with the nav data, so a tile rebuild only marks the
+ * edges crossing it dirty and they are recomputed under a time budget in Update.
+ */
+class GITTEST_API FGTNavClusterGraph
+{
+public:
+	~FGTNavClusterGraph();
+
+	/** Queues every cluster inside the nav data bounds, the graph is built over the next Update calls. */
+	void Initialize(UNavigationSystemV1& InNavigationSystem, ANavigationData& InNavData, float InClusterSize);
+	void Reset();
+
+	/** Recomputes dirty nodes and edges until BudgetMs is spent. */
+	void Update(double BudgetMs);
+
+	/**
+	 * Finds the cluster route from Start to Goal. OutRoute holds the nodes after the start cluster followed by Goal.
+	 * Returns false when both ends are in the same or neighbouring clusters, or no route exists.
+	 */
+	bool FindRoute(const FVector& Start, const FVector& Goal, TArray<FVector>& OutRoute) const;
+
+	bool IsInitialized() const { return NavData.IsValid(); }
+	bool IsBuilding() const { return DirtyNodes.Num() > 0 || DirtyEdges.Num() > 0; }
+	int32 GetNumNodes() const { return Nodes.Num(); }
+	int32 GetNumEdges() const { return Edges.Num(); }
+	float GetClusterSize() const { return ClusterSize; }
+
+private:
+	struct FNode
+	{
+		FVector Location;
+		NavNodeRef NodeRef;
+	};
+
+	struct FEdge
+	{
+		float Cost = 0.f;
+		FNavPathSharedPtr Path;
+		FDelegateHandle ObserverHandle;
+	};
+
+	static uint64 MakeEdgeKey(const FIntPoint& A, const FIntPoint& B);
+	FIntPoint GetCluster(const FVector& Location) const;
+
+	void UpdateNode(const FIntPoint& Cluster);
+	void UpdateEdge(uint64 EdgeKey);
+	void RemoveEdge(uint64 EdgeKey);
+	void OnEdgePathEvent(FNavigationPath* Path, ENavPathEvent::Type Event);
+
+	TWeakObjectPtr<UNavigationSystemV1> NavigationSystem;
+	TWeakObjectPtr<ANavigationData> NavData;
+	float ClusterSize = 5000.f;
+
+	TMap<FIntPoint, FNode> Nodes;
+	TMap<uint64, FEdge> Edges;
+	TMap<const FNavigationPath*, uint64> PathToEdge;
+
+	TSet<FIntPoint> DirtyNodes;
+	TSet<uint64> DirtyEdges;
+};
@@ -11,7 +11,10 @@ Super(ObjectInitializer.SetDefaultSubobjectClass<UGTCharacterMovementComponent>(
 {
  	PrimaryActorTick.bCanEverTick = false;
 	
-	GetMesh()->PrimaryComponentTick.bCanEverTick = false;
+	// The manager's crowd animation decides whether and how often the mesh ticks.
+	GetMesh()->PrimaryComponentTick.bCanEverTick = true;
+	GetMesh()->PrimaryComponentTick.bStartWithTickEnabled = false;
+	GetMesh()->bEnableUpdateRateOptimizations = true;
 	GetMesh()->bUseAttachParentBound = true;
 	
 	GetCharacterMovement()->PrimaryComponentTick.bCanEverTick = false;
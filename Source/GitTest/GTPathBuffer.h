@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AI/Navigation/NavigationTypes.h"
+
+/** Range of elements owned by one unit inside a pooled buffer. */
+struct FGTPathSpan
+{
+	int32 Offset = INDEX_NONE;
+	int32 Count = 0;
+
+	bool IsSet() const { return Offset != INDEX_NONE; }
+};
+
+/** Path corner as stored in the manager's waypoint buffer. */
+struct FGTPathWaypoint
+{
+	FVector Location;
+	NavNodeRef NodeRef;
+};
+
+/** Path following progress of one unit, the corners live in the manager's shared waypoint buffer. */
+struct FGTPathFollowState
+{
+	FGTPathSpan Waypoints;
+	/** Poly refs of the corridor the path was built from, used to detect and repair invalidated paths. */
+	FGTPathSpan Corridor;
+	/** Index of the corner the unit is walking to, relative to Waypoints.Offset. */
+	int32 SegmentIndex = 0;
+	float DistanceToCorner = 0.f;
+	float AcceptanceRadius = 0.f;
+	/** Coarse cluster route of a long order, Waypoints only hold the refined part up to Route[RouteIndex]. */
+	FGTPathSpan Route;
+	int32 RouteIndex = 0;
+
+	bool IsActive() const { return Waypoints.Count > 0; }
+	bool HasRouteLeft() const { return Route.IsSet() && RouteIndex < Route.Count - 1; }
+};
+
+/**
+ * Flat pool of elements handed out as spans. Freed spans are reused first fit and the pool is compacted
+ * once more than half of it is holes, so steady state repathing does not touch the heap.
+ */
+template<typename ElementType>
+class TGTSpanPool
+{
+public:
+	FGTPathSpan Allocate(int32 Count)
+	{
+		FGTPathSpan Span;
+		Span.Count = Count;
+		if (Count <= 0)
+		{
+			return Span;
+		}
+
+		for (int32 Index = 0; Index < FreeSpans.Num(); ++Index)
+		{
+			FGTPathSpan& FreeSpan = FreeSpans[Index];
+			if (FreeSpan.Count >= Count)
+			{
+				Span.Offset = FreeSpan.Offset;
+				FreeSpan.Offset += Count;
+				FreeSpan.Count -= Count;
+				if (FreeSpan.Count == 0)
+				{
+					FreeSpans.RemoveAtSwap(Index, 1, false);
+				}
+				NumFree -= Count;
+				return Span;
+			}
+		}
+
+		Span.Offset = Elements.AddUninitialized(Count);
+		return Span;
+	}
+
+	void Free(FGTPathSpan& Span)
+	{
+		if (Span.IsSet() && Span.Count > 0)
+		{
+			FreeSpans.Add(Span);
+			NumFree += Span.Count;
+		}
+		Span = FGTPathSpan();
+	}
+
+	bool NeedsCompaction() const { return NumFree > 64 && NumFree * 2 > Elements.Num(); }
+
+	/** Moves all live spans to the front of the pool. LiveSpans must hold every span that has not been freed. */
+	void Compact(TArrayView<FGTPathSpan*> LiveSpans)
+	{
+		LiveSpans.Sort([](const FGTPathSpan& A, const FGTPathSpan& B) { return A.Offset < B.Offset; });
+
+		int32 WriteOffset = 0;
+		for (FGTPathSpan* Span : LiveSpans)
+		{
+			if (Span->Offset != WriteOffset)
+			{
+				FMemory::Memmove(&Elements[WriteOffset], &Elements[Span->Offset], Span->Count * sizeof(ElementType));
+				Span->Offset = WriteOffset;
+			}
+			WriteOffset += Span->Count;
+		}
+
+		Elements.SetNum(WriteOffset, false);
+		FreeSpans.Reset();
+		NumFree = 0;
+	}
+
+	ElementType* GetData(const FGTPathSpan& Span) { return Elements.GetData() + Span.Offset; }
+	const ElementType* GetData(const FGTPathSpan& Span) const { return Elements.GetData() + Span.Offset; }
+
+	TArrayView<ElementType> GetView(const FGTPathSpan& Span) { return Span.IsSet() ? TArrayView<ElementType>(GetData(Span), Span.Count) : TArrayView<ElementType>(); }
+	TConstArrayView<ElementType> GetView(const FGTPathSpan& Span) const { return Span.IsSet() ? TConstArrayView<ElementType>(GetData(Span), Span.Count) : TConstArrayView<ElementType>(); }
+
+	int32 Num() const { return Elements.Num(); }
+	SIZE_T GetAllocatedSize() const { return Elements.GetAllocatedSize() + FreeSpans.GetAllocatedSize(); }
+
+private:
+	TArray<ElementType> Elements;
+	TArray<FGTPathSpan> FreeSpans;
+	int32 NumFree = 0;
+};
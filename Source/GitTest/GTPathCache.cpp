@@ -0,0 +1,251 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GTPathCache.h"
+
+#include "NavigationSystem.h"
+#include "NavMesh/NavMeshPath.h"
+#include "NavMesh/RecastNavMesh.h"
+
+DECLARE_CYCLE_STAT(TEXT("FGTPathCache FindPath"), STAT_FGTPathCache_FindPath, STATGROUP_Game);
+
+namespace GTPathCache
+{
+	/**
+	 * Whether the straight line from Start to End stays on the navmesh. On a recast navmesh the polys it crosses are
+	 * written to OutCorridor, a line crossing more polys than the raycast can report is treated as blocked.
+	 */
+	bool RaycastJoin(const ANavigationData& NavData, const UObject* Querier, const FVector& Start, const FVector& End, FSharedConstNavQueryFilter Filter,
+	                 TArray<NavNodeRef>& OutCorridor)
+	{
+		OutCorridor.Reset();
+		FVector HitLocation;
+#if WITH_RECAST
+		if (NavData.IsA<ARecastNavMesh>())
+		{
+			ARecastNavMesh::FRaycastResult RaycastResult;
+			if (ARecastNavMesh::NavMeshRaycast(&NavData, Start, End, HitLocation, Filter, Querier, RaycastResult)
+				|| RaycastResult.CorridorPolysCount >= ARecastNavMesh::FRaycastResult::MAX_PATH_CORRIDOR_POLYS)
+			{
+				return false;
+			}
+			OutCorridor.Append(RaycastResult.CorridorPolys, RaycastResult.CorridorPolysCount);
+			return true;
+		}
+#endif // WITH_RECAST
+		return !NavData.Raycast(Start, End, HitLocation, Filter, Querier);
+	}
+}
+
+FGTPathCache::~FGTPathCache()
+{
+	Reset();
+}
+
+void FGTPathCache::Reset()
+{
+	for (TPair<FKey, FEntry>& Pair : Entries)
+	{
+		if (Pair.Value.Path.IsValid())
+		{
+			Pair.Value.Path->RemoveObserver(Pair.Value.ObserverHandle);
+		}
+	}
+	Entries.Reset();
+	PathToKey.Reset();
+	InvalidatedKeys.Reset();
+}
+
+void FGTPathCache::OnPathEvent(FNavigationPath* Path, ENavPathEvent::Type Event)
+{
+	if (Event != ENavPathEvent::Invalidated)
+	{
+		return;
+	}
+
+	// The nav data is still iterating its active paths, the entry is removed on the next query.
+	if (const FKey* Key = PathToKey.Find(Path))
+	{
+		if (FEntry* Entry = Entries.Find(*Key))
+		{
+			Entry->bInvalidated = true;
+			InvalidatedKeys.Add(*Key);
+		}
+	}
+}
+
+void FGTPathCache::PurgeInvalidated()
+{
+	for (const FKey& Key : InvalidatedKeys)
+	{
+		RemoveEntry(Key);
+	}
+	InvalidatedKeys.Reset();
+}
+
+void FGTPathCache::RemoveEntry(const FKey& Key)
+{
+	FEntry Entry;
+	if (Entries.RemoveAndCopyValue(Key, Entry) && Entry.Path.IsValid())
+	{
+		Entry.Path->RemoveObserver(Entry.ObserverHandle);
+		PathToKey.Remove(Entry.Path.Get());
+	}
+}
+
+void FGTPathCache::EvictOldest()
+{
+	const FKey* OldestKey = nullptr;
+	double OldestTime = TNumericLimits<double>::Max();
+	for (const TPair<FKey, FEntry>& Pair : Entries)
+	{
+		if (Pair.Value.LastUsedTime < OldestTime)
+		{
+			OldestTime = Pair.Value.LastUsedTime;
+			OldestKey = &Pair.Key;
+		}
+	}
+
+	if (OldestKey)
+	{
+		const FKey Key = *OldestKey;
+		RemoveEntry(Key);
+	}
+}
+
+bool FGTPathCache::JoinCachedPath(const ANavigationData& NavData, UNavigationSystemV1& NavigationSystem, const UObject* Querier, const FEntry& Entry, const FVector& Start,
+                                  const FVector& Goal, FSharedConstNavQueryFilter Filter, const FNavPathSharedPtr& ScratchPath, TArray<FNavPathPoint>& OutPoints,
+                                  TArray<NavNodeRef>& OutCorridor) const
+{
+	const TArray<FNavPathPoint>& CachedPoints = Entry.Path->GetPathPoints();
+	if (CachedPoints.Num() < 2)
+	{
+		return false;
+	}
+
+	OutPoints.Reset();
+	OutCorridor.Reset();
+	OutPoints.Add(FNavPathPoint(Start));
+
+	// Prefer the furthest corner the unit can walk to in a straight line, that skips the cached start entirely.
+	int32 JoinIndex = INDEX_NONE;
+	const int32 LastJoinCorner = FMath::Min(MaxJoinCorners, CachedPoints.Num() - 1);
+	for (int32 Index = LastJoinCorner; Index >= 1; --Index)
+	{
+		// The polys the line crosses lead the corridor, ahead of the cached one from the join corner on.
+		if (FVector::DistSquared2D(Start, CachedPoints[Index].Location) <= FMath::Square(MaxJoinDistance)
+			&& GTPathCache::RaycastJoin(NavData, Querier, Start, CachedPoints[Index].Location, Filter, OutCorridor))
+		{
+			JoinIndex = Index;
+			break;
+		}
+	}
+
+	if (JoinIndex == INDEX_NONE)
+	{
+		OutCorridor.Reset();
+
+		// Short local search to the first cached corner.
+		const FPathFindingQuery Query(Querier, NavData, Start, CachedPoints[1].Location, Filter, ScratchPath, MaxJoinDistance * 2.f);
+		const FPathFindingResult Result = NavigationSystem.FindPathSync(Query);
+		if (!Result.IsSuccessful() || Result.IsPartial())
+		{
+			return false;
+		}
+
+		const TArray<FNavPathPoint>& PrefixPoints = Result.Path->GetPathPoints();
+		for (int32 Index = 1; Index < PrefixPoints.Num() - 1; ++Index)
+		{
+			OutPoints.Add(PrefixPoints[Index]);
+		}
+		if (const FNavMeshPath* PrefixPath = Result.Path->CastPath<FNavMeshPath>())
+		{
+			OutCorridor.Append(PrefixPath->PathCorridor);
+		}
+		JoinIndex = 1;
+	}
+
+	for (int32 Index = JoinIndex; Index < CachedPoints.Num(); ++Index)
+	{
+		OutPoints.Add(CachedPoints[Index]);
+	}
+	// Same goal poly, so the straight line from the cached end to this unit's goal stays on the navmesh.
+	OutPoints.Last().Location = Goal;
+
+	if (const FNavMeshPath* CachedPath = Entry.Path->CastPath<FNavMeshPath>())
+	{
+		const int32 CorridorStart = FMath::Max(0, CachedPath->PathCorridor.Find(CachedPoints[JoinIndex].NodeRef));
+		const int32 FirstCorridorPoly = OutCorridor.Num() > 0 && OutCorridor.Last() == CachedPath->PathCorridor[CorridorStart] ? CorridorStart + 1 : CorridorStart;
+		OutCorridor.Append(CachedPath->PathCorridor.GetData() + FirstCorridorPoly, CachedPath->PathCorridor.Num() - FirstCorridorPoly);
+	}
+	return true;
+}
+
+bool FGTPathCache::FindPath(UNavigationSystemV1& NavigationSystem, ANavigationData& NavData, const UObject* Querier, const FVector& Start, const FVector& Goal,
+                            uint32 AgentProfile, const FNavPathSharedPtr& ScratchPath, TArray<FNavPathPoint>& OutPoints, TArray<NavNodeRef>& OutCorridor,
+                            FSharedConstNavQueryFilter Filter)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FGTPathCache_FindPath);
+	PurgeInvalidated();
+
+	FNavLocation GoalLocation;
+	if (!NavData.ProjectPoint(Goal, GoalLocation, NavData.GetConfig().DefaultQueryExtent, nullptr, Querier))
+	{
+		return false;
+	}
+
+	const FKey Key{FIntPoint(FMath::FloorToInt(Start.X / StartCellSize), FMath::FloorToInt(Start.Y / StartCellSize)), GoalLocation.NodeRef, AgentProfile};
+	const double StartTime = FPlatformTime::Seconds();
+
+	if (FEntry* Entry = Entries.Find(Key))
+	{
+		if (!Entry->bInvalidated && JoinCachedPath(NavData, NavigationSystem, Querier, *Entry, Start, GoalLocation.Location, Filter, ScratchPath, OutPoints, OutCorridor))
+		{
+			const double HitMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+			Entry->LastUsedTime = StartTime;
+			++Stats.Hits;
+			Stats.SavedMs += FMath::Max(0.0, Stats.AverageMissMs - HitMs);
+			return true;
+		}
+	}
+
+	// The cached path is kept, so it gets its own instance instead of the scratch path.
+	FNavPathSharedPtr NewPath = MakeShared<FNavMeshPath, ESPMode::ThreadSafe>();
+	const FPathFindingQuery Query(Querier, NavData, Start, GoalLocation.Location, Filter, NewPath);
+	const FPathFindingResult Result = NavigationSystem.FindPathSync(Query);
+
+	const double MissMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	++Stats.Misses;
+	Stats.AverageMissMs = Stats.Misses == 1 ? MissMs : FMath::Lerp(Stats.AverageMissMs, MissMs, 0.1);
+
+	if (!Result.IsSuccessful() || !Result.Path.IsValid())
+	{
+		return false;
+	}
+
+	OutPoints = Result.Path->GetPathPoints();
+	OutCorridor.Reset();
+	if (const FNavMeshPath* NavMeshPath = Result.Path->CastPath<FNavMeshPath>())
+	{
+		OutCorridor.Append(NavMeshPath->PathCorridor);
+	}
+
+	if (!Result.IsPartial())
+	{
+		RemoveEntry(Key);
+		if (Entries.Num() >= MaxEntries)
+		{
+			EvictOldest();
+		}
+
+		FEntry& Entry = Entries.Add(Key);
+		Entry.Path = Result.Path;
+		Entry.LastUsedTime = StartTime;
+		Entry.ObserverHandle = Result.Path->AddObserver(FNavigationPath::FPathObserverDelegate::FDelegate::CreateRaw(this, &FGTPathCache::OnPathEvent));
+		PathToKey.Add(Result.Path.Get(), Key);
+		// Only invalidation is wanted, the entry is dropped rather than repathed by the navigation data on every rebuild.
+		Result.Path->EnableRecalculationOnInvalidation(false);
+		NavData.RegisterActivePath(Result.Path);
+	}
+	return true;
+}
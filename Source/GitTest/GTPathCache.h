@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "NavigationData.h"
+
+class UNavigationSystemV1;
+
+/**
+ * Corridors shared between units going from the same area to the same goal poly.
+ * Keyed by (start cell, goal poly, agent profile). A unit near a cached start joins the cached corridor through a
+ * short local prefix instead of running a full search. Entries are dropped when the navmesh invalidates their path,
+ * which happens when one of the tiles they cross is rebuilt.
+ */
+class GITTEST_API FGTPathCache
+{
+public:
+	struct FStats
+	{
+		int32 Hits = 0;
+		int32 Misses = 0;
+		/** Running average cost of a full search, used to estimate what a hit saved. */
+		double AverageMissMs = 0.0;
+		double SavedMs = 0.0;
+
+		float GetHitRate() const { return Hits + Misses > 0 ? static_cast<float>(Hits) / (Hits + Misses) : 0.f; }
+	};
+
+	~FGTPathCache();
+
+	/**
+	 * Builds the path from Start to Goal into OutPoints and OutCorridor. ScratchPath is used for local searches
+	 * and is never kept by the cache. Filter applies to the searches run on a miss and to join prefixes, a hit reuses
+	 * the corridor as it was found.
+	 */
+	bool FindPath(UNavigationSystemV1& NavigationSystem, ANavigationData& NavData, const UObject* Querier, const FVector& Start, const FVector& Goal,
+	              uint32 AgentProfile, const FNavPathSharedPtr& ScratchPath, TArray<FNavPathPoint>& OutPoints, TArray<NavNodeRef>& OutCorridor,
+	              FSharedConstNavQueryFilter Filter = nullptr);
+
+	/** Drops entries whose path was invalidated by a navmesh update. */
+	void PurgeInvalidated();
+	void Reset();
+
+	const FStats& GetStats() const { return Stats; }
+	int32 Num() const { return Entries.Num(); }
+
+	/** Size of the grid cell starts are bucketed into. */
+	float StartCellSize = 400.f;
+	int32 MaxEntries = 256;
+	/** Cached corners a unit may join the corridor at. */
+	int32 MaxJoinCorners = 3;
+	float MaxJoinDistance = 800.f;
+
+private:
+	struct FKey
+	{
+		FIntPoint StartCell;
+		NavNodeRef GoalPoly;
+		uint32 AgentProfile;
+
+		bool operator==(const FKey& Other) const
+		{
+			return StartCell == Other.StartCell && GoalPoly == Other.GoalPoly && AgentProfile == Other.AgentProfile;
+		}
+
+		friend uint32 GetTypeHash(const FKey& Key)
+		{
+			return HashCombine(HashCombine(GetTypeHash(Key.StartCell), GetTypeHash(Key.GoalPoly)), Key.AgentProfile);
+		}
+	};
+
+	struct FEntry
+	{
+		/** Kept alive and registered with the nav data so it receives the invalidation event. */
+		FNavPathSharedPtr Path;
+		FDelegateHandle ObserverHandle;
+		double LastUsedTime = 0.0;
+		bool bInvalidated = false;
+	};
+
+	void OnPathEvent(FNavigationPath* Path, ENavPathEvent::Type Event);
+	void RemoveEntry(const FKey& Key);
+	void EvictOldest();
+	bool JoinCachedPath(const ANavigationData& NavData, UNavigationSystemV1& NavigationSystem, const UObject* Querier, const FEntry& Entry, const FVector& Start,
+	                    const FVector& Goal, FSharedConstNavQueryFilter Filter, const FNavPathSharedPtr& ScratchPath, TArray<FNavPathPoint>& OutPoints,
+	                    TArray<NavNodeRef>& OutCorridor) const;
+
+	TMap<FKey, FEntry> Entries;
+	TMap<const FNavigationPath*, FKey> PathToKey;
+	TArray<FKey> InvalidatedKeys;
+	FStats Stats;
+};
@@ -3,6 +3,15 @@
 
 #include "GTPawnMovementComponent.h"
 
+#include "GTFrameArena.h"
+#include "GTPawnMovementManager.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("UGTPawnMovementComponent UpdateMovementBatch"), STAT_UGTPawnMovementComponent_UpdateMovementBatch, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("UGTPawnMovementComponent Async Probes Queued"), STAT_UGTPawnMovementComponent_ProbesQueued, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("UGTPawnMovementComponent Async Probes Missed"), STAT_UGTPawnMovementComponent_ProbesMissed, STATGROUP_Game);
+
 
 UGTPawnMovementComponent::UGTPawnMovementComponent()
 {
@@ -13,6 +22,34 @@ UGTPawnMovementComponent::UGTPawnMovementComponent()
 	ZVelocityAcceleration = 75;
 }
 
+void UGTPawnMovementComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	CollisionObjectParams = FCollisionObjectQueryParams(TypeObjectsToDetectCollision);
+	ProbeQueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(GTPawnMovementProbe), false, GetOwner());
+
+	if (AGTPawnMovementManager* MovementManager = AGTPawnMovementManager::Get(GetWorld()))
+	{
+		PawnMovementManager = MovementManager;
+		MovementManager->RegisterPawnMovementComponent(this);
+	}
+	else
+	{
+		UE_LOG(LogTemp, Error, TEXT("The movement manager has not been found") );
+	}
+}
+
+void UGTPawnMovementComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	if (IsValid(PawnMovementManager))
+	{
+		PawnMovementManager->UnregisterPawnMovementComponent(this);
+	}
+}
+
 void UGTPawnMovementComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
 {
 	if (ShouldSkipUpdate(DeltaTime))
@@ -93,53 +130,180 @@ void UGTPawnMovementComponent::ApplyControlInputToVelocity(float DeltaTime)
 
 void UGTPawnMovementComponent::UpdateMovement(float DeltaTime)
 {
-	const AController* Controller = PawnOwner->GetController();
-	if (Controller && Controller->IsLocalController())
+	UWorld* World = GetWorld();
+	ConsumeAsyncProbes(*World, DeltaTime);
+	if (CalcVelocity(DeltaTime))
 	{
-		// apply input for local players but also for AI that's not following a navigation path at the moment
-		if (Controller->IsLocalPlayerController() == true || Controller->IsFollowingAPath() == false || bUseAccelerationForPaths)
-		{
-			ApplyControlInputToVelocity(DeltaTime);
-		}
-		// if it's not player controller, but we do have a controller, then it's AI
-		// (that's not following a path) and we need to limit the speed
-		else if (IsExceedingMaxSpeed(MaxSpeed) == true)
+		MoveByVelocity(DeltaTime);
+		QueueAsyncProbes(*World, DeltaTime);
+	}
+}
+
+void UGTPawnMovementComponent::UpdateMovementBatch(TConstArrayView<UGTPawnMovementComponent*> Components, float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_UGTPawnMovementComponent_UpdateMovementBatch);
+	if (Components.Num() == 0)
+	{
+		return;
+	}
+
+	UWorld* World = Components[0]->GetWorld();
+	for (UGTPawnMovementComponent* Component : Components)
+	{
+		Component->ConsumeAsyncProbes(*World, DeltaTime);
+	}
+
+	FGTFrameArenaScope ArenaScope;
+	TGTFrameArray<bool> ShouldMove;
+	ShouldMove.SetNumUninitialized(Components.Num());
+	ParallelFor(Components.Num(), [&](int32 Index)
+	{
+		ShouldMove[Index] = Components[Index]->CalcVelocity(DeltaTime);
+	});
+
+	for (int32 Index = 0; Index < Components.Num(); ++Index)
+	{
+		if (ShouldMove[Index])
 		{
-			Velocity = Velocity.GetUnsafeNormal() * MaxSpeed;
+			Components[Index]->MoveByVelocity(DeltaTime);
+			Components[Index]->QueueAsyncProbes(*World, DeltaTime);
 		}
+	}
+}
+
+bool UGTPawnMovementComponent::CalcVelocity(float DeltaTime)
+{
+	if (!PawnOwner || !UpdatedComponent || ShouldSkipUpdate(DeltaTime))
+	{
+		return false;
+	}
+
+	const AController* Controller = PawnOwner->GetController();
+	if (!Controller || !Controller->IsLocalController())
+	{
+		return false;
+	}
+
+	// apply input for local players but also for AI that's not following a navigation path at the moment
+	if (Controller->IsLocalPlayerController() == true || Controller->IsFollowingAPath() == false || bUseAccelerationForPaths)
+	{
+		ApplyControlInputToVelocity(DeltaTime);
+	}
+	// if it's not player controller, but we do have a controller, then it's AI
+	// (that's not following a path) and we need to limit the speed
+	else if (IsExceedingMaxSpeed(MaxSpeed) == true)
+	{
+		Velocity = Velocity.GetUnsafeNormal() * MaxSpeed;
+	}
+
+	// Slide along whatever the last sweep ran into instead of walking into it.
+	const float IntoObstacle = Velocity | BlockingNormal;
+	if (IntoObstacle < 0.f)
+	{
+		Velocity -= BlockingNormal * IntoObstacle;
+	}
 
-		LimitWorldBounds();
-		bPositionCorrected = false;
+	LimitWorldBounds();
+	bPositionCorrected = false;
+	return true;
+}
+
+void UGTPawnMovementComponent::MoveByVelocity(float DeltaTime)
+{
+	FVector Delta = FVector(Velocity.X, Velocity.Y, Velocity.Z) * DeltaTime;
+	const FVector OldLocation = UpdatedComponent->GetComponentLocation();
 
-		
-		FVector Delta = FVector(Velocity.X, Velocity.Y, Velocity.Z) * DeltaTime;
+	// Ground following from last frame's probe, the height eases towards it instead of snapping.
+	if (bHasFloor)
+	{
+		const float TargetZ = FloorZ + GetProbeHalfHeight();
+		Delta.Z = FMath::FInterpTo(OldLocation.Z, TargetZ, DeltaTime, ZVelocityAcceleration) - OldLocation.Z;
+	}
 
-		if (!Delta.IsNearlyZero(1e-6f))
+	if (!Delta.IsNearlyZero(1e-6f))
+	{
+		// Collision comes from the async sweep, so the move itself does not sweep.
+		MoveUpdatedComponent(Delta, UpdatedComponent->GetComponentQuat(), false);
+
+		// Update velocity
+		// We don't want position changes to vastly reverse our direction (which can happen due to penetration fixups etc)
+		if (!bPositionCorrected)
 		{
-			const FVector OldLocation = UpdatedComponent->GetComponentLocation();
-			const FQuat Rotation = UpdatedComponent->GetComponentQuat();
+			const FVector NewLocation = UpdatedComponent->GetComponentLocation();
+			Velocity = ((NewLocation - OldLocation) / DeltaTime);
+			if (bHasFloor)
+			{
+				Velocity.Z = 0.f;
+			}
+		}
+	}
 
-			FHitResult Hit(1.f);
-			SafeMoveUpdatedComponent(Delta, Rotation, false, Hit);
+	// Finalize
+	UpdateComponentVelocity();
+}
 
-			if (Hit.IsValidBlockingHit())
+void UGTPawnMovementComponent::ConsumeAsyncProbes(UWorld& World, float DeltaTime)
+{
+	FTraceDatum TraceData;
+	if (FloorTraceHandle.IsValid())
+	{
+		if (World.QueryTraceData(FloorTraceHandle, TraceData))
+		{
+			const FHitResult* FloorHit = FHitResult::GetFirstBlockingHit(TraceData.OutHits);
+			bHasFloor = FloorHit != nullptr;
+			FloorZ = FloorHit ? FloorHit->ImpactPoint.Z : FloorZ;
+		}
+		else
+		{
+			// Not done in time, the last known floor is still the best guess.
+			INC_DWORD_STAT(STAT_UGTPawnMovementComponent_ProbesMissed);
+		}
+		FloorTraceHandle = FTraceHandle();
+	}
+
+	BlockingNormal = FVector::ZeroVector;
+	if (SweepTraceHandle.IsValid())
+	{
+		if (World.QueryTraceData(SweepTraceHandle, TraceData))
+		{
+			if (const FHitResult* SweepHit = FHitResult::GetFirstBlockingHit(TraceData.OutHits))
 			{
-				HandleImpact(Hit, DeltaTime, Delta);
-				// Try to slide the remaining distance along the surface.
-				SlideAlongSurface(Delta, 1.f-Hit.Time, Hit.Normal, Hit, true);
+				BlockingNormal = SweepHit->ImpactNormal.GetSafeNormal2D();
+				ReachablePoint = SweepHit->Location;
+				HandleImpact(*SweepHit, DeltaTime, TraceData.End - TraceData.Start);
 			}
-	
-			// Update velocity
-			// We don't want position changes to vastly reverse our direction (which can happen due to penetration fixups etc)
-			if (!bPositionCorrected)
+			else
 			{
-				const FVector NewLocation = UpdatedComponent->GetComponentLocation();
-				Velocity = ((NewLocation - OldLocation) / DeltaTime);
+				ReachablePoint = TraceData.End;
 			}
 		}
-		
-		// Finalize
-		UpdateComponentVelocity();
+		else
+		{
+			INC_DWORD_STAT(STAT_UGTPawnMovementComponent_ProbesMissed);
+		}
+		SweepTraceHandle = FTraceHandle();
+	}
+}
+
+float UGTPawnMovementComponent::GetProbeHalfHeight() const
+{
+	return UpdatedPrimitive ? UpdatedPrimitive->GetCollisionShape().GetExtent().Z : 0.f;
+}
+
+void UGTPawnMovementComponent::QueueAsyncProbes(UWorld& World, float DeltaTime)
+{
+	const FVector Location = UpdatedComponent->GetComponentLocation();
+	FloorTraceHandle = World.AsyncLineTraceByObjectType(EAsyncTraceType::Single, Location, Location - FVector(0.f, 0.f, GetProbeHalfHeight() + FloorDetection),
+	                                                    FCollisionObjectQueryParams(FCollisionObjectQueryParams::AllStaticObjects), ProbeQueryParams);
+	INC_DWORD_STAT(STAT_UGTPawnMovementComponent_ProbesQueued);
+
+	// Sweeps ahead by one frame of movement, the next update slides along anything in the way.
+	const FVector Ahead = FVector(Velocity.X, Velocity.Y, 0.f) * DeltaTime;
+	if (CollisionObjectParams.IsValid() && UpdatedPrimitive && !Ahead.IsNearlyZero())
+	{
+		SweepTraceHandle = World.AsyncSweepByObjectType(EAsyncTraceType::Single, Location, Location + Ahead, UpdatedComponent->GetComponentQuat(),
+		                                                CollisionObjectParams, UpdatedPrimitive->GetCollisionShape(), ProbeQueryParams);
+		INC_DWORD_STAT(STAT_UGTPawnMovementComponent_ProbesQueued);
 	}
 }
 
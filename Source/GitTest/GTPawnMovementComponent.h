@@ -3,9 +3,13 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
+#include "WorldCollision.h"
 #include "GameFramework/PawnMovementComponent.h"
 #include "GTPawnMovementComponent.generated.h"
 
+class AGTPawnMovementManager;
+
 UCLASS()
 class GITTEST_API UGTPawnMovementComponent : public UPawnMovementComponent
 {
@@ -25,14 +29,26 @@ protected:
 public:
 	//End UMovementComponent Interface
 	void UpdateMovement(float DeltaTime);
+
+	/**
+	 * Updates every component of the movement manager's pawn bucket. Velocities only touch each component and its own
+	 * pawn, so they are computed in parallel; the moves go through the scene and are applied on the calling thread.
+	 * Floor probes and move sweeps are queued as async traces after the moves and read back by the next update, so the
+	 * physics queries run off the game thread and units react to the ground and obstacles one frame late.
+	 */
+	static void UpdateMovementBatch(TConstArrayView<UGTPawnMovementComponent*> Components, float DeltaTime);
 	float Time;
+	/** Length of the floor probe below the bottom of the collision shape. */
 	UPROPERTY(EditDefaultsOnly)
 	float FloorDetection = 80;
+	/** End of the last move sweep, or where it was blocked. */
 	UPROPERTY(BlueprintReadWrite)
 	FVector ReachablePoint;
+	/** Object types the move sweep is blocked by, no sweep is queued when empty. */
 	UPROPERTY(EditDefaultsOnly)
 	TArray<TEnumAsByte<EObjectTypeQuery>> TypeObjectsToDetectCollision;
 	
+	/** Interpolation speed of the height towards the probed floor. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=FloatingPawnMovement)
 	float ZVelocityAcceleration = 1;
 	
@@ -67,4 +83,38 @@ protected:
 	/** Set to true when a position correction is applied. Used to avoid recalculating velocity when this occurs. */
 	UPROPERTY(Transient)
 	uint32 bPositionCorrected:1;
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Velocity for this frame, false if the component should not move. Safe to run for several components at once. */
+	bool CalcVelocity(float DeltaTime);
+	void MoveByVelocity(float DeltaTime);
+
+	/** Reads the async probes queued by the previous update, if they are done. */
+	void ConsumeAsyncProbes(UWorld& World, float DeltaTime);
+	void QueueAsyncProbes(UWorld& World, float DeltaTime);
+	/** Distance from the component's origin to the bottom of its collision shape. */
+	float GetProbeHalfHeight() const;
+
+private:
+	friend class AGTPawnMovementManager;
+
+	UPROPERTY()
+	AGTPawnMovementManager* PawnMovementManager;
+
+	/** Index in the movement manager's pawn bucket, INDEX_NONE while unregistered. */
+	int32 BucketIndex = INDEX_NONE;
+
+	FTraceHandle FloorTraceHandle;
+	FTraceHandle SweepTraceHandle;
+	FCollisionObjectQueryParams CollisionObjectParams;
+	FCollisionQueryParams ProbeQueryParams;
+
+	/** Height of the floor under the unit from the last probe that hit. */
+	float FloorZ = 0.f;
+	bool bHasFloor = false;
+
+	/** Normal of the obstacle the last move sweep was blocked by, zero when it was not. */
+	FVector BlockingNormal = FVector::ZeroVector;
 };
@@ -3,26 +3,2556 @@
 
 #include "GTPawnMovementManager.h"
 #include "GTCharacterMovementComponent.h"
+#include "GTFrameArena.h"
+#include "GTPawnMovementComponent.h"
+#include "GTSquad.h"
+#include "GTUnitMovementSim.h"
+#include "EngineUtils.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/PlayerController.h"
+#include "GenericTeamAgentInterface.h"
+#include "NavigationData.h"
+#include "Animation/AnimSequenceBase.h"
+#include "Algo/Sort.h"
+#include "Async/ParallelFor.h"
+#include "Engine/GameInstance.h"
+#include "Engine/StaticMesh.h"
+#include "NavigationSystem.h"
+#include "NavMesh/NavMeshPath.h"
+#include "NavMesh/RecastNavMesh.h"
+#include "PBDRigidsSolver.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+
+DECLARE_CYCLE_STAT(TEXT("AGTPawnMovementManager AdvancePathFollowing"), STAT_AGTPawnMovementManager_AdvancePathFollowing, STATGROUP_Game);
+DECLARE_CYCLE_STAT(TEXT("AGTPawnMovementManager RequestMove"), STAT_AGTPawnMovementManager_RequestMove, STATGROUP_Game);
+DECLARE_CYCLE_STAT(TEXT("AGTPawnMovementManager SortUnitsSpatially"), STAT_AGTPawnMovementManager_SortUnitsSpatially, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AGTPawnMovementManager Units Moved By Sort"), STAT_AGTPawnMovementManager_UnitsMovedBySort, STATGROUP_Game);
+DECLARE_CYCLE_STAT(TEXT("AGTPawnMovementManager ApplyCommands"), STAT_AGTPawnMovementManager_ApplyCommands, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AGTPawnMovementManager Commands Applied"), STAT_AGTPawnMovementManager_CommandsApplied, STATGROUP_Game);
+DECLARE_CYCLE_STAT(TEXT("AGTPawnMovementManager UpdateCharacterMovement"), STAT_AGTPawnMovementManager_UpdateCharacterMovement, STATGROUP_Game);
+DECLARE_CYCLE_STAT(TEXT("AGTPawnMovementManager UpdatePawnMovement"), STAT_AGTPawnMovementManager_UpdatePawnMovement, STATGROUP_Game);
+DECLARE_CYCLE_STAT(TEXT("AGTPawnMovementManager SolveVelocities"), STAT_AGTPawnMovementManager_SolveVelocities, STATGROUP_Game);
+DECLARE_CYCLE_STAT(TEXT("AGTPawnMovementManager NavQueries"), STAT_AGTPawnMovementManager_NavQueries, STATGROUP_Game);
+DECLARE_CYCLE_STAT(TEXT("AGTPawnMovementManager PushSimInputs"), STAT_AGTPawnMovementManager_PushSimInputs, STATGROUP_Game);
+DECLARE_CYCLE_STAT(TEXT("AGTPawnMovementManager ApplySimOutputs"), STAT_AGTPawnMovementManager_ApplySimOutputs, STATGROUP_Game);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AGTPawnMovementManager Physics Thread Units"), STAT_AGTPawnMovementManager_PhysicsThreadUnits, STATGROUP_Game);
+DECLARE_MEMORY_STAT(TEXT("AGTPawnMovementManager Nav Heightfield"), STAT_AGTPawnMovementManager_NavHeightfield, STATGROUP_Game);
+DECLARE_MEMORY_STAT(TEXT("AGTPawnMovementManager Crowd Density"), STAT_AGTPawnMovementManager_CrowdDensity, STATGROUP_Game);
+DECLARE_CYCLE_STAT(TEXT("AGTPawnMovementManager UpdateFogOfWar"), STAT_AGTPawnMovementManager_UpdateFogOfWar, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AGTPawnMovementManager Fog Of War Restamped Units"), STAT_AGTPawnMovementManager_FogRestampedUnits, STATGROUP_Game);
+DECLARE_MEMORY_STAT(TEXT("AGTPawnMovementManager Fog Of War"), STAT_AGTPawnMovementManager_FogOfWar, STATGROUP_Game);
+DECLARE_CYCLE_STAT(TEXT("AGTPawnMovementManager UpdateTargets"), STAT_AGTPawnMovementManager_UpdateTargets, STATGROUP_Game);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AGTPawnMovementManager Target Searches"), STAT_AGTPawnMovementManager_TargetSearches, STATGROUP_Game);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AGTPawnMovementManager Units With Target"), STAT_AGTPawnMovementManager_UnitsWithTarget, STATGROUP_Game);
+DECLARE_CYCLE_STAT(TEXT("AGTPawnMovementManager UpdateSignificance"), STAT_AGTPawnMovementManager_UpdateSignificance, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AGTPawnMovementManager Rescored Units"), STAT_AGTPawnMovementManager_RescoredUnits, STATGROUP_Game);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AGTPawnMovementManager Significance Overflowed Units"), STAT_AGTPawnMovementManager_OverflowedUnits, STATGROUP_Game);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AGTPawnMovementManager Hot Nav Walking Units Skipped"), STAT_AGTPawnMovementManager_SkippedUnits, STATGROUP_Game);
+DECLARE_CYCLE_STAT(TEXT("AGTPawnMovementManager UpdateCrowdAnimation"), STAT_AGTPawnMovementManager_UpdateCrowdAnimation, STATGROUP_Game);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AGTPawnMovementManager Own Animation Units"), STAT_AGTPawnMovementManager_OwnAnimationUnits, STATGROUP_Game);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AGTPawnMovementManager Shared Animation Units"), STAT_AGTPawnMovementManager_SharedAnimationUnits, STATGROUP_Game);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AGTPawnMovementManager Shared Animation Leaders"), STAT_AGTPawnMovementManager_AnimationLeaders, STATGROUP_Game);
+DECLARE_CYCLE_STAT(TEXT("AGTPawnMovementManager UpdateUnitProxies"), STAT_AGTPawnMovementManager_UpdateUnitProxies, STATGROUP_Game);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AGTPawnMovementManager Proxy Units"), STAT_AGTPawnMovementManager_ProxyUnits, STATGROUP_Game);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AGTPawnMovementManager Registered Unit Meshes"), STAT_AGTPawnMovementManager_RegisteredUnitMeshes, STATGROUP_Game);
+DECLARE_CYCLE_STAT(TEXT("AGTPawnMovementManager UpdateEntityHydration"), STAT_AGTPawnMovementManager_UpdateEntityHydration, STATGROUP_Game);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AGTPawnMovementManager Entity Units"), STAT_AGTPawnMovementManager_EntityUnits, STATGROUP_Game);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AGTPawnMovementManager Hydrated Entity Units"), STAT_AGTPawnMovementManager_HydratedEntityUnits, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AGTPawnMovementManager Entity Hydrations"), STAT_AGTPawnMovementManager_EntityHydrations, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AGTPawnMovementManager Entity Dehydrations"), STAT_AGTPawnMovementManager_EntityDehydrations, STATGROUP_Game);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("AGTPawnMovementManager Game Thread Ms"), STAT_AGTPawnMovementManager_GameThreadMs, STATGROUP_Game);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("AGTPawnMovementManager Total CPU Ms"), STAT_AGTPawnMovementManager_TotalCpuMs, STATGROUP_Game);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("AGTPawnMovementManager Character Movement Us Per Unit"), STAT_AGTPawnMovementManager_CharacterUsPerUnit, STATGROUP_Game);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("AGTPawnMovementManager Pawn Movement Us Per Unit"), STAT_AGTPawnMovementManager_PawnUsPerUnit, STATGROUP_Game);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AGTPawnMovementManager Hot Nav Walking Units"), STAT_AGTPawnMovementManager_HotNavWalkingUnits, STATGROUP_Game);
+DECLARE_MEMORY_STAT(TEXT("AGTPawnMovementManager Movement States"), STAT_AGTPawnMovementManager_MovementStates, STATGROUP_Game);
+DECLARE_MEMORY_STAT(TEXT("FGTFrameArena Game Thread Peak"), STAT_FGTFrameArena_GameThreadPeak, STATGROUP_Game);
+DECLARE_MEMORY_STAT(TEXT("FGTFrameArena Reserved"), STAT_FGTFrameArena_Reserved, STATGROUP_Game);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FGTFrameArena Chunk Allocations"), STAT_FGTFrameArena_ChunkAllocations, STATGROUP_Game);
+DECLARE_MEMORY_STAT(TEXT("AGTPawnMovementManager Path Buffers"), STAT_AGTPawnMovementManager_PathBuffers, STATGROUP_Game);
+DECLARE_CYCLE_STAT(TEXT("AGTPawnMovementManager ProcessPathRepairs"), STAT_AGTPawnMovementManager_ProcessPathRepairs, STATGROUP_Game);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AGTPawnMovementManager Pending Path Repairs"), STAT_AGTPawnMovementManager_PendingRepairs, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AGTPawnMovementManager Local Path Repairs"), STAT_AGTPawnMovementManager_LocalRepairs, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AGTPawnMovementManager Full Repaths"), STAT_AGTPawnMovementManager_FullRepaths, STATGROUP_Game);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FGTGroundQuery Repeated Rays"), STAT_FGTGroundQuery_RepeatedRays, STATGROUP_Game);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FGTGroundQuery Heightfield Hits"), STAT_FGTGroundQuery_HeightfieldHits, STATGROUP_Game);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FGTGroundQuery Dynamic Hits"), STAT_FGTGroundQuery_DynamicHits, STATGROUP_Game);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FGTGroundQuery Sampled Cells"), STAT_FGTGroundQuery_SampledCells, STATGROUP_Game);
+DECLARE_MEMORY_STAT(TEXT("FGTGroundQuery Heightfield"), STAT_FGTGroundQuery_Heightfield, STATGROUP_Game);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FGTPathCache Hits"), STAT_FGTPathCache_Hits, STATGROUP_Game);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FGTPathCache Misses"), STAT_FGTPathCache_Misses, STATGROUP_Game);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FGTPathCache Entries"), STAT_FGTPathCache_Entries, STATGROUP_Game);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("FGTPathCache Hit Rate"), STAT_FGTPathCache_HitRate, STATGROUP_Game);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("FGTPathCache Pathfinding Ms Saved"), STAT_FGTPathCache_SavedMs, STATGROUP_Game);
+
+namespace GTPawnMovementManager
+{
+	/** Staged units per task of the task-thread stages. */
+	constexpr int32 StageBatchSize = 256;
+
+	/** Longest a unit moves over at once, so one whose bucket skipped many frames does not leap. */
+	constexpr float MaxPendingDeltaTime = 0.25f;
+
+	/** ParallelFor in batches of StageBatchSize, adding the time every batch took to Cycles. */
+	template<typename BodyType>
+	void TimedParallelFor(int32 Num, std::atomic<uint64>& Cycles, const BodyType& Body)
+	{
+		ParallelFor(FMath::DivideAndRoundUp(Num, StageBatchSize), [Num, &Cycles, &Body](int32 Batch)
+		{
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			const int32 End = FMath::Min(Num, (Batch + 1) * StageBatchSize);
+			for (int32 Index = Batch * StageBatchSize; Index < End; ++Index)
+			{
+				Body(Index);
+			}
+			Cycles += FPlatformTime::Cycles64() - StartCycles;
+		});
+	}
+}
 
 AGTPawnMovementManager::AGTPawnMovementManager()
 {
-	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	// Transforms are committed before physics, grid and stats only need to be ready for the next frame.
+	for (int32 Phase = 0; Phase < static_cast<int32>(EGTMovementPhase::Num); ++Phase)
+	{
+		FGTMovementPhaseTickFunction& TickFunction = PhaseTickFunctions[Phase];
+		TickFunction.Phase = static_cast<EGTMovementPhase>(Phase);
+		TickFunction.bCanEverTick = true;
+		TickFunction.bStartWithTickEnabled = true;
+		TickFunction.TickGroup = TickFunction.Phase == EGTMovementPhase::PostMove ? TG_DuringPhysics : TG_PrePhysics;
+		TickFunction.bRunOnAnyThread = TickFunction.Phase == EGTMovementPhase::SolveVelocities || TickFunction.Phase == EGTMovementPhase::Separation
+			|| TickFunction.Phase == EGTMovementPhase::NavQueries;
+	}
+
+	// Selected units near the camera get everything, crowds on screen the cheap versions, and units off screen move in
+	// fewer, longer steps.
+	FGTSignificanceBudget& High = SignificanceBudgets.AddDefaulted_GetRef();
+	High.MinSignificance = 1.f;
+	High.MaxUnits = 128;
+	High.Avoidance = EGTAvoidanceQuality::RVO;
+	High.bNeedsActor = true;
+
+	FGTSignificanceBudget& Medium = SignificanceBudgets.AddDefaulted_GetRef();
+	Medium.MinSignificance = 0.3f;
+	Medium.MaxUnits = 1000;
+	Medium.AnimationUpdateRate = 2;
+	Medium.bNeedsActor = true;
+	Medium.TargetingInterval = 2;
+
+	FGTSignificanceBudget& Low = SignificanceBudgets.AddDefaulted_GetRef();
+	Low.MinSignificance = 0.05f;
+	Low.MovementUpdateInterval = 2;
+	Low.NavProjection = EGTNavProjection::Heightfield;
+	Low.AnimationUpdateRate = 4;
+	Low.bShareAnimation = true;
+	Low.TargetingInterval = 4;
+
+	FGTSignificanceBudget& Culled = SignificanceBudgets.AddDefaulted_GetRef();
+	Culled.MovementUpdateInterval = 4;
+	Culled.Avoidance = EGTAvoidanceQuality::None;
+	Culled.NavProjection = EGTNavProjection::Heightfield;
+	Culled.AnimationUpdateRate = 8;
+	Culled.bShareAnimation = true;
+	Culled.bDrawAsProxy = true;
+	Culled.TargetingInterval = 8;
+}
+
+AGTPawnMovementManager* AGTPawnMovementManager::Get(const UWorld* World)
+{
+	if (World == nullptr)
+	{
+		return nullptr;
+	}
+
+	// The class hash only ever holds the single manager, so this is a lookup rather than an actor sweep.
+	for (TActorIterator<AGTPawnMovementManager> It(World); It; ++It)
+	{
+		return *It;
+	}
+	return nullptr;
+}
+
+void AGTPawnMovementManager::RegisterMovementComponent(UGTCharacterMovementComponent* MovementComponent)
+{
+	if (MovementComponent->UnitId != INDEX_NONE)
+	{
+		return;
+	}
+
+	if (HydratingActor != nullptr && MovementComponent->GetOwner() == HydratingActor)
+	{
+		// The actor HydrateUnit spawns takes over its unit's row, which was never removed. Its mesh draws the unit until
+		// UpdateUnitProxies finds it should be a proxy again.
+		const int32 Slot = GetUnitSlot(HydratingUnitId);
+		const ACharacter* CharacterOwner = MovementComponent->GetCharacterOwner();
+		MovementComponents[Slot] = MovementComponent;
+		UnitAnimations[Slot].Mesh = CharacterOwner ? CharacterOwner->GetMesh() : nullptr;
+		UnitProxies[Slot].Mesh = UnitAnimations[Slot].Mesh;
+		UnitProxies[Slot].Type = INDEX_NONE;
+		MovementStates[Slot].Flags |= FGTUnitMovementHot::Dirty;
+		MovementComponent->UnitId = HydratingUnitId;
+		return;
+	}
+
+	const int32 UnitId = AllocateUnitId();
+	const int32 Slot = MovementComponents.Add(MovementComponent);
+	UnitIds.Add(UnitId);
+	PathStates.AddDefaulted();
+	OrderStates.AddDefaulted();
+	MovementStates.AddDefaulted();
+	UnitBodies.AddDefaulted();
+	Significances.AddDefaulted();
+	AddSignificanceUsage(Significances.Last().Bucket, 1);
+	const ACharacter* CharacterOwner = MovementComponent->GetCharacterOwner();
+	UnitAnimations.AddDefaulted_GetRef().Mesh = CharacterOwner ? CharacterOwner->GetMesh() : nullptr;
+	UnitProxies.AddDefaulted_GetRef().Mesh = UnitAnimations.Last().Mesh;
+	UnitEntities.AddDefaulted();
+	UnitTargets.AddDefaulted();
+	UnitSlots[UnitId] = Slot;
+	MovementComponent->UnitId = UnitId;
+	SyncMovementState(Slot);
+}
+
+int32 AGTPawnMovementManager::CreateUnitEntity(TSubclassOf<ACharacter> UnitClass, const FVector& Location, const FGenericTeamId& TeamId)
+{
+	const ACharacter* DefaultCharacter = UnitClass ? UnitClass->GetDefaultObject<ACharacter>() : nullptr;
+	const UGTCharacterMovementComponent* DefaultMovement = DefaultCharacter ? Cast<UGTCharacterMovementComponent>(DefaultCharacter->GetCharacterMovement()) : nullptr;
+	if (DefaultMovement == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("CreateUnitEntity needs a character class moved by a UGTCharacterMovementComponent, %s is not one"), *GetNameSafe(UnitClass));
+		return INDEX_NONE;
+	}
+
+	// What SyncMovementState would read from a walking component of the class.
+	const int32 UnitId = AllocateUnitId();
+	const int32 Slot = MovementComponents.Add(nullptr);
+	UnitIds.Add(UnitId);
+	PathStates.AddDefaulted();
+	OrderStates.AddDefaulted();
+	FGTUnitMovementHot& MovementState = MovementStates.AddDefaulted_GetRef();
+	MovementState.Location = FVector3f(Location);
+	MovementState.MaxSpeed = DefaultMovement->MaxWalkSpeed;
+	MovementState.MaxAcceleration = DefaultMovement->GetMaxAcceleration();
+	MovementState.GroundFriction = DefaultMovement->GroundFriction;
+	MovementState.BrakingDeceleration = DefaultMovement->BrakingDecelerationWalking;
+	MovementState.Flags = FGTUnitMovementHot::NavWalking;
+	FGTUnitBody& UnitBody = UnitBodies.AddDefaulted_GetRef();
+	UnitBody.Radius = DefaultCharacter->GetCapsuleComponent()->GetScaledCapsuleRadius();
+	UnitBody.TeamId = TeamId;
+
+	// Starts in the last bucket rather than the first, so it does not get an actor before it was ever scored.
+	Significances.AddDefaulted_GetRef().Bucket = static_cast<uint8>(FMath::Max(SignificanceBudgets.Num() - 1, 0));
+	AddSignificanceUsage(Significances.Last().Bucket, 1);
+	UnitAnimations.AddDefaulted();
+	FGTUnitProxy& UnitProxy = UnitProxies.AddDefaulted_GetRef();
+	UnitProxy.MeshTransform = DefaultCharacter->GetMesh()->GetRelativeTransform();
+	if (UStaticMesh* ProxyMesh = GetUnitProxyMesh(*UnitClass.Get()))
+	{
+		UnitProxy.Type = ProxyMeshes.FindOrAddType(*ProxyMesh, *this);
+	}
+	UnitEntities.AddDefaulted_GetRef().ActorClass = UnitClass;
+	UnitTargets.AddDefaulted();
+	UnitSlots[UnitId] = Slot;
+	return UnitId;
+}
+
+void AGTPawnMovementManager::DestroyUnit(int32 UnitId)
+{
+	const int32 Slot = GetUnitSlot(UnitId);
+	if (Slot == INDEX_NONE)
+	{
+		return;
+	}
+
+	// The actor's component removes the unit as it ends play.
+	if (const UGTCharacterMovementComponent* MovementComponent = MovementComponents[Slot])
+	{
+		MovementComponent->GetOwner()->Destroy();
+	}
+	else
+	{
+		RemoveUnitAtSlot(Slot);
+	}
+}
+
+bool AGTPawnMovementManager::IsUnitHydrated(int32 UnitId) const
+{
+	const int32 Slot = GetUnitSlot(UnitId);
+	return Slot != INDEX_NONE && MovementComponents[Slot] != nullptr;
+}
+
+void AGTPawnMovementManager::UnregisterMovementComponent(UGTCharacterMovementComponent* MovementComponent)
+{
+	const int32 Slot = GetUnitSlot(MovementComponent->UnitId);
+	if (Slot != INDEX_NONE && MovementComponents[Slot] == MovementComponent)
+	{
+		RemoveUnitAtSlot(Slot);
+	}
+	MovementComponent->UnitId = INDEX_NONE;
+}
+
+void AGTPawnMovementManager::RemoveUnitAtSlot(int32 Slot)
+{
+	ClearPath(PathStates[Slot]);
+	ClearRoute(PathStates[Slot]);
+	ClearOrders(OrderStates[Slot]);
+
+	const int32 UnitId = UnitIds[Slot];
+	UnitSlots[UnitId] = INDEX_NONE;
+	++UnitIdGenerations[UnitId];
+	FreeUnitIds.Add(UnitId);
+	if (MovementStates[Slot].Flags & FGTUnitMovementHot::Simulated)
+	{
+		SimRemovedUnitIds.Add(UnitId);
+	}
+
+	CrowdAnimation.Release(UnitAnimations[Slot]);
+	FogOfWar.RemoveViewer(UnitId);
+	AddSignificanceUsage(Significances[Slot].Bucket, -1);
+
+	MovementComponents.RemoveAtSwap(Slot, 1, false);
+	UnitIds.RemoveAtSwap(Slot, 1, false);
+	PathStates.RemoveAtSwap(Slot, 1, false);
+	OrderStates.RemoveAtSwap(Slot, 1, false);
+	MovementStates.RemoveAtSwap(Slot, 1, false);
+	UnitBodies.RemoveAtSwap(Slot, 1, false);
+	Significances.RemoveAtSwap(Slot, 1, false);
+	UnitAnimations.RemoveAtSwap(Slot, 1, false);
+	UnitProxies.RemoveAtSwap(Slot, 1, false);
+	UnitEntities.RemoveAtSwap(Slot, 1, false);
+	UnitTargets.RemoveAtSwap(Slot, 1, false);
+
+	if (UnitIds.IsValidIndex(Slot))
+	{
+		UnitSlots[UnitIds[Slot]] = Slot;
+	}
+	OnUnitRemoved.Broadcast(UnitId);
+}
+
+void AGTPawnMovementManager::RegisterPawnMovementComponent(UGTPawnMovementComponent* MovementComponent)
+{
+	if (MovementComponent->BucketIndex == INDEX_NONE)
+	{
+		MovementComponent->BucketIndex = PawnMovementComponents.Add(MovementComponent);
+		const AActor* Owner = MovementComponent->GetOwner();
+		PawnAnimations.AddDefaulted_GetRef().Mesh = Owner ? Owner->FindComponentByClass<USkeletalMeshComponent>() : nullptr;
+	}
+}
+
+void AGTPawnMovementManager::UnregisterPawnMovementComponent(UGTPawnMovementComponent* MovementComponent)
+{
+	const int32 Index = MovementComponent->BucketIndex;
+	if (PawnMovementComponents.IsValidIndex(Index) && PawnMovementComponents[Index] == MovementComponent)
+	{
+		CrowdAnimation.Release(PawnAnimations[Index]);
+		PawnMovementComponents.RemoveAtSwap(Index, 1, false);
+		PawnAnimations.RemoveAtSwap(Index, 1, false);
+		if (PawnMovementComponents.IsValidIndex(Index))
+		{
+			PawnMovementComponents[Index]->BucketIndex = Index;
+		}
+	}
+	MovementComponent->BucketIndex = INDEX_NONE;
+}
+
+void AGTPawnMovementManager::RegisterSquad(AGTSquad* Squad)
+{
+	Squads.AddUnique(Squad);
+}
+
+void AGTPawnMovementManager::UnregisterSquad(AGTSquad* Squad)
+{
+	Squads.Remove(Squad);
+}
+
+void AGTPawnMovementManager::ReserveUnits(int32 AdditionalUnits)
+{
+	const int32 NumUnits = MovementComponents.Num() + AdditionalUnits;
+	MovementComponents.Reserve(NumUnits);
+	UnitIds.Reserve(NumUnits);
+	UnitSlots.Reserve(NumUnits);
+	UnitIdGenerations.Reserve(NumUnits);
+	PathStates.Reserve(NumUnits);
+	OrderStates.Reserve(NumUnits);
+	MovementStates.Reserve(NumUnits);
+	UnitBodies.Reserve(NumUnits);
+	Significances.Reserve(NumUnits);
+	UnitAnimations.Reserve(NumUnits);
+	UnitProxies.Reserve(NumUnits);
+	UnitEntities.Reserve(NumUnits);
+	UnitTargets.Reserve(NumUnits);
+	PawnMovementComponents.Reserve(PawnMovementComponents.Num() + AdditionalUnits);
+	PawnAnimations.Reserve(PawnMovementComponents.Num() + AdditionalUnits);
+}
+
+UGTCharacterMovementComponent* AGTPawnMovementManager::GetUnitMovementComponent(int32 UnitId) const
+{
+	const int32 Slot = GetUnitSlot(UnitId);
+	return Slot != INDEX_NONE ? MovementComponents[Slot] : nullptr;
+}
+
+FVector AGTPawnMovementManager::GetUnitLocation(int32 UnitId) const
+{
+	const int32 Slot = GetUnitSlot(UnitId);
+	return Slot != INDEX_NONE ? GetUnitFeetLocation(Slot) : FVector::ZeroVector;
+}
+
+FGenericTeamId AGTPawnMovementManager::GetUnitTeamId(int32 UnitId) const
+{
+	const int32 Slot = GetUnitSlot(UnitId);
+	return Slot != INDEX_NONE ? UnitBodies[Slot].TeamId : FGenericTeamId::NoTeam;
+}
+
+bool AGTPawnMovementManager::RequestMove(int32 UnitId, const FVector& Destination, float AcceptanceRadius)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AGTPawnMovementManager_RequestMove);
+	const int32 Slot = GetUnitSlot(UnitId);
+	if (Slot == INDEX_NONE)
+	{
+		return false;
+	}
+
+	FGTPathFollowState& PathState = PathStates[Slot];
+	ClearRoute(PathState);
+
+	const FVector Start = GetUnitFeetLocation(Slot);
+	if (bUseHierarchicalPathfinding && FVector::DistSquared2D(Start, Destination) > FMath::Square(HierarchicalPathDistance)
+		&& NavClusterGraph.FindRoute(Start, Destination, ScratchRoute))
+	{
+		PathState.Route = RoutePool.Allocate(ScratchRoute.Num());
+		FMemory::Memcpy(RoutePool.GetData(PathState.Route), ScratchRoute.GetData(), ScratchRoute.Num() * sizeof(FVector));
+		PathState.RouteIndex = 0;
+
+		// Only the way to the first cluster node is searched now, the rest is refined as the unit gets there.
+		if (FindUnitPath(Slot, ScratchRoute[0], AcceptanceRadius))
+		{
+			return true;
+		}
+		ClearRoute(PathStates[Slot]);
+	}
+
+	if (!FindUnitPath(Slot, Destination, AcceptanceRadius))
+	{
+		StopUnit(UnitId);
+		return false;
+	}
+	return true;
+}
+
+bool AGTPawnMovementManager::FindUnitPath(int32 Slot, const FVector& Destination, float AcceptanceRadius)
+{
+	UNavigationSystemV1* NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	ANavigationData* NavData = NavigationSystem ? NavigationSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+	if (NavData == nullptr)
+	{
+		return false;
+	}
+
+	const UGTCharacterMovementComponent* MovementComponent = GetPathQuerier(Slot);
+	const FVector Start = GetUnitFeetLocation(Slot);
+
+	if (bUsePathCache)
+	{
+		const FNavAgentProperties& AgentProperties = MovementComponent->GetNavAgentPropertiesRef();
+		const uint32 AgentProfile = HashCombine(GetTypeHash(AgentProperties.AgentRadius), GetTypeHash(AgentProperties.AgentHeight));
+		if (!PathCache.FindPath(*NavigationSystem, *NavData, MovementComponent, Start, Destination, AgentProfile, ScratchPath, ScratchPathPoints, ScratchCorridor,
+		                        GetPathFilter(*NavData)))
+		{
+			return false;
+		}
+
+		SetUnitPath(UnitIds[Slot], ScratchPathPoints, ScratchCorridor, AcceptanceRadius);
+		return true;
+	}
+
+	const FPathFindingQuery Query(MovementComponent, *NavData, Start, Destination, GetPathFilter(*NavData), ScratchPath);
+	const FPathFindingResult Result = NavigationSystem->FindPathSync(Query);
+	if (!Result.IsSuccessful() || !Result.Path.IsValid())
+	{
+		return false;
+	}
+
+	SetUnitPath(UnitIds[Slot], *Result.Path, AcceptanceRadius);
+	return true;
+}
+
+void AGTPawnMovementManager::RefineRoute(int32 UnitId)
+{
+	const int32 Slot = GetUnitSlot(UnitId);
+	if (Slot == INDEX_NONE || !PathStates[Slot].HasRouteLeft())
+	{
+		return;
+	}
+
+	FGTPathFollowState& PathState = PathStates[Slot];
+	const int32 RouteIndex = ++PathState.RouteIndex;
+	const FVector Target = RoutePool.GetData(PathState.Route)[RouteIndex];
+	if (!FindUnitPath(Slot, Target, PathState.AcceptanceRadius))
+	{
+		StopUnit(UnitId);
+	}
+}
+
+void AGTPawnMovementManager::ClearRoute(FGTPathFollowState& PathState)
+{
+	RoutePool.Free(PathState.Route);
+	PathState.RouteIndex = 0;
+}
+
+void AGTPawnMovementManager::UpdateNavClusterGraph()
+{
+	if (!bUseHierarchicalPathfinding)
+	{
+		return;
+	}
+
+	if (!NavClusterGraph.IsInitialized())
+	{
+		UNavigationSystemV1* NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+		ANavigationData* NavData = NavigationSystem ? NavigationSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+		if (NavData == nullptr)
+		{
+			return;
+		}
+		NavClusterGraph.Initialize(*NavigationSystem, *NavData, NavClusterSize);
+	}
+
+	NavClusterGraph.Update(NavClusterUpdateBudgetMs);
+}
+
+void AGTPawnMovementManager::SetUnitPath(int32 UnitId, const FNavigationPath& Path, float AcceptanceRadius)
+{
+	const FNavMeshPath* NavMeshPath = Path.CastPath<FNavMeshPath>();
+	SetUnitPath(UnitId, Path.GetPathPoints(), NavMeshPath ? TConstArrayView<NavNodeRef>(NavMeshPath->PathCorridor) : TConstArrayView<NavNodeRef>(), AcceptanceRadius);
+}
+
+void AGTPawnMovementManager::SetUnitPath(int32 UnitId, TConstArrayView<FNavPathPoint> PathPoints, TConstArrayView<NavNodeRef> Corridor, float AcceptanceRadius)
+{
+	const int32 Slot = GetUnitSlot(UnitId);
+	if (Slot == INDEX_NONE)
+	{
+		return;
+	}
+
+	FGTPathFollowState& PathState = PathStates[Slot];
+	ClearPath(PathState);
+
+	PathState.Waypoints = WaypointPool.Allocate(PathPoints.Num());
+	FGTPathWaypoint* Waypoints = WaypointPool.GetData(PathState.Waypoints);
+	for (int32 Index = 0; Index < PathPoints.Num(); ++Index)
+	{
+		Waypoints[Index] = {PathPoints[Index].Location, PathPoints[Index].NodeRef};
+	}
+
+	PathState.Corridor = CorridorPool.Allocate(Corridor.Num());
+	if (PathState.Corridor.Count > 0)
+	{
+		FMemory::Memcpy(CorridorPool.GetData(PathState.Corridor), Corridor.GetData(), PathState.Corridor.Count * sizeof(NavNodeRef));
+	}
+
+	// The first corner is the start location.
+	PathState.SegmentIndex = FMath::Min(1, PathState.Waypoints.Count - 1);
+	PathState.AcceptanceRadius = AcceptanceRadius;
+	PathState.DistanceToCorner = 0.f;
+}
+
+void AGTPawnMovementManager::StopUnit(int32 UnitId)
+{
+	const int32 Slot = GetUnitSlot(UnitId);
+	if (Slot != INDEX_NONE)
+	{
+		ClearPath(PathStates[Slot]);
+		ClearRoute(PathStates[Slot]);
+		ClearOrders(OrderStates[Slot]);
+		if (UGTCharacterMovementComponent* MovementComponent = MovementComponents[Slot])
+		{
+			MovementComponent->StopActiveMovement();
+		}
+	}
+}
+
+bool AGTPawnMovementManager::IsFollowingPath(int32 UnitId) const
+{
+	const int32 Slot = GetUnitSlot(UnitId);
+	return Slot != INDEX_NONE && PathStates[Slot].IsActive();
+}
+
+bool AGTPawnMovementManager::IsAttackMoving(int32 UnitId) const
+{
+	const int32 Slot = GetUnitSlot(UnitId);
+	return Slot != INDEX_NONE && OrderStates[Slot].bAttackMove;
+}
+
+void AGTPawnMovementManager::SetUnitSelected(int32 UnitId, bool bSelected)
+{
+	const int32 Slot = GetUnitSlot(UnitId);
+	if (Slot != INDEX_NONE)
+	{
+		Significances[Slot].bSelected = bSelected;
+	}
+}
+
+void AGTPawnMovementManager::NotifyUnitInCombat(int32 UnitId)
+{
+	const int32 Slot = GetUnitSlot(UnitId);
+	if (Slot != INDEX_NONE)
+	{
+		Significances[Slot].LastCombatTime = GetWorld()->GetTimeSeconds();
+	}
+}
+
+float AGTPawnMovementManager::GetUnitSignificance(int32 UnitId) const
+{
+	const int32 Slot = GetUnitSlot(UnitId);
+	return Slot != INDEX_NONE ? Significances[Slot].Score : 0.f;
+}
+
+int32 AGTPawnMovementManager::GetUnitTarget(int32 UnitId) const
+{
+	const int32 Slot = GetUnitSlot(UnitId);
+	return Slot != INDEX_NONE && HasValidTarget(Slot) ? UnitTargets[Slot].UnitId : INDEX_NONE;
+}
+
+bool AGTPawnMovementManager::HasValidTarget(int32 Slot) const
+{
+	// A target whose id was freed and handed to another unit since is gone, whatever team the new unit is on.
+	const FGTUnitTarget& Target = UnitTargets[Slot];
+	const int32 TargetSlot = GetUnitSlot(Target.UnitId);
+	return TargetSlot != INDEX_NONE && UnitIdGenerations[Target.UnitId] == Target.Generation
+		&& FGenericTeamId::GetAttitude(UnitBodies[Slot].TeamId, UnitBodies[TargetSlot].TeamId) == ETeamAttitude::Hostile;
+}
+
+const FGTSignificanceBudget& AGTPawnMovementManager::GetUnitBudget(int32 UnitId) const
+{
+	const int32 Slot = GetUnitSlot(UnitId);
+	return GetBudget(Slot != INDEX_NONE ? Significances[Slot].Bucket : MAX_int32);
+}
+
+const FGTSignificanceBudget& AGTPawnMovementManager::GetBudget(int32 Index) const
+{
+	static const FGTSignificanceBudget DefaultBudget;
+	return SignificanceBudgets.Num() > 0 ? SignificanceBudgets[FMath::Min(Index, SignificanceBudgets.Num() - 1)] : DefaultBudget;
+}
+
+void AGTPawnMovementManager::RequestUnitVelocity(int32 UnitId, const FVector& Velocity)
+{
+	const int32 Slot = GetUnitSlot(UnitId);
+	if (Slot != INDEX_NONE)
+	{
+		MovementStates[Slot].RequestedVelocity = FVector3f(Velocity);
+	}
+}
+
+void AGTPawnMovementManager::MarkMovementStateDirty(int32 UnitId)
+{
+	const int32 Slot = GetUnitSlot(UnitId);
+	if (Slot != INDEX_NONE)
+	{
+		MovementStates[Slot].Flags |= FGTUnitMovementHot::Dirty;
+	}
+}
+
+void AGTPawnMovementManager::EnqueueCommand(const FGTUnitCommand& Command)
+{
+	FGTUnitCommand& PendingCommand = PendingCommands.Add_GetRef(Command);
+	PendingCommand.Sequence = NextCommandSequence++;
+}
+
+void AGTPawnMovementManager::EnqueueCommands(TConstArrayView<FGTUnitCommand> Commands)
+{
+	const int32 FirstIndex = PendingCommands.Num();
+	PendingCommands.Append(Commands.GetData(), Commands.Num());
+	for (int32 Index = FirstIndex; Index < PendingCommands.Num(); ++Index)
+	{
+		PendingCommands[Index].Sequence = NextCommandSequence++;
+	}
+}
+
+void AGTPawnMovementManager::ApplyCommands()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AGTPawnMovementManager_ApplyCommands);
+	++FrameNumber;
+	if (PendingCommands.Num() == 0)
+	{
+		return;
+	}
+
+	// Applying in slot order walks the per-unit rows front to back instead of jumping around with the click order.
+	// Slot in the high bits and command index in the low bits, so a plain sort orders commands by slot, then by recording.
+	FGTFrameArenaScope ArenaScope;
+	TGTFrameArray<uint64> CommandOrder;
+	CommandOrder.Reserve(PendingCommands.Num());
+	for (int32 Index = 0; Index < PendingCommands.Num(); ++Index)
+	{
+		const int32 Slot = GetUnitSlot(PendingCommands[Index].UnitId);
+		if (Slot != INDEX_NONE)
+		{
+			CommandOrder.Add(static_cast<uint64>(Slot) << 32 | static_cast<uint32>(Index));
+		}
+	}
+	CommandOrder.Sort();
+
+	for (const uint64 Key : CommandOrder)
+	{
+		FGTUnitCommand& Command = PendingCommands[static_cast<int32>(Key & MAX_uint32)];
+		Command.Frame = FrameNumber;
+		ApplyCommand(static_cast<int32>(Key >> 32), Command);
+		if (bRecordCommands)
+		{
+			CommandLog.Add(Command);
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_AGTPawnMovementManager_CommandsApplied, CommandOrder.Num());
+	PendingCommands.Reset();
+}
+
+void AGTPawnMovementManager::ApplyCommand(int32 Slot, const FGTUnitCommand& Command)
+{
+	FGTUnitOrderState& OrderState = OrderStates[Slot];
+	switch (Command.Type)
+	{
+	case EGTUnitCommandType::Move:
+	case EGTUnitCommandType::AttackMove:
+		ClearOrders(OrderState);
+		OrderState.bAttackMove = Command.Type == EGTUnitCommandType::AttackMove;
+		RequestMove(Command.UnitId, Command.Target, OrderState.AcceptanceRadius);
+		break;
+
+	case EGTUnitCommandType::Stop:
+		StopUnit(Command.UnitId);
+		break;
+
+	case EGTUnitCommandType::QueueWaypoint:
+		if (PathStates[Slot].IsActive() || OrderState.HasQueuedWaypoints())
+		{
+			QueueWaypoint(OrderState, Command.Target);
+		}
+		else
+		{
+			RequestMove(Command.UnitId, Command.Target, OrderState.AcceptanceRadius);
+		}
+		break;
+	}
+}
+
+void AGTPawnMovementManager::QueueWaypoint(FGTUnitOrderState& OrderState, const FVector& Waypoint)
+{
+	// Waypoints already walked are dropped while the span is grown by one.
+	const int32 NumLeft = OrderState.HasQueuedWaypoints() ? OrderState.QueuedWaypoints.Count - OrderState.QueueIndex : 0;
+	const FGTPathSpan NewSpan = OrderQueuePool.Allocate(NumLeft + 1);
+	FVector* NewWaypoints = OrderQueuePool.GetData(NewSpan);
+	if (NumLeft > 0)
+	{
+		FMemory::Memcpy(NewWaypoints, OrderQueuePool.GetData(OrderState.QueuedWaypoints) + OrderState.QueueIndex, NumLeft * sizeof(FVector));
+	}
+	NewWaypoints[NumLeft] = Waypoint;
+
+	OrderQueuePool.Free(OrderState.QueuedWaypoints);
+	OrderState.QueuedWaypoints = NewSpan;
+	OrderState.QueueIndex = 0;
+}
+
+void AGTPawnMovementManager::StartNextQueuedWaypoint(int32 UnitId)
+{
+	const int32 Slot = GetUnitSlot(UnitId);
+	if (Slot == INDEX_NONE || !OrderStates[Slot].HasQueuedWaypoints())
+	{
+		return;
+	}
+
+	FGTUnitOrderState& OrderState = OrderStates[Slot];
+	const FVector Waypoint = OrderQueuePool.GetData(OrderState.QueuedWaypoints)[OrderState.QueueIndex++];
+	if (!OrderState.HasQueuedWaypoints())
+	{
+		OrderQueuePool.Free(OrderState.QueuedWaypoints);
+		OrderState.QueueIndex = 0;
+	}
+	RequestMove(UnitId, Waypoint, OrderState.AcceptanceRadius);
+}
+
+void AGTPawnMovementManager::ClearOrders(FGTUnitOrderState& OrderState)
+{
+	OrderQueuePool.Free(OrderState.QueuedWaypoints);
+	OrderState.QueueIndex = 0;
+	OrderState.bAttackMove = false;
+}
+
+TConstArrayView<FGTPathWaypoint> AGTPawnMovementManager::GetUnitWaypoints(int32 UnitId) const
+{
+	const int32 Slot = GetUnitSlot(UnitId);
+	return Slot != INDEX_NONE ? WaypointPool.GetView(PathStates[Slot].Waypoints) : TConstArrayView<FGTPathWaypoint>();
+}
+
+TConstArrayView<NavNodeRef> AGTPawnMovementManager::GetUnitCorridor(int32 UnitId) const
+{
+	const int32 Slot = GetUnitSlot(UnitId);
+	return Slot != INDEX_NONE ? CorridorPool.GetView(PathStates[Slot].Corridor) : TConstArrayView<NavNodeRef>();
+}
+
+void AGTPawnMovementManager::ClearPath(FGTPathFollowState& PathState)
+{
+	WaypointPool.Free(PathState.Waypoints);
+	CorridorPool.Free(PathState.Corridor);
+	PathState.SegmentIndex = 0;
+	PathState.DistanceToCorner = 0.f;
+}
+
+void AGTPawnMovementManager::AdvancePathFollowing()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AGTPawnMovementManager_AdvancePathFollowing);
+	FGTFrameArenaScope ArenaScope;
+	TGTFrameArray<int32> UnitsToRefine;
+	TGTFrameArray<int32> UnitsArrived;
+
+	for (int32 Slot = 0; Slot < MovementComponents.Num(); ++Slot)
+	{
+		FGTPathFollowState& PathState = PathStates[Slot];
+		if (!PathState.IsActive())
+		{
+			continue;
+		}
+
+		FGTUnitMovementHot& MovementState = MovementStates[Slot];
+		const FGTPathWaypoint* Waypoints = WaypointPool.GetData(PathState.Waypoints);
+		const FVector Location(MovementState.Location);
+		const int32 LastCorner = PathState.Waypoints.Count - 1;
+
+		// Skip every corner already reached this frame, a fast unit can pass more than one.
+		FVector ToCorner = Waypoints[PathState.SegmentIndex].Location - Location;
+		PathState.DistanceToCorner = ToCorner.Size2D();
+		while (PathState.SegmentIndex < LastCorner && PathState.DistanceToCorner <= PathCornerRadius)
+		{
+			++PathState.SegmentIndex;
+			ToCorner = Waypoints[PathState.SegmentIndex].Location - Location;
+			PathState.DistanceToCorner = ToCorner.Size2D();
+		}
+
+		if (PathState.SegmentIndex == LastCorner)
+		{
+			// Long orders refine the next route leg before the unit reaches the end of the current one, so it never stops at a cluster node.
+			if (PathState.HasRouteLeft())
+			{
+				if (PathState.DistanceToCorner <= NavClusterGraph.GetClusterSize() * 0.5f)
+				{
+					UnitsToRefine.Add(UnitIds[Slot]);
+				}
+			}
+			else if (PathState.DistanceToCorner <= PathState.AcceptanceRadius)
+			{
+				// The last leg's route is spent, its pool span goes back with the path.
+				ClearPath(PathState);
+				ClearRoute(PathState);
+				if (OrderStates[Slot].HasQueuedWaypoints())
+				{
+					UnitsArrived.Add(UnitIds[Slot]);
+				}
+				else
+				{
+					OrderStates[Slot].bAttackMove = false;
+				}
+				continue;
+			}
+		}
+
+		ToCorner.Z = 0.f;
+		MovementState.RequestedVelocity = FVector3f(ToCorner.GetSafeNormal() * MovementState.MaxSpeed);
+	}
+
+	for (const int32 UnitId : UnitsToRefine)
+	{
+		RefineRoute(UnitId);
+	}
+
+	for (const int32 UnitId : UnitsArrived)
+	{
+		StartNextQueuedWaypoint(UnitId);
+	}
+}
+
+void AGTPawnMovementManager::SyncMovementStates()
+{
+	for (int32 Slot = 0; Slot < MovementStates.Num(); ++Slot)
+	{
+		if (MovementStates[Slot].Flags & FGTUnitMovementHot::Dirty)
+		{
+			SyncMovementState(Slot);
+		}
+	}
+}
+
+void AGTPawnMovementManager::SyncMovementState(int32 Slot)
+{
+	const UGTCharacterMovementComponent* MovementComponent = MovementComponents[Slot];
+	FGTUnitMovementHot& MovementState = MovementStates[Slot];
+	if (MovementState.Flags & FGTUnitMovementHot::Simulated)
+	{
+		// The physics thread drops its copy, PushSimInputs hands the unit over again if it still walks the navmesh.
+		SimRemovedUnitIds.Add(UnitIds[Slot]);
+	}
+	if (MovementComponent == nullptr)
+	{
+		// An entity unit without an actor is its hot record, there is nothing to read back.
+		MovementState.Flags = FGTUnitMovementHot::NavWalking;
+		return;
+	}
+
+	MovementState.Location = FVector3f(MovementComponent->GetActorFeetLocation());
+	MovementState.Velocity = FVector3f(MovementComponent->Velocity);
+	MovementState.MaxSpeed = MovementComponent->GetMaxSpeed();
+	MovementState.MaxAcceleration = MovementComponent->GetMaxAcceleration();
+	MovementState.GroundFriction = MovementComponent->GroundFriction;
+	MovementState.BrakingDeceleration = MovementComponent->GetMaxBrakingDeceleration();
+	MovementState.Flags = MovementComponent->CanUseHotNavWalking() ? FGTUnitMovementHot::NavWalking : 0;
+
+	const ACharacter* CharacterOwner = MovementComponent->GetCharacterOwner();
+	FGTUnitBody& UnitBody = UnitBodies[Slot];
+	UnitBody.Radius = CharacterOwner ? CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleRadius() : 0.f;
+	const FGenericTeamId TeamId = FGenericTeamId::GetTeamIdentifier(CharacterOwner);
+	// An entity unit keeps its team through an actor whose controller does not carry one.
+	if (TeamId != FGenericTeamId::NoTeam || !UnitEntities[Slot].IsEntity())
+	{
+		UnitBody.TeamId = TeamId;
+	}
+}
+
+void AGTPawnMovementManager::UpdateCharacterMovement(float DeltaTime)
+{
+	StageNavWalking(DeltaTime);
+	SolveStagedVelocities();
+	SeparateStagedUnits();
+	ProjectStagedMoves();
+	CommitCharacterMovement();
+}
+
+void AGTPawnMovementManager::UpdatePawnMovement(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AGTPawnMovementManager_UpdatePawnMovement);
+	UGTPawnMovementComponent::UpdateMovementBatch(PawnMovementComponents, DeltaTime);
+}
+
+void AGTPawnMovementManager::StageNavWalking(float DeltaTime)
+{
+	UNavigationSystemV1* NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	StagedNavData = NavigationSystem ? NavigationSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+	StagedQueryExtent = StagedNavData ? StagedNavData->GetConfig().DefaultQueryExtent : FVector::ZeroVector;
+	StagedDeltaTime = DeltaTime;
+	bStagedNavWalking = bUseHotNavWalking && StagedNavData != nullptr && DeltaTime >= UCharacterMovementComponent::MIN_TICK_TIME;
+
+	StagedStates.Reset();
+	StagedUnitIds.Reset();
+	StagedDeltaTimes.Reset();
+	StagedHeightfieldProjections.Reset();
+	StagedPushes.Reset();
+	SeparationBodies.Reset();
+	NumSeparatedStaged = 0;
+	if (!bStagedNavWalking)
+	{
+		StagedMoves.Reset();
+		StagedHeightfield.Reset();
+		return;
+	}
+
+	const bool bWantsHeightfield = SignificanceBudgets.ContainsByPredicate([](const FGTSignificanceBudget& Budget) { return Budget.NavProjection == EGTNavProjection::Heightfield; });
+	if (bWantsHeightfield)
+	{
+		GetSimHeightfield(*StagedNavData);
+	}
+	StagedHeightfield = bWantsHeightfield ? SimHeightfield : nullptr;
+
+	const auto StageUnit = [this](int32 Slot, const FGTSignificanceBudget& Budget)
+	{
+		FGTUnitMovementHot& MovementState = MovementStates[Slot];
+		FGTUnitSignificance& Significance = Significances[Slot];
+		StagedStates.Add(MovementState);
+		StagedUnitIds.Add(UnitIds[Slot]);
+		StagedDeltaTimes.Add(Significance.PendingDeltaTime);
+		StagedHeightfieldProjections.Add(StagedHeightfield.IsValid() && Budget.NavProjection == EGTNavProjection::Heightfield);
+		MovementState.RequestedVelocity = FVector3f::ZeroVector;
+		Significance.PendingDeltaTime = 0.f;
+		if (SignificanceUsage.IsValidIndex(Significance.Bucket))
+		{
+			++SignificanceUsage[Significance.Bucket].MovementUpdates;
+		}
+	};
+
+	// Units that walk through others are staged after the separated ones, so the separation pass moves a prefix.
+	FGTFrameArenaScope ArenaScope;
+	TGTFrameArray<int32> UnseparatedSlots;
+	TBitArray<TGTFrameAllocator<>> SeparatedSlots(false, MovementStates.Num());
+	int32 NumSkipped = 0;
+	for (int32 Slot = 0; Slot < MovementStates.Num(); ++Slot)
+	{
+		const FGTUnitMovementHot& MovementState = MovementStates[Slot];
+		FGTUnitSignificance& Significance = Significances[Slot];
+		if (!MovementState.IsNavWalking() || (MovementState.Flags & FGTUnitMovementHot::Simulated))
+		{
+			Significance.PendingDeltaTime = 0.f;
+			continue;
+		}
+
+		// Unit ids spread the units of one bucket over the frames it skips.
+		const FGTSignificanceBudget& Budget = GetBudget(Significance.Bucket);
+		Significance.PendingDeltaTime = FMath::Min(Significance.PendingDeltaTime + DeltaTime, GTPawnMovementManager::MaxPendingDeltaTime);
+		if ((FrameNumber + static_cast<uint32>(UnitIds[Slot])) % static_cast<uint32>(FMath::Max(Budget.MovementUpdateInterval, 1)) != 0)
+		{
+			++NumSkipped;
+			continue;
+		}
+
+		if (!bSeparateUnits || Budget.Avoidance == EGTAvoidanceQuality::None)
+		{
+			UnseparatedSlots.Add(Slot);
+			continue;
+		}
+
+		SeparationBodies.Add({FVector2f(MovementState.Location), UnitBodies[Slot].Radius, UnitBodies[Slot].TeamId, !MovementState.RequestedVelocity.IsZero()});
+		SeparatedSlots[Slot] = true;
+		StageUnit(Slot, Budget);
+	}
+
+	NumSeparatedStaged = StagedStates.Num();
+	for (const int32 Slot : UnseparatedSlots)
+	{
+		StageUnit(Slot, GetBudget(Significances[Slot].Bucket));
+	}
+	StagedMoves.SetNumUninitialized(StagedStates.Num());
+	SET_DWORD_STAT(STAT_AGTPawnMovementManager_SkippedUnits, NumSkipped);
+
+	// Every unit the pass does not move stands where it is as an obstacle.
+	if (NumSeparatedStaged > 0)
+	{
+		for (int32 Slot = 0; Slot < MovementStates.Num(); ++Slot)
+		{
+			if (!SeparatedSlots[Slot])
+			{
+				SeparationBodies.Add({FVector2f(MovementStates[Slot].Location), UnitBodies[Slot].Radius, UnitBodies[Slot].TeamId, false});
+			}
+		}
+	}
+}
+
+void AGTPawnMovementManager::SolveStagedVelocities()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AGTPawnMovementManager_SolveVelocities);
+
+	GTPawnMovementManager::TimedParallelFor(StagedStates.Num(), TaskThreadCycles, [this](int32 Index)
+	{
+		FGTUnitMovementHot& MovementState = StagedStates[Index];
+		MovementState.Velocity = MovementState.CalcNavWalkingVelocity(StagedDeltaTimes[Index]);
+	});
+}
+
+void AGTPawnMovementManager::SeparateStagedUnits()
+{
+	const int32 NumSeparated = NumSeparatedStaged;
+	if (SeparationBodies.Num() == 0)
+	{
+		return;
+	}
+
+	// Units are separated where their move would take them.
+	for (int32 Index = 0; Index < NumSeparated; ++Index)
+	{
+		const FGTUnitMovementHot& MovementState = StagedStates[Index];
+		const float DeltaTime = StagedDeltaTimes[Index];
+		SeparationBodies[Index].Position = FVector2f(MovementState.Location.X + MovementState.Velocity.X * DeltaTime, MovementState.Location.Y + MovementState.Velocity.Y * DeltaTime);
+	}
+
+	Separation.Iterations = SeparationIterations;
+	Separation.Stiffness = SeparationStiffness;
+	Separation.FriendlyPushRatio = FriendlyPushRatio;
+	StagedPushes.SetNumZeroed(StagedStates.Num());
+	Separation.Solve(SeparationBodies, NumSeparated, StagedPushes);
+	TaskThreadCycles += Separation.GetLastSolveCycles();
+
+	for (int32 Index = 0; Index < NumSeparated; ++Index)
+	{
+		StagedPushes[Index] = StagedPushes[Index].GetClampedToMaxSize(MaxSeparationSpeed * StagedDeltaTimes[Index]);
+	}
+}
+
+void AGTPawnMovementManager::ProjectStagedMoves()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AGTPawnMovementManager_NavQueries);
+
+	// Navmesh tiles are only rebuilt by the navigation system's own tick, which ran before this frame's actor ticks.
+	const ANavigationData* NavData = StagedNavData;
+	const FGTNavHeightfield* Heightfield = StagedHeightfield.Get();
+	const FVector QueryExtent = StagedQueryExtent;
+	GTPawnMovementManager::TimedParallelFor(StagedStates.Num(), TaskThreadCycles, [this, NavData, Heightfield, &QueryExtent](int32 Index)
+	{
+		FGTUnitMovementHot& MovementState = StagedStates[Index];
+		const float DeltaTime = StagedDeltaTimes[Index];
+		const FVector2f Push = StagedPushes.IsValidIndex(Index) ? StagedPushes[Index] : FVector2f::ZeroVector;
+		FVector3f Delta = MovementState.Velocity * DeltaTime + FVector3f(Push.X, Push.Y, 0.f);
+		if (Delta.IsNearlyZero())
+		{
+			StagedMoves[Index] = EStagedMove::Stopped;
+			return;
+		}
+
+		FVector NewLocation = FVector(MovementState.Location) + FVector(Delta);
+
+		// The heightfield keeps the poly of the last navmesh projection, and hands the units it has no ground for to
+		// the navmesh, which decides whether they left it.
+		float Height;
+		if (StagedHeightfieldProjections[Index] && Heightfield->GetHeight(FVector2f(NewLocation.X, NewLocation.Y), Height))
+		{
+			MovementState.Location = FVector3f(NewLocation.X, NewLocation.Y, Height);
+			StagedMoves[Index] = EStagedMove::Moved;
+			return;
+		}
+
+		FNavLocation NavLocation;
+		bool bOnNavMesh = NavData->ProjectPoint(NewLocation, NavLocation, QueryExtent);
+		if (!bOnNavMesh && !Push.IsZero())
+		{
+			// A push never takes a unit off the navmesh, the unit only makes its own move.
+			Delta = MovementState.Velocity * DeltaTime;
+			if (Delta.IsNearlyZero())
+			{
+				StagedMoves[Index] = EStagedMove::Stopped;
+				return;
+			}
+			NewLocation = FVector(MovementState.Location) + FVector(Delta);
+			bOnNavMesh = NavData->ProjectPoint(NewLocation, NavLocation, QueryExtent);
+		}
+
+		if (!bOnNavMesh)
+		{
+			StagedMoves[Index] = EStagedMove::LeftNavMesh;
+			return;
+		}
+
+		// Pushed units are kept on the navmesh by taking the projected point, which the query extent keeps close.
+		NewLocation = Push.IsZero() ? FVector(NewLocation.X, NewLocation.Y, NavLocation.Location.Z) : NavLocation.Location;
+		MovementState.Location = FVector3f(NewLocation);
+		MovementState.NodeRef = NavLocation.NodeRef;
+		StagedMoves[Index] = EStagedMove::Moved;
+	});
+}
+
+void AGTPawnMovementManager::CommitCharacterMovement()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AGTPawnMovementManager_UpdateCharacterMovement);
+
+	// Every unit that was neither staged nor simulated goes through the component, and has its record read again since
+	// nothing reports what changed. Units that became dirty after staging drop their staged move and are updated here.
+	const float DeltaTime = StagedDeltaTime;
+	for (int32 Slot = 0; Slot < MovementStates.Num(); ++Slot)
+	{
+		FGTUnitMovementHot& MovementState = MovementStates[Slot];
+		if (MovementState.IsNavWalking() && (bStagedNavWalking || (MovementState.Flags & FGTUnitMovementHot::Simulated)))
+		{
+			continue;
+		}
+
+		UGTCharacterMovementComponent* MovementComponent = MovementComponents[Slot];
+		if (MovementComponent == nullptr)
+		{
+			// Entity units without an actor only walk through the hot update.
+			MovementState.RequestedVelocity = FVector3f::ZeroVector;
+			continue;
+		}
+		if (!MovementState.RequestedVelocity.IsZero())
+		{
+			MovementComponent->RequestDirectMove(FVector(MovementState.RequestedVelocity), false);
+			MovementState.RequestedVelocity = FVector3f::ZeroVector;
+		}
+		MovementComponent->UpdateMovement(DeltaTime);
+		MovementState.Location = FVector3f(MovementComponent->GetActorFeetLocation());
+		MovementState.Flags |= FGTUnitMovementHot::Dirty;
+	}
+
+	int32 NumHotUnits = 0;
+	for (int32 Index = 0; Index < StagedStates.Num(); ++Index)
+	{
+		const int32 Slot = GetUnitSlot(StagedUnitIds[Index]);
+		if (Slot == INDEX_NONE || !MovementStates[Slot].IsNavWalking() || (MovementStates[Slot].Flags & FGTUnitMovementHot::Simulated))
+		{
+			continue;
+		}
+
+		const FGTUnitMovementHot& StagedState = StagedStates[Index];
+		FGTUnitMovementHot& MovementState = MovementStates[Slot];
+		UGTCharacterMovementComponent* MovementComponent = MovementComponents[Slot];
+		++NumHotUnits;
+
+		switch (StagedMoves[Index])
+		{
+		case EStagedMove::Stopped:
+			if (!MovementState.Velocity.IsZero())
+			{
+				MovementState.Velocity = FVector3f::ZeroVector;
+				if (MovementComponent)
+				{
+					MovementComponent->Velocity = FVector::ZeroVector;
+				}
+			}
+			break;
+
+		case EStagedMove::LeftNavMesh:
+			// Off the navmesh, the component falls back to walking and takes the unit from here. An entity unit without
+			// one stops at the edge.
+			if (MovementComponent)
+			{
+				MovementComponent->SetMovementMode(MOVE_Walking);
+			}
+			else
+			{
+				MovementState.Velocity = FVector3f::ZeroVector;
+			}
+			break;
+
+		case EStagedMove::Moved:
+		{
+			const FVector AdjustedDelta = FVector(StagedState.Location) - FVector(MovementState.Location);
+			if (MovementComponent)
+			{
+				// Idle units pushed by separation move without a velocity of their own and keep facing where they did.
+				const FRotator NewRotation = StagedState.Velocity.IsNearlyZero()
+					? MovementComponent->UpdatedComponent->GetComponentRotation()
+					: FRotator(0.f, FMath::RadiansToDegrees(FMath::Atan2(StagedState.Velocity.Y, StagedState.Velocity.X)), 0.f);
+				MovementComponent->UpdatedComponent->MoveComponent(AdjustedDelta, NewRotation, false, nullptr, MovementComponent->MoveComponentFlags, ETeleportType::ResetPhysics);
+			}
+
+			// Same as PhysNavWalking, velocity reflects the move that was made.
+			MovementState.NodeRef = StagedState.NodeRef;
+			MovementState.Location = StagedState.Location;
+			MovementState.Velocity = FVector3f(AdjustedDelta.X, AdjustedDelta.Y, 0.f) / StagedDeltaTimes[Index];
+			if (MovementComponent)
+			{
+				MovementComponent->Velocity = FVector(MovementState.Velocity);
+			}
+			break;
+		}
+		}
+	}
+	SET_DWORD_STAT(STAT_AGTPawnMovementManager_HotNavWalkingUnits, NumHotUnits);
+}
+
+void AGTPawnMovementManager::UpdateSimCallback()
+{
+	const bool bWantsSimulation = bSimulateOnPhysicsThread && bUseHotNavWalking;
+	if (bWantsSimulation == (SimCallback != nullptr))
+	{
+		return;
+	}
+
+	if (!bWantsSimulation)
+	{
+		UnregisterSimCallback();
+		return;
+	}
+
+	FPhysScene* PhysScene = GetWorld()->GetPhysicsScene();
+	Chaos::FPhysicsSolver* Solver = PhysScene ? PhysScene->GetSolver() : nullptr;
+	if (Solver == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("No physics solver to simulate units on, they stay on the game thread"));
+		bSimulateOnPhysicsThread = false;
+		return;
+	}
+
+	SimCallback = Solver->CreateAndRegisterSimCallbackObject_External<FGTUnitMovementSimCallback>();
+	bSimHeightfieldDirty = true;
+}
+
+void AGTPawnMovementManager::UnregisterSimCallback()
+{
+	if (SimCallback == nullptr)
+	{
+		return;
+	}
+
+	FPhysScene* PhysScene = GetWorld()->GetPhysicsScene();
+	if (Chaos::FPhysicsSolver* Solver = PhysScene ? PhysScene->GetSolver() : nullptr)
+	{
+		Solver->UnregisterAndFreeSimCallbackObject_External(SimCallback);
+	}
+	SimCallback = nullptr;
+	SimHeightfield.Reset();
+	PushedSimHeightfield.Reset();
+	SimRemovedUnitIds.Reset();
+
+	// The components hold the last transform written back, the records are read from them again.
+	for (FGTUnitMovementHot& MovementState : MovementStates)
+	{
+		if (MovementState.Flags & FGTUnitMovementHot::Simulated)
+		{
+			MovementState.Flags = (MovementState.Flags & ~FGTUnitMovementHot::Simulated) | FGTUnitMovementHot::Dirty;
+		}
+	}
+}
+
+void AGTPawnMovementManager::PushSimInputs()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AGTPawnMovementManager_PushSimInputs);
+
+	FGTUnitMovementSimInput* Input = SimCallback->GetProducerInputData_External();
+	if (bSimHeightfieldDirty)
+	{
+		UNavigationSystemV1* NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+		if (const ANavigationData* NavData = NavigationSystem ? NavigationSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr)
+		{
+			GetSimHeightfield(*NavData);
+		}
+	}
+	// Staging and the fog of war can rebuild the heightfield too, so what was sent is compared rather than the dirty flag.
+	if (SimHeightfield != PushedSimHeightfield)
+	{
+		Input->Heightfield = SimHeightfield;
+		PushedSimHeightfield = SimHeightfield;
+	}
+
+	Input->RemovedUnitIds.Append(SimRemovedUnitIds);
+	SimRemovedUnitIds.Reset();
+
+	int32 NumSimulatedUnits = 0;
+	for (int32 Slot = 0; Slot < MovementStates.Num(); ++Slot)
+	{
+		FGTUnitMovementHot& MovementState = MovementStates[Slot];
+		if (!MovementState.IsNavWalking())
+		{
+			continue;
+		}
+
+		const int32 UnitId = UnitIds[Slot];
+		if (!(MovementState.Flags & FGTUnitMovementHot::Simulated))
+		{
+			MovementState.Flags |= FGTUnitMovementHot::Simulated;
+			while (SimGenerations.Num() <= UnitId)
+			{
+				SimGenerations.Add(0);
+			}
+			Input->AddedStates.Add(MovementState);
+			Input->AddedUnitIds.Add(UnitId);
+			Input->AddedGenerations.Add(++SimGenerations[UnitId]);
+		}
+
+		Input->RequestUnitIds.Add(UnitId);
+		Input->RequestedVelocities.Add(MovementState.RequestedVelocity);
+		MovementState.RequestedVelocity = FVector3f::ZeroVector;
+		++NumSimulatedUnits;
+	}
+	SET_DWORD_STAT(STAT_AGTPawnMovementManager_PhysicsThreadUnits, NumSimulatedUnits);
+}
+
+const FGTNavHeightfield* AGTPawnMovementManager::GetSimHeightfield(const ANavigationData& NavData)
+{
+	if (bSimHeightfieldDirty || !SimHeightfield.IsValid())
+	{
+		SimHeightfield = FGTNavHeightfield::Build(NavData, PhysicsThreadNavCellSize);
+		bSimHeightfieldDirty = false;
+	}
+	return SimHeightfield.Get();
+}
+
+int32 AGTPawnMovementManager::GetSimulatedSlot(int32 UnitId, uint32 Generation) const
+{
+	const int32 Slot = GetUnitSlot(UnitId);
+	if (Slot == INDEX_NONE || !(MovementStates[Slot].Flags & FGTUnitMovementHot::Simulated) || SimGenerations[UnitId] != Generation)
+	{
+		return INDEX_NONE;
+	}
+	return Slot;
+}
+
+void AGTPawnMovementManager::ApplySimOutputs()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AGTPawnMovementManager_ApplySimOutputs);
+
+	FGTFrameArenaScope ArenaScope;
+	TGTFrameArray<int32> MovedSlots;
+	TBitArray<TGTFrameAllocator<>> Moved(false, MovementStates.Num());
+
+	// Several physics steps can finish in one frame, the records keep the last report and each unit moves once.
+	while (Chaos::TSimCallbackOutputHandle<FGTUnitMovementSimOutput> Output = SimCallback->PopOutputData_External())
+	{
+		for (int32 Index = 0; Index < Output->UnitIds.Num(); ++Index)
+		{
+			const int32 Slot = GetSimulatedSlot(Output->UnitIds[Index], Output->Generations[Index]);
+			if (Slot == INDEX_NONE)
+			{
+				continue;
+			}
+
+			MovementStates[Slot].Location = Output->Locations[Index];
+			MovementStates[Slot].Velocity = Output->Velocities[Index];
+			if (!Moved[Slot])
+			{
+				Moved[Slot] = true;
+				MovedSlots.Add(Slot);
+			}
+		}
+
+		for (int32 Index = 0; Index < Output->LeftNavMeshUnitIds.Num(); ++Index)
+		{
+			const int32 Slot = GetSimulatedSlot(Output->LeftNavMeshUnitIds[Index], Output->LeftNavMeshGenerations[Index]);
+			if (Slot != INDEX_NONE)
+			{
+				// Off the navmesh, the component falls back to walking and takes the unit from here.
+				MovementStates[Slot].Flags &= ~FGTUnitMovementHot::Simulated;
+				if (UGTCharacterMovementComponent* MovementComponent = MovementComponents[Slot])
+				{
+					MovementComponent->SetMovementMode(MOVE_Walking);
+				}
+				else
+				{
+					MovementStates[Slot].Velocity = FVector3f::ZeroVector;
+				}
+			}
+		}
+	}
+
+	for (const int32 Slot : MovedSlots)
+	{
+		const FGTUnitMovementHot& MovementState = MovementStates[Slot];
+		UGTCharacterMovementComponent* MovementComponent = MovementComponents[Slot];
+		if (!(MovementState.Flags & FGTUnitMovementHot::Simulated) || MovementComponent == nullptr)
+		{
+			continue;
+		}
+
+		const FVector Delta = FVector(MovementState.Location) - MovementComponent->GetActorFeetLocation();
+		if (!Delta.IsNearlyZero())
+		{
+			const FRotator NewRotation = MovementState.Velocity.IsZero()
+				? MovementComponent->UpdatedComponent->GetComponentRotation()
+				: FRotator(0.f, FMath::RadiansToDegrees(FMath::Atan2(MovementState.Velocity.Y, MovementState.Velocity.X)), 0.f);
+			MovementComponent->UpdatedComponent->MoveComponent(Delta, NewRotation, false, nullptr, MovementComponent->MoveComponentFlags, ETeleportType::ResetPhysics);
+		}
+		MovementComponent->Velocity = FVector(MovementState.Velocity);
+	}
+}
+
+void AGTPawnMovementManager::CompactPathBuffers()
+{
+	FGTFrameArenaScope ArenaScope;
+	if (WaypointPool.NeedsCompaction())
+	{
+		TGTFrameArray<FGTPathSpan*> LiveSpans;
+		LiveSpans.Reserve(PathStates.Num());
+		for (FGTPathFollowState& PathState : PathStates)
+		{
+			if (PathState.Waypoints.IsSet())
+			{
+				LiveSpans.Add(&PathState.Waypoints);
+			}
+		}
+		WaypointPool.Compact(LiveSpans);
+	}
+
+	if (CorridorPool.NeedsCompaction())
+	{
+		TGTFrameArray<FGTPathSpan*> LiveSpans;
+		LiveSpans.Reserve(PathStates.Num());
+		for (FGTPathFollowState& PathState : PathStates)
+		{
+			if (PathState.Corridor.IsSet())
+			{
+				LiveSpans.Add(&PathState.Corridor);
+			}
+		}
+		CorridorPool.Compact(LiveSpans);
+	}
+
+	if (RoutePool.NeedsCompaction())
+	{
+		TGTFrameArray<FGTPathSpan*> LiveSpans;
+		LiveSpans.Reserve(PathStates.Num());
+		for (FGTPathFollowState& PathState : PathStates)
+		{
+			if (PathState.Route.IsSet())
+			{
+				LiveSpans.Add(&PathState.Route);
+			}
+		}
+		RoutePool.Compact(LiveSpans);
+	}
+
+	if (OrderQueuePool.NeedsCompaction())
+	{
+		TGTFrameArray<FGTPathSpan*> LiveSpans;
+		LiveSpans.Reserve(OrderStates.Num());
+		for (FGTUnitOrderState& OrderState : OrderStates)
+		{
+			if (OrderState.QueuedWaypoints.IsSet())
+			{
+				LiveSpans.Add(&OrderState.QueuedWaypoints);
+			}
+		}
+		OrderQueuePool.Compact(LiveSpans);
+	}
+}
+
+namespace GTPawnMovementManager
+{
+	/** Reorders Array so the element at slot Order[Index] ends up at Index. */
+	template<typename ElementType, typename AllocatorType>
+	void ApplySlotOrder(TArray<ElementType, AllocatorType>& Array, TConstArrayView<int32> Order)
+	{
+		FGTFrameArenaScope ArenaScope;
+		TGTFrameArray<ElementType> Sorted;
+		Sorted.Reserve(Array.Num());
+		for (const int32 Slot : Order)
+		{
+			Sorted.Add(MoveTemp(Array[Slot]));
+		}
+		for (int32 Index = 0; Index < Sorted.Num(); ++Index)
+		{
+			Array[Index] = MoveTemp(Sorted[Index]);
+		}
+	}
+}
+
+int32 AGTPawnMovementManager::GetSpatialSlotOrder(TConstArrayView<FGTUnitMovementHot> MovementStates, float CellSize, TArrayView<int32> OutSlotOrder)
+{
+	check(OutSlotOrder.Num() == MovementStates.Num());
+
+	// Cells are counted from a fixed origin so a unit that did not move keeps its key between sorts.
+	// Z-order key in the high bits and slot in the low bits, so equal cells stay in slot order.
+	FGTFrameArenaScope ArenaScope;
+	TGTFrameArray<uint64> SpatialSortKeys;
+	SpatialSortKeys.SetNumUninitialized(MovementStates.Num());
+	const float InvCellSize = 1.f / FMath::Max(CellSize, 1.f);
+	constexpr int32 HalfRange = MAX_uint16 / 2;
+	for (int32 Slot = 0; Slot < MovementStates.Num(); ++Slot)
+	{
+		const FVector3f& Location = MovementStates[Slot].Location;
+		const uint32 X = FMath::Clamp(FMath::FloorToInt(Location.X * InvCellSize) + HalfRange, 0, static_cast<int32>(MAX_uint16));
+		const uint32 Y = FMath::Clamp(FMath::FloorToInt(Location.Y * InvCellSize) + HalfRange, 0, static_cast<int32>(MAX_uint16));
+		const uint32 MortonKey = FMath::MortonCode2(X) | (FMath::MortonCode2(Y) << 1);
+		SpatialSortKeys[Slot] = static_cast<uint64>(MortonKey) << 32 | static_cast<uint32>(Slot);
+	}
+	Algo::Sort(SpatialSortKeys);
+
+	int32 NumMoved = 0;
+	for (int32 Index = 0; Index < SpatialSortKeys.Num(); ++Index)
+	{
+		OutSlotOrder[Index] = static_cast<int32>(SpatialSortKeys[Index] & MAX_uint32);
+		NumMoved += OutSlotOrder[Index] != Index ? 1 : 0;
+	}
+	return NumMoved;
+}
+
+int32 AGTPawnMovementManager::AllocateUnitId()
+{
+	if (FreeUnitIds.Num() > 0)
+	{
+		return FreeUnitIds.Pop(false);
+	}
+	UnitIdGenerations.Add(0);
+	return UnitSlots.Add(INDEX_NONE);
+}
+
+void AGTPawnMovementManager::SortUnitsSpatially()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AGTPawnMovementManager_SortUnitsSpatially);
+	const int32 NumUnits = MovementComponents.Num();
+	if (NumUnits < 2)
+	{
+		return;
+	}
+
+	FGTFrameArenaScope ArenaScope;
+	TGTFrameArray<int32> SlotOrder;
+	SlotOrder.SetNumUninitialized(NumUnits);
+	const int32 NumMoved = GetSpatialSlotOrder(MovementStates, SpatialSortCellSize, SlotOrder);
+	INC_DWORD_STAT_BY(STAT_AGTPawnMovementManager_UnitsMovedBySort, NumMoved);
+	if (NumMoved == 0)
+	{
+		return;
+	}
+
+	// Every per-unit row moves together, unit ids stay the same and only their slots change.
+	GTPawnMovementManager::ApplySlotOrder(MovementComponents, SlotOrder);
+	GTPawnMovementManager::ApplySlotOrder(UnitIds, SlotOrder);
+	GTPawnMovementManager::ApplySlotOrder(PathStates, SlotOrder);
+	GTPawnMovementManager::ApplySlotOrder(OrderStates, SlotOrder);
+	GTPawnMovementManager::ApplySlotOrder(MovementStates, SlotOrder);
+	GTPawnMovementManager::ApplySlotOrder(UnitBodies, SlotOrder);
+	GTPawnMovementManager::ApplySlotOrder(Significances, SlotOrder);
+	GTPawnMovementManager::ApplySlotOrder(UnitAnimations, SlotOrder);
+	GTPawnMovementManager::ApplySlotOrder(UnitProxies, SlotOrder);
+	GTPawnMovementManager::ApplySlotOrder(UnitEntities, SlotOrder);
+	GTPawnMovementManager::ApplySlotOrder(UnitTargets, SlotOrder);
+	for (int32 Slot = 0; Slot < NumUnits; ++Slot)
+	{
+		UnitSlots[UnitIds[Slot]] = Slot;
+	}
+}
+
+FGTGroundQuery& AGTPawnMovementManager::GetGroundQuery()
+{
+	if (!GroundQuery.IsInitialized())
+	{
+		UNavigationSystemV1* NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+		if (const ANavigationData* NavData = NavigationSystem ? NavigationSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr)
+		{
+			GroundQuery.Initialize(*GetWorld(), *NavData);
+		}
+	}
+	return GroundQuery;
+}
+
+void AGTPawnMovementManager::UpdateUnitGrid()
+{
+	FGTFrameArenaScope ArenaScope;
+	TGTFrameArray<FVector> UnitLocations;
+	UnitLocations.SetNumUninitialized(MovementComponents.Num());
+	for (int32 Slot = 0; Slot < MovementComponents.Num(); ++Slot)
+	{
+		UnitLocations[Slot] = FVector(MovementStates[Slot].Location);
+	}
+
+	UnitGrid.CellSize = UnitGridCellSize;
+	UnitGrid.Build(UnitLocations, UnitIds);
+}
+
+void AGTPawnMovementManager::UpdateCrowdDensity()
+{
+	if (!bUseCongestionCosts)
+	{
+		return;
+	}
+
+	if (!CrowdDensity->IsInitialized())
+	{
+		UNavigationSystemV1* NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+		const ANavigationData* NavData = NavigationSystem ? NavigationSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+		if (NavData == nullptr)
+		{
+			return;
+		}
+		CrowdDensity->CellSize = CongestionCellSize;
+		CrowdDensity->Initialize(NavData->GetBounds());
+	}
+
+	FGTFrameArenaScope ArenaScope;
+	TGTFrameArray<FVector2f> UnitLocations;
+	UnitLocations.SetNumUninitialized(MovementStates.Num());
+	for (int32 Slot = 0; Slot < MovementStates.Num(); ++Slot)
+	{
+		UnitLocations[Slot] = FVector2f(MovementStates[Slot].Location.X, MovementStates[Slot].Location.Y);
+	}
+
+	CrowdDensity->CostPerUnit = CongestionCostPerUnit;
+	CrowdDensity->Update(UnitLocations, GetWorld()->GetDeltaSeconds());
+}
+
+void AGTPawnMovementManager::UpdateFogOfWar()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AGTPawnMovementManager_UpdateFogOfWar);
+	if (!bUpdateFogOfWar)
+	{
+		FogOfWar.Reset();
+		return;
+	}
+
+	if (!FogOfWar.IsInitialized())
+	{
+		UNavigationSystemV1* NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+		const ANavigationData* NavData = NavigationSystem ? NavigationSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+		if (NavData == nullptr)
+		{
+			return;
+		}
+		FogOfWar.CellSize = FogOfWarCellSize;
+		FogOfWar.BlockingHeight = FogOfWarBlockingHeight;
+		FogOfWar.Initialize(NavData->GetBounds(), GetSimHeightfield(*NavData));
+	}
+
+	// Units that stayed in their cell are a compare each, only those that crossed one are stamped again.
+	int32 NumRestamped = 0;
+	for (int32 Slot = 0; Slot < MovementStates.Num(); ++Slot)
+	{
+		const FVector Location(MovementStates[Slot].Location);
+		NumRestamped += FogOfWar.UpdateViewer(UnitIds[Slot], Location, UnitBodies[Slot].TeamId, UnitSightRadius) ? 1 : 0;
+	}
+	INC_DWORD_STAT_BY(STAT_AGTPawnMovementManager_FogRestampedUnits, NumRestamped);
+}
+
+void AGTPawnMovementManager::UpdateTargets()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AGTPawnMovementManager_UpdateTargets);
+	if (!bAcquireTargets)
+	{
+		return;
+	}
+
+	FGTFrameArenaScope ArenaScope;
+	TGTFrameArray<FGTTargetingBody> Bodies;
+	Bodies.SetNumUninitialized(MovementStates.Num());
+	int32 NumSearching = 0;
+	for (int32 Slot = 0; Slot < MovementStates.Num(); ++Slot)
+	{
+		FGTTargetingBody& Body = Bodies[Slot];
+		Body.Position = FVector2f(MovementStates[Slot].Location.X, MovementStates[Slot].Location.Y);
+		Body.TeamId = UnitBodies[Slot].TeamId;
+
+		// Staggered by unit id like the movement updates, so a bucket's searches are spread over its interval.
+		const uint32 Interval = static_cast<uint32>(FMath::Max(GetBudget(Significances[Slot].Bucket).TargetingInterval, 1));
+		const bool bDue = (FrameNumber + static_cast<uint32>(UnitIds[Slot])) % Interval == 0;
+		Body.bSearching = Body.TeamId != FGenericTeamId::NoTeam && (bDue || (UnitTargets[Slot].UnitId != INDEX_NONE && !HasValidTarget(Slot)));
+		NumSearching += Body.bSearching ? 1 : 0;
+	}
+
+	TGTFrameArray<int32> Targets;
+	Targets.SetNumUninitialized(Bodies.Num());
+	TargetAcquisition.Range = TargetAcquisitionRange;
+	TargetAcquisition.CellSize = TargetGridCellSize;
+	TargetAcquisition.Acquire(Bodies, Targets);
+
+	int32 NumWithTarget = 0;
+	for (int32 Slot = 0; Slot < Bodies.Num(); ++Slot)
+	{
+		if (Bodies[Slot].bSearching)
+		{
+			const int32 TargetId = Targets[Slot] != INDEX_NONE ? UnitIds[Targets[Slot]] : INDEX_NONE;
+			UnitTargets[Slot] = {TargetId, TargetId != INDEX_NONE ? UnitIdGenerations[TargetId] : 0};
+		}
+		NumWithTarget += UnitTargets[Slot].UnitId != INDEX_NONE ? 1 : 0;
+	}
+	SET_DWORD_STAT(STAT_AGTPawnMovementManager_TargetSearches, NumSearching);
+	SET_DWORD_STAT(STAT_AGTPawnMovementManager_UnitsWithTarget, NumWithTarget);
+}
+
+FSharedConstNavQueryFilter AGTPawnMovementManager::GetPathFilter(const ANavigationData& NavData)
+{
+#if WITH_RECAST
+	// The density is per navmesh area, only recast polys have the cost hook the filter needs.
+	if (!bUseCongestionCosts || !CrowdDensity->IsInitialized() || !NavData.IsA<ARecastNavMesh>())
+	{
+		return nullptr;
+	}
+
+	if (!CongestionFilter.IsValid() || CongestionFilterNavData.Get() != &NavData)
+	{
+		const FSharedConstNavQueryFilter DefaultFilter = NavData.GetDefaultQueryFilter();
+		if (!DefaultFilter.IsValid() || DefaultFilter->GetImplementation() == nullptr)
+		{
+			return nullptr;
+		}
+
+		// The navigation filter keeps its own copy of the implementation, which shares CrowdDensity.
+		const FGTCongestionQueryFilter Implementation(*static_cast<const FRecastQueryFilter*>(DefaultFilter->GetImplementation()), CrowdDensity);
+		const FSharedNavQueryFilter Filter = DefaultFilter->GetCopy();
+		Filter->SetFilterImplementation(&Implementation);
+		CongestionFilter = Filter;
+		CongestionFilterNavData = &NavData;
+	}
+	return CongestionFilter;
+#else
+	return nullptr;
+#endif
+}
+
+void AGTPawnMovementManager::UpdateSignificance()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AGTPawnMovementManager_UpdateSignificance);
+
+	// Unit counts are kept up as units come, go and change buckets. They are only counted again when the budgets were
+	// resized, which also moves units of a removed bucket into the last one left.
+	const int32 NumBuckets = FMath::Max(SignificanceBudgets.Num(), 1);
+	if (SignificanceUsage.Num() != NumBuckets)
+	{
+		SignificanceUsage.Reset();
+		SignificanceUsage.SetNum(NumBuckets);
+		for (FGTUnitSignificance& Significance : Significances)
+		{
+			Significance.Bucket = static_cast<uint8>(FMath::Min(static_cast<int32>(Significance.Bucket), NumBuckets - 1));
+			++SignificanceUsage[Significance.Bucket].Units;
+		}
+	}
+	for (FGTSignificanceBucketUsage& Usage : SignificanceUsage)
+	{
+		Usage.OverflowedUnits = 0;
+		Usage.MovementUpdates = 0;
+	}
+
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	if (Significances.Num() == 0 || PlayerController == nullptr || !SignificanceScorer.SetView(*PlayerController))
+	{
+		return;
+	}
+
+	SignificanceScorer.ScreenSizeWeight = ScreenSizeSignificance;
+	SignificanceScorer.SelectedBonus = SelectedSignificance;
+	SignificanceScorer.CombatBonus = CombatSignificance;
+	SignificanceScorer.OwnedBonus = OwnedSignificance;
+
+	// Slots rather than ids are walked, a unit the spatial sort moves may be scored twice or wait a round longer.
+	const FGenericTeamId PlayerTeamId = FGenericTeamId::GetTeamIdentifier(PlayerController);
+	const double Now = GetWorld()->GetTimeSeconds();
+	const int32 NumToRescore = FMath::DivideAndRoundUp(Significances.Num(), FMath::Max(SignificanceRescoreFrames, 1));
+	for (int32 Count = 0; Count < NumToRescore; ++Count)
+	{
+		SignificanceCursor = SignificanceCursor < Significances.Num() ? SignificanceCursor : 0;
+		RescoreUnit(SignificanceCursor++, PlayerTeamId, Now);
+	}
+	INC_DWORD_STAT_BY(STAT_AGTPawnMovementManager_RescoredUnits, NumToRescore);
+}
+
+void AGTPawnMovementManager::AddSignificanceUsage(int32 Bucket, int32 Units)
+{
+	// Until the first UpdateSignificance sizes the usage, or after the budgets were resized, it is counted there instead.
+	if (SignificanceUsage.IsValidIndex(Bucket) && SignificanceUsage.Num() == FMath::Max(SignificanceBudgets.Num(), 1))
+	{
+		SignificanceUsage[Bucket].Units += Units;
+	}
+}
+
+void AGTPawnMovementManager::RescoreUnit(int32 Slot, const FGenericTeamId& PlayerTeamId, double Now)
+{
+	FGTUnitSignificance& Significance = Significances[Slot];
+	FGTSignificanceFactors Factors;
+	Factors.Location = FVector(MovementStates[Slot].Location);
+	Factors.Radius = UnitBodies[Slot].Radius;
+	Factors.bSelected = Significance.bSelected;
+	Factors.bInCombat = OrderStates[Slot].bAttackMove || Now - Significance.LastCombatTime < CombatSignificanceTime;
+	Factors.bOwnedByPlayer = PlayerTeamId != FGenericTeamId::NoTeam && UnitBodies[Slot].TeamId == PlayerTeamId;
+	Significance.Score = SignificanceScorer.Score(Factors);
+
+	--SignificanceUsage[Significance.Bucket].Units;
+	int32 Overflowed;
+	Significance.Bucket = static_cast<uint8>(FGTSignificanceScorer::PickBucket(SignificanceBudgets, SignificanceUsage, Significance.Score, Overflowed));
+	++SignificanceUsage[Significance.Bucket].Units;
+	if (Overflowed != INDEX_NONE)
+	{
+		++SignificanceUsage[Overflowed].OverflowedUnits;
+	}
+
+	// The bucket owns the unit's avoidance. RVO takes the unit off the hot nav walking update until it drops out again.
+	UGTCharacterMovementComponent* MovementComponent = MovementComponents[Slot];
+	const ACharacter* CharacterOwner = MovementComponent ? MovementComponent->GetCharacterOwner() : nullptr;
+	const bool bWantsRVOAvoidance = GetBudget(Significance.Bucket).Avoidance == EGTAvoidanceQuality::RVO;
+	if (CharacterOwner && MovementComponent->bUseRVOAvoidance != bWantsRVOAvoidance && !CharacterOwner->IsPlayerControlled())
+	{
+		MovementComponent->SetAvoidanceEnabled(bWantsRVOAvoidance);
+		MovementStates[Slot].Flags |= FGTUnitMovementHot::Dirty;
+	}
+}
+
+void AGTPawnMovementManager::UpdateCrowdAnimation()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AGTPawnMovementManager_UpdateCrowdAnimation);
+	if (!bAnimateCrowd)
+	{
+		return;
+	}
+
+	// Runs after the move, so the state follows the velocity the unit was just given. Phases come from ids rather than
+	// slots, the spatial sort would otherwise move units between leaders.
+	const int32 NumPhaseBuckets = FMath::Max(AnimationPhaseBuckets, 1);
+	int32 OwnAnimationUnits = 0;
+	int32 SharedAnimationUnits = 0;
+	for (int32 Slot = 0; Slot < UnitAnimations.Num(); ++Slot)
+	{
+		FGTUnitAnimation& UnitAnimation = UnitAnimations[Slot];
+		if (!IsValid(UnitAnimation.Mesh) || UnitProxies[Slot].IsProxy())
+		{
+			continue;
+		}
+
+		const FGTSignificanceBudget& Budget = GetBudget(Significances[Slot].Bucket);
+		if (Budget.bShareAnimation)
+		{
+			CrowdAnimation.SetSharedAnimation(UnitAnimation, GetCrowdAnimState(MovementComponents[Slot]->Velocity), UnitIds[Slot] % NumPhaseBuckets, *this);
+		}
+		else
+		{
+			CrowdAnimation.SetOwnAnimation(UnitAnimation, Budget.AnimationUpdateRate);
+		}
+		++(UnitAnimation.Leader != INDEX_NONE ? SharedAnimationUnits : OwnAnimationUnits);
+	}
+
+	// Pawn units have no significance of their own, they are the cheap kind and always share.
+	for (int32 Index = 0; Index < PawnAnimations.Num(); ++Index)
+	{
+		FGTUnitAnimation& PawnAnimation = PawnAnimations[Index];
+		if (IsValid(PawnAnimation.Mesh))
+		{
+			const UGTPawnMovementComponent* MovementComponent = PawnMovementComponents[Index];
+			CrowdAnimation.SetSharedAnimation(PawnAnimation, GetCrowdAnimState(MovementComponent->Velocity), MovementComponent->GetUniqueID() % NumPhaseBuckets, *this);
+			SharedAnimationUnits += PawnAnimation.Leader != INDEX_NONE ? 1 : 0;
+		}
+	}
+
+	SET_DWORD_STAT(STAT_AGTPawnMovementManager_OwnAnimationUnits, OwnAnimationUnits);
+	SET_DWORD_STAT(STAT_AGTPawnMovementManager_SharedAnimationUnits, SharedAnimationUnits);
+	SET_DWORD_STAT(STAT_AGTPawnMovementManager_AnimationLeaders, CrowdAnimation.GetLeaders().Num());
+}
+
+void AGTPawnMovementManager::UpdateUnitProxies()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AGTPawnMovementManager_UpdateUnitProxies);
+
+	// Runs before the crowd animation, which leaves proxies alone and picks up units that just got their mesh back.
+	int32 NumProxies = 0;
+	int32 NumRegisteredMeshes = 0;
+	for (int32 Slot = 0; Slot < UnitProxies.Num(); ++Slot)
+	{
+		// Entity units without an actor are always drawn as proxies.
+		FGTUnitProxy& UnitProxy = UnitProxies[Slot];
+		const bool bHasMesh = IsValid(UnitProxy.Mesh);
+		const bool bWantsProxy = bDrawUnitProxies && GetBudget(Significances[Slot].Bucket).bDrawAsProxy;
+		if (bHasMesh && bWantsProxy && !UnitProxy.IsProxy())
+		{
+			if (UStaticMesh* ProxyMesh = GetUnitProxyMesh(*UnitProxy.Mesh->GetOwner()->GetClass()))
+			{
+				CrowdAnimation.Release(UnitAnimations[Slot]);
+				ProxyMeshes.SetProxy(UnitProxy, *ProxyMesh, *this);
+			}
+		}
+		else if (bHasMesh && !bWantsProxy && UnitProxy.IsProxy())
+		{
+			ProxyMeshes.SetFullActor(UnitProxy);
+		}
+		else if (!bHasMesh && (!bDrawUnitProxies || !UnitEntities[Slot].IsEntity()))
+		{
+			continue;
+		}
+
+		if (UnitProxy.IsProxy())
+		{
+			const FGTUnitMovementHot& MovementState = MovementStates[Slot];
+			if (!MovementState.Velocity.IsNearlyZero())
+			{
+				UnitProxy.Yaw = FMath::RadiansToDegrees(FMath::Atan2(MovementState.Velocity.Y, MovementState.Velocity.X));
+			}
+			ProxyMeshes.AddInstance(UnitProxy, FVector(MovementState.Location));
+			++NumProxies;
+		}
+		else if (bHasMesh)
+		{
+			NumRegisteredMeshes += UnitProxy.Mesh->IsRegistered() ? 1 : 0;
+		}
+	}
+	ProxyMeshes.CommitInstances();
+
+	SET_DWORD_STAT(STAT_AGTPawnMovementManager_ProxyUnits, NumProxies);
+	SET_DWORD_STAT(STAT_AGTPawnMovementManager_RegisteredUnitMeshes, NumRegisteredMeshes);
+}
+
+UStaticMesh* AGTPawnMovementManager::GetUnitProxyMesh(const UClass& UnitClass) const
+{
+	UStaticMesh* const* ProxyMesh = LoadedUnitProxyMeshes.Find(&UnitClass);
+	return ProxyMesh ? *ProxyMesh : LoadedDefaultUnitProxyMesh;
+}
+
+EGTCrowdAnimState AGTPawnMovementManager::GetCrowdAnimState(const FVector& Velocity) const
+{
+	return Velocity.SizeSquared2D() > FMath::Square(JogAnimationSpeed) ? EGTCrowdAnimState::Jog : EGTCrowdAnimState::Idle;
+}
+
+void AGTPawnMovementManager::UpdateEntityHydration()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AGTPawnMovementManager_UpdateEntityHydration);
+	if (!bHydrateEntities)
+	{
+		return;
+	}
+
+	// Every player's view point, remote players' too on a server, so the units near them are actors that replicate.
+	FGTFrameArenaScope ArenaScope;
+	TGTFrameArray<FVector2D> ViewLocations;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APlayerController* PlayerController = It->Get())
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+			ViewLocations.Add(FVector2D(ViewLocation));
+		}
+	}
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	const double HydrationDistanceSquared = FMath::Square(EntityHydrationDistance);
+	int32 NumEntities = 0;
+	int32 NumHydrated = 0;
+	int32 NumHydrations = 0;
+	int32 NumDehydrations = 0;
+	for (int32 Slot = 0; Slot < UnitEntities.Num(); ++Slot)
+	{
+		FGTUnitEntity& UnitEntity = UnitEntities[Slot];
+		if (!UnitEntity.IsEntity())
+		{
+			continue;
+		}
+		++NumEntities;
+
+		const FGTUnitSignificance& Significance = Significances[Slot];
+		bool bNeedsActor = GetBudget(Significance.Bucket).bNeedsActor || OrderStates[Slot].bAttackMove || Now - Significance.LastCombatTime < CombatSignificanceTime;
+		const FVector2D Location(MovementStates[Slot].Location.X, MovementStates[Slot].Location.Y);
+		for (int32 Index = 0; !bNeedsActor && Index < ViewLocations.Num(); ++Index)
+		{
+			bNeedsActor = FVector2D::DistSquared(Location, ViewLocations[Index]) < HydrationDistanceSquared;
+		}
+
+		const UGTCharacterMovementComponent* MovementComponent = MovementComponents[Slot];
+		const ACharacter* CharacterOwner = MovementComponent ? MovementComponent->GetCharacterOwner() : nullptr;
+		bNeedsActor |= CharacterOwner && CharacterOwner->IsPlayerControlled();
+		if (bNeedsActor)
+		{
+			UnitEntity.LastNeededTime = Now;
+		}
+
+		if (MovementComponent == nullptr && bNeedsActor && NumHydrations < MaxEntityHydrationsPerFrame)
+		{
+			HydrateUnit(Slot);
+			++NumHydrations;
+		}
+		else if (MovementComponent && !bNeedsActor && Now - UnitEntity.LastNeededTime > EntityDehydrationDelay && NumDehydrations < MaxEntityHydrationsPerFrame)
+		{
+			DehydrateUnit(Slot);
+			++NumDehydrations;
+		}
+		NumHydrated += MovementComponents[Slot] != nullptr ? 1 : 0;
+	}
+
+	SET_DWORD_STAT(STAT_AGTPawnMovementManager_EntityUnits, NumEntities);
+	SET_DWORD_STAT(STAT_AGTPawnMovementManager_HydratedEntityUnits, NumHydrated);
+	INC_DWORD_STAT_BY(STAT_AGTPawnMovementManager_EntityHydrations, NumHydrations);
+	INC_DWORD_STAT_BY(STAT_AGTPawnMovementManager_EntityDehydrations, NumDehydrations);
+}
+
+void AGTPawnMovementManager::HydrateUnit(int32 Slot)
+{
+	UClass* ActorClass = UnitEntities[Slot].ActorClass;
+	const ACharacter* DefaultCharacter = ActorClass->GetDefaultObject<ACharacter>();
+	const FVector Location = FVector(MovementStates[Slot].Location) + FVector(0.f, 0.f, DefaultCharacter->GetCapsuleComponent()->GetScaledCapsuleHalfHeight());
+	const FTransform SpawnTransform(FRotator(0.f, UnitProxies[Slot].Yaw, 0.f), Location);
+	ACharacter* Character = GetWorld()->SpawnActorDeferred<ACharacter>(ActorClass, SpawnTransform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+	if (Character == nullptr)
+	{
+		return;
+	}
+
+	// The movement component registers from BeginPlay, inside FinishSpawning, and takes over the unit's row there.
+	const int32 UnitId = UnitIds[Slot];
+	HydratingActor = Character;
+	HydratingUnitId = UnitId;
+	Character->FinishSpawning(SpawnTransform);
+	HydratingActor = nullptr;
+	HydratingUnitId = INDEX_NONE;
+
+	const int32 HydratedSlot = GetUnitSlot(UnitId);
+	UGTCharacterMovementComponent* MovementComponent = HydratedSlot != INDEX_NONE ? MovementComponents[HydratedSlot] : nullptr;
+	if (MovementComponent == nullptr || MovementComponent->GetOwner() != Character)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s did not take over unit %d, the unit stays without an actor"), *GetNameSafe(Character), UnitId);
+		Character->Destroy();
+		return;
+	}
+
+	if (Character->GetController() == nullptr)
+	{
+		Character->SpawnDefaultController();
+	}
+	if (IGenericTeamAgentInterface* TeamAgent = Cast<IGenericTeamAgentInterface>(Character->GetController()))
+	{
+		TeamAgent->SetGenericTeamId(UnitBodies[HydratedSlot].TeamId);
+	}
+	// The unit walked the navmesh as an entity, it carries on the same way with the velocity it had.
+	MovementComponent->SetMovementMode(MOVE_NavWalking);
+	MovementComponent->Velocity = FVector(MovementStates[HydratedSlot].Velocity);
+}
+
+void AGTPawnMovementManager::DehydrateUnit(int32 Slot)
+{
+	// The hot record takes over from the component, read again first if the component moved the unit on its own.
+	if (MovementStates[Slot].Flags & FGTUnitMovementHot::Dirty)
+	{
+		SyncMovementState(Slot);
+	}
+
+	UGTCharacterMovementComponent* MovementComponent = MovementComponents[Slot];
+	ACharacter* Character = MovementComponent->GetCharacterOwner();
+	CrowdAnimation.Release(UnitAnimations[Slot]);
+	UnitAnimations[Slot].Mesh = nullptr;
+
+	FGTUnitProxy& UnitProxy = UnitProxies[Slot];
+	UStaticMesh* ProxyMesh = UnitProxy.IsProxy() ? nullptr : GetUnitProxyMesh(*Character->GetClass());
+	if (ProxyMesh)
+	{
+		UnitProxy.Type = ProxyMeshes.FindOrAddType(*ProxyMesh, *this);
+		UnitProxy.MeshTransform = Character->GetMesh()->GetRelativeTransform();
+		UnitProxy.Yaw = Character->GetActorRotation().Yaw;
+	}
+	UnitProxy.Mesh = nullptr;
+
+	// Cut loose before the actor goes, so its component ending play does not remove the unit.
+	MovementComponents[Slot] = nullptr;
+	MovementComponent->UnitId = INDEX_NONE;
+	MovementStates[Slot].Flags = (MovementStates[Slot].Flags & FGTUnitMovementHot::Simulated) | FGTUnitMovementHot::NavWalking;
+	if (AController* Controller = Character->GetController())
+	{
+		Controller->Destroy();
+	}
+	Character->Destroy();
+}
+
+const UGTCharacterMovementComponent* AGTPawnMovementManager::GetPathQuerier(int32 Slot) const
+{
+	if (const UGTCharacterMovementComponent* MovementComponent = MovementComponents[Slot])
+	{
+		return MovementComponent;
+	}
+	return Cast<UGTCharacterMovementComponent>(UnitEntities[Slot].ActorClass->GetDefaultObject<ACharacter>()->GetCharacterMovement());
+}
+
+FVector AGTPawnMovementManager::GetUnitFeetLocation(int32 Slot) const
+{
+	const UGTCharacterMovementComponent* MovementComponent = MovementComponents[Slot];
+	return MovementComponent ? MovementComponent->GetActorFeetLocation() : FVector(MovementStates[Slot].Location);
+}
+
+void AGTPawnMovementManager::OnNavigationGenerationFinished(ANavigationData* NavData)
+{
+	if (NavData)
+	{
+		DetectBrokenPaths(*NavData);
+		GroundQuery.Invalidate();
+		bSimHeightfieldDirty = true;
+		// The navmesh may have grown, the density and fog of war grids are laid out again over its new bounds.
+		CrowdDensity->Initialize(FBox(ForceInit));
+		CongestionFilter.Reset();
+		FogOfWar.Reset();
+	}
+}
+
+void AGTPawnMovementManager::OnPawnControllerChanged(APawn* Pawn, AController* Controller)
+{
+	if (const UGTCharacterMovementComponent* MovementComponent = Pawn ? Cast<UGTCharacterMovementComponent>(Pawn->GetMovementComponent()) : nullptr)
+	{
+		MarkMovementStateDirty(MovementComponent->GetUnitId());
+	}
+}
+
+void AGTPawnMovementManager::DetectBrokenPaths(const ANavigationData& NavData)
+{
+	// Rebuilt tiles hand out new poly refs, so any corridor holding a stale ref crosses one of them.
+	for (int32 Slot = 0; Slot < PathStates.Num(); ++Slot)
+	{
+		const FGTPathFollowState& PathState = PathStates[Slot];
+		if (!PathState.IsActive() || PendingRepairSet.Contains(UnitIds[Slot]))
+		{
+			continue;
+		}
+
+		for (const NavNodeRef PolyRef : CorridorPool.GetView(PathState.Corridor))
+		{
+			if (!NavData.IsNodeRefValid(PolyRef))
+			{
+				PendingRepairs.Add(UnitIds[Slot]);
+				PendingRepairSet.Add(UnitIds[Slot]);
+				break;
+			}
+		}
+	}
+}
+
+void AGTPawnMovementManager::ProcessPathRepairs()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AGTPawnMovementManager_ProcessPathRepairs);
+	SET_DWORD_STAT(STAT_AGTPawnMovementManager_PendingRepairs, PendingRepairs.Num());
+	if (PendingRepairs.Num() == 0)
+	{
+		return;
+	}
+
+	UNavigationSystemV1* NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	const ANavigationData* NavData = NavigationSystem ? NavigationSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+	if (NavData == nullptr)
+	{
+		return;
+	}
+
+	const double EndTime = FPlatformTime::Seconds() + PathRepairBudgetMs * 0.001;
+	int32 NumProcessed = 0;
+	while (NumProcessed < PendingRepairs.Num() && (NumProcessed == 0 || FPlatformTime::Seconds() < EndTime))
+	{
+		const int32 UnitId = PendingRepairs[NumProcessed++];
+		PendingRepairSet.Remove(UnitId);
+
+		const int32 Slot = GetUnitSlot(UnitId);
+		if (Slot == INDEX_NONE || !PathStates[Slot].IsActive())
+		{
+			continue;
+		}
+
+		if (RepairPath(Slot, *NavData))
+		{
+			INC_DWORD_STAT(STAT_AGTPawnMovementManager_LocalRepairs);
+			continue;
+		}
+
+		// No local way around the change, fall back to a full search to the same goal.
+		const FGTPathFollowState& PathState = PathStates[Slot];
+		const FVector Goal = PathState.HasRouteLeft() ? RoutePool.GetView(PathState.Route).Last() : WaypointPool.GetView(PathState.Waypoints).Last().Location;
+		RequestMove(UnitId, Goal, PathState.AcceptanceRadius);
+		INC_DWORD_STAT(STAT_AGTPawnMovementManager_FullRepaths);
+	}
+	PendingRepairs.RemoveAt(0, NumProcessed, false);
+}
+
+bool AGTPawnMovementManager::RepairPath(int32 Slot, const ANavigationData& NavData)
+{
+	const FGTPathFollowState& PathState = PathStates[Slot];
+	const TConstArrayView<FGTPathWaypoint> Waypoints = WaypointPool.GetView(PathState.Waypoints);
+	const TConstArrayView<NavNodeRef> Corridor = CorridorPool.GetView(PathState.Corridor);
+
+	int32 FirstBroken = INDEX_NONE;
+	int32 LastBroken = INDEX_NONE;
+	for (int32 Index = 0; Index < Corridor.Num(); ++Index)
+	{
+		if (!NavData.IsNodeRefValid(Corridor[Index]))
+		{
+			FirstBroken = FirstBroken == INDEX_NONE ? Index : FirstBroken;
+			LastBroken = Index;
+		}
+	}
+	if (FirstBroken == INDEX_NONE)
+	{
+		return true;
+	}
+
+	// Corners bracketing the broken section: the last one on a poly before it and the first one on a poly after it.
+	int32 CornerBefore = INDEX_NONE;
+	int32 CornerAfter = INDEX_NONE;
+	int32 SearchFrom = 0;
+	for (int32 Index = 0; Index < Waypoints.Num(); ++Index)
+	{
+		int32 CorridorIndex = INDEX_NONE;
+		for (int32 PolyIndex = SearchFrom; PolyIndex < Corridor.Num(); ++PolyIndex)
+		{
+			if (Corridor[PolyIndex] == Waypoints[Index].NodeRef)
+			{
+				CorridorIndex = PolyIndex;
+				SearchFrom = PolyIndex;
+				break;
+			}
+		}
+
+		if (CorridorIndex != INDEX_NONE && CorridorIndex < FirstBroken)
+		{
+			CornerBefore = Index;
+		}
+		else if (CorridorIndex != INDEX_NONE && CorridorIndex > LastBroken)
+		{
+			CornerAfter = Index;
+			break;
+		}
+	}
+
+	// The goal itself was rebuilt, the tail has to be searched again anyway.
+	if (CornerAfter == INDEX_NONE)
+	{
+		return false;
+	}
+
+	// A break ahead of the unit's current corner keeps the walked part, otherwise the repair starts where the unit stands.
+	const bool bRepairFromUnit = CornerBefore == INDEX_NONE || CornerBefore < PathState.SegmentIndex;
+	const FVector RepairStart = bRepairFromUnit ? GetUnitFeetLocation(Slot) : Waypoints[CornerBefore].Location;
+
+	UNavigationSystemV1* NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	const FPathFindingQuery Query(GetPathQuerier(Slot), NavData, RepairStart, Waypoints[CornerAfter].Location, GetPathFilter(NavData), ScratchPath);
+	const FPathFindingResult Result = NavigationSystem->FindPathSync(Query);
+	if (!Result.IsSuccessful() || Result.IsPartial())
+	{
+		return false;
+	}
+
+	ScratchPathPoints.Reset();
+	ScratchCorridor.Reset();
+	const int32 KeptCorners = bRepairFromUnit ? 0 : CornerBefore;
+	for (int32 Index = 0; Index < KeptCorners; ++Index)
+	{
+		ScratchPathPoints.Add(FNavPathPoint(Waypoints[Index].Location, Waypoints[Index].NodeRef));
+	}
+	const TArray<FNavPathPoint>& RepairPoints = Result.Path->GetPathPoints();
+	ScratchPathPoints.Append(RepairPoints.GetData(), RepairPoints.Num() - 1);
+	for (int32 Index = CornerAfter; Index < Waypoints.Num(); ++Index)
+	{
+		ScratchPathPoints.Add(FNavPathPoint(Waypoints[Index].Location, Waypoints[Index].NodeRef));
+	}
+
+	ScratchCorridor.Append(Corridor.GetData(), FirstBroken);
+	if (const FNavMeshPath* RepairNavPath = Result.Path->CastPath<FNavMeshPath>())
+	{
+		ScratchCorridor.Append(RepairNavPath->PathCorridor);
+	}
+	ScratchCorridor.Append(Corridor.GetData() + LastBroken + 1, Corridor.Num() - LastBroken - 1);
 
+	const int32 SegmentIndex = bRepairFromUnit ? 1 : PathState.SegmentIndex;
+	SetUnitPath(UnitIds[Slot], ScratchPathPoints, ScratchCorridor, PathState.AcceptanceRadius);
+	PathStates[Slot].SegmentIndex = FMath::Min(SegmentIndex, PathStates[Slot].Waypoints.Count - 1);
+	return true;
 }
 
 void AGTPawnMovementManager::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	ScratchPath = MakeShared<FNavMeshPath, ESPMode::ThreadSafe>();
+
+	// Loaded up front, a leader created before its animation would hold the reference pose.
+	CrowdAnimation.IdleAnimation = IdleAnimation.LoadSynchronous();
+	CrowdAnimation.JogAnimation = JogAnimation.LoadSynchronous();
+	CrowdAnimation.NumPhaseBuckets = AnimationPhaseBuckets;
+	CrowdAnimation.bInterpolateSkippedFrames = bInterpolateSkippedAnimation;
+
+	LoadedDefaultUnitProxyMesh = DefaultUnitProxyMesh.LoadSynchronous();
+	LoadedUnitProxyMeshes.Reset();
+	for (const TPair<TSubclassOf<AActor>, TSoftObjectPtr<UStaticMesh>>& UnitProxyMesh : UnitProxyMeshes)
+	{
+		if (UnitProxyMesh.Key)
+		{
+			LoadedUnitProxyMeshes.Add(UnitProxyMesh.Key.Get(), UnitProxyMesh.Value.LoadSynchronous());
+		}
+	}
+
+	if (UNavigationSystemV1* NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+	{
+		NavigationSystem->OnNavigationGenerationFinishedDelegate.AddDynamic(this, &AGTPawnMovementManager::OnNavigationGenerationFinished);
+	}
+
+	if (UGameInstance* GameInstance = GetGameInstance())
+	{
+		GameInstance->GetOnPawnControllerChanged().AddDynamic(this, &AGTPawnMovementManager::OnPawnControllerChanged);
+	}
+}
+
+void AGTPawnMovementManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	if (UNavigationSystemV1* NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+	{
+		NavigationSystem->OnNavigationGenerationFinishedDelegate.RemoveDynamic(this, &AGTPawnMovementManager::OnNavigationGenerationFinished);
+	}
+
+	if (UGameInstance* GameInstance = GetGameInstance())
+	{
+		GameInstance->GetOnPawnControllerChanged().RemoveDynamic(this, &AGTPawnMovementManager::OnPawnControllerChanged);
+	}
+
+	UnregisterSimCallback();
+	PathCache.Reset();
+	NavClusterGraph.Reset();
+
+	for (FGTUnitAnimation& UnitAnimation : UnitAnimations)
+	{
+		CrowdAnimation.Release(UnitAnimation);
+	}
+	for (FGTUnitAnimation& PawnAnimation : PawnAnimations)
+	{
+		CrowdAnimation.Release(PawnAnimation);
+	}
+	CrowdAnimation.Reset();
+
+	// The units outlive a manager that is destroyed on its own, they get their meshes back. Otherwise they go with it.
+	if (EndPlayReason == EEndPlayReason::Destroyed)
+	{
+		for (FGTUnitProxy& UnitProxy : UnitProxies)
+		{
+			ProxyMeshes.SetFullActor(UnitProxy);
+		}
+	}
+	ProxyMeshes.Reset();
+}
+
+void AGTPawnMovementManager::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	Super::AddReferencedObjects(InThis, Collector);
+	AGTPawnMovementManager* This = CastChecked<AGTPawnMovementManager>(InThis);
+	This->CrowdAnimation.AddReferencedObjects(Collector);
+	This->ProxyMeshes.AddReferencedObjects(Collector);
+	Collector.AddReferencedObject(This->LoadedDefaultUnitProxyMesh);
+	for (TPair<const UClass*, UStaticMesh*>& UnitProxyMesh : This->LoadedUnitProxyMeshes)
+	{
+		Collector.AddReferencedObject(UnitProxyMesh.Value);
+	}
+	for (FGTUnitEntity& UnitEntity : This->UnitEntities)
+	{
+		Collector.AddReferencedObject(UnitEntity.ActorClass);
+	}
+}
+
+void AGTPawnMovementManager::RegisterActorTickFunctions(bool bRegister)
+{
+	Super::RegisterActorTickFunctions(bRegister);
+
+	for (int32 Phase = 0; Phase < static_cast<int32>(EGTMovementPhase::Num); ++Phase)
+	{
+		FGTMovementPhaseTickFunction& TickFunction = PhaseTickFunctions[Phase];
+		if (bRegister)
+		{
+			if (PrimaryActorTick.IsTickFunctionRegistered())
+			{
+				TickFunction.Manager = this;
+				TickFunction.RegisterTickFunction(GetLevel());
+				FTickFunction& PreviousStage = Phase == 0 ? static_cast<FTickFunction&>(PrimaryActorTick) : static_cast<FTickFunction&>(PhaseTickFunctions[Phase - 1]);
+				TickFunction.AddPrerequisite(this, PreviousStage);
+			}
+		}
+		else if (TickFunction.IsTickFunctionRegistered())
+		{
+			TickFunction.UnRegisterTickFunction();
+		}
+	}
 }
 
 void AGTPawnMovementManager::Tick(float DeltaTime)
 {
+	// Gathers the inputs of the frame. The phase tick functions take the rest from here, StageNavWalking hands them the
+	// units and everything they need so the task-thread stages do not read the world.
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	TaskThreadCycles = 0;
 	Super::Tick(DeltaTime);
+	FGTFrameArena::Get().ResetPeak();
 
-	for (const auto MovementComponent : MovementComponents)
+	ApplyCommands();
+
+	for (AGTSquad* Squad : Squads)
 	{
-		MovementComponent->UpdateMovement(DeltaTime);
+		Squad->UpdateSquad(DeltaTime);
+	}
+
+	UpdateNavClusterGraph();
+	ProcessPathRepairs();
+
+	if (bSortUnitsSpatially && SpatialSortInterval > 0 && FrameNumber % SpatialSortInterval == 0)
+	{
+		SortUnitsSpatially();
+	}
+
+	UpdateSignificance();
+	UpdateEntityHydration();
+	SyncMovementStates();
+	AdvancePathFollowing();
+	UpdateSimCallback();
+	if (SimCallback)
+	{
+		PushSimInputs();
+	}
+	StageNavWalking(DeltaTime);
+	bPhasesPending = true;
+	GameThreadCycles = FPlatformTime::Cycles64() - StartCycles;
+}
+
+void AGTPawnMovementManager::RunPhase(EGTMovementPhase Phase)
+{
+	// The phases only run on inputs gathered by this frame's Tick, not on what was staged for an earlier one.
+	if (!bPhasesPending)
+	{
+		return;
+	}
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	switch (Phase)
+	{
+	case EGTMovementPhase::SolveVelocities:
+		SolveStagedVelocities();
+		return;
+
+	case EGTMovementPhase::Separation:
+		SeparateStagedUnits();
+		return;
+
+	case EGTMovementPhase::NavQueries:
+		ProjectStagedMoves();
+		return;
+
+	case EGTMovementPhase::CommitTransforms:
+		if (SimCallback)
+		{
+			ApplySimOutputs();
+		}
+		CommitCharacterMovement();
+		CharacterCommitCycles = FPlatformTime::Cycles64() - StartCycles;
+		UpdatePawnMovement(StagedDeltaTime);
+		PawnCommitCycles = FPlatformTime::Cycles64() - StartCycles - CharacterCommitCycles;
+		GameThreadCycles += CharacterCommitCycles + PawnCommitCycles;
+		return;
+
+	case EGTMovementPhase::PostMove:
+		UpdatePostMove();
+		bPhasesPending = false;
+		GameThreadCycles += FPlatformTime::Cycles64() - StartCycles;
+		SET_FLOAT_STAT(STAT_AGTPawnMovementManager_GameThreadMs, FPlatformTime::ToMilliseconds64(GameThreadCycles));
+		SET_FLOAT_STAT(STAT_AGTPawnMovementManager_TotalCpuMs, FPlatformTime::ToMilliseconds64(GameThreadCycles + TaskThreadCycles));
+		return;
+
+	default:
+		checkNoEntry();
 	}
 }
 
+void AGTPawnMovementManager::UpdatePostMove()
+{
+	UpdateUnitGrid();
+	UpdateTargets();
+	UpdateCrowdDensity();
+	UpdateFogOfWar();
+	UpdateUnitProxies();
+	UpdateCrowdAnimation();
+	CompactPathBuffers();
+	PathCache.PurgeInvalidated();
+
+	// The staged stages ran on task threads, their share of the character update is the time their tasks took.
+	SET_FLOAT_STAT(STAT_AGTPawnMovementManager_CharacterUsPerUnit, FPlatformTime::ToMilliseconds64(CharacterCommitCycles + TaskThreadCycles) * 1000.0 / FMath::Max(MovementComponents.Num(), 1));
+	SET_FLOAT_STAT(STAT_AGTPawnMovementManager_PawnUsPerUnit, FPlatformTime::ToMilliseconds64(PawnCommitCycles) * 1000.0 / FMath::Max(PawnMovementComponents.Num(), 1));
+
+	SET_MEMORY_STAT(STAT_FGTFrameArena_GameThreadPeak, FGTFrameArena::Get().GetPeakBytes());
+	SET_MEMORY_STAT(STAT_FGTFrameArena_Reserved, FGTFrameArena::GetTotalReservedBytes());
+	SET_DWORD_STAT(STAT_FGTFrameArena_ChunkAllocations, FGTFrameArena::GetTotalChunkAllocations());
+	SET_MEMORY_STAT(STAT_AGTPawnMovementManager_MovementStates, MovementStates.GetAllocatedSize());
+	SET_MEMORY_STAT(STAT_AGTPawnMovementManager_NavHeightfield, SimHeightfield.IsValid() ? SimHeightfield->GetAllocatedSize() : 0);
+	SET_MEMORY_STAT(STAT_AGTPawnMovementManager_CrowdDensity, CrowdDensity->GetAllocatedSize());
+	SET_MEMORY_STAT(STAT_AGTPawnMovementManager_FogOfWar, FogOfWar.GetAllocatedSize());
+
+	int32 OverflowedUnits = 0;
+	for (const FGTSignificanceBucketUsage& Usage : SignificanceUsage)
+	{
+		OverflowedUnits += Usage.OverflowedUnits;
+	}
+	SET_DWORD_STAT(STAT_AGTPawnMovementManager_OverflowedUnits, OverflowedUnits);
+	SET_MEMORY_STAT(STAT_AGTPawnMovementManager_PathBuffers, WaypointPool.GetAllocatedSize() + CorridorPool.GetAllocatedSize() + RoutePool.GetAllocatedSize() + OrderQueuePool.GetAllocatedSize());
+	const FGTPathCache::FStats& PathCacheStats = PathCache.GetStats();
+	SET_DWORD_STAT(STAT_FGTPathCache_Hits, PathCacheStats.Hits);
+	SET_DWORD_STAT(STAT_FGTPathCache_Misses, PathCacheStats.Misses);
+	SET_DWORD_STAT(STAT_FGTPathCache_Entries, PathCache.Num());
+	SET_FLOAT_STAT(STAT_FGTPathCache_HitRate, PathCacheStats.GetHitRate());
+	SET_FLOAT_STAT(STAT_FGTPathCache_SavedMs, PathCacheStats.SavedMs);
+
+	const FGTGroundQuery::FStats& GroundQueryStats = GroundQuery.GetStats();
+	SET_DWORD_STAT(STAT_FGTGroundQuery_RepeatedRays, GroundQueryStats.RepeatedRays);
+	SET_DWORD_STAT(STAT_FGTGroundQuery_HeightfieldHits, GroundQueryStats.HeightfieldHits);
+	SET_DWORD_STAT(STAT_FGTGroundQuery_DynamicHits, GroundQueryStats.DynamicHits);
+	SET_DWORD_STAT(STAT_FGTGroundQuery_SampledCells, GroundQueryStats.SampledCells);
+	SET_MEMORY_STAT(STAT_FGTGroundQuery_Heightfield, GroundQuery.GetAllocatedSize());
+}
+
+void FGTMovementPhaseTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Manager && IsValidChecked(Manager) && !Manager->IsUnreachable() && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Manager->RunPhase(Phase);
+	}
+}
+
+FString FGTMovementPhaseTickFunction::DiagnosticMessage()
+{
+	static const TCHAR* PhaseNames[] = {TEXT("SolveVelocities"), TEXT("Separation"), TEXT("NavQueries"), TEXT("CommitTransforms"), TEXT("PostMove")};
+	static_assert(UE_ARRAY_COUNT(PhaseNames) == static_cast<SIZE_T>(EGTMovementPhase::Num), "Every phase needs a name");
+	return FString::Printf(TEXT("%s[%s]"), Manager ? *Manager->GetFullName() : TEXT("None"), PhaseNames[static_cast<int32>(Phase)]);
+}
@@ -3,10 +3,82 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "GTPathBuffer.h"
+#include "GTCrowdAnimation.h"
+#include "GTCrowdDensity.h"
+#include "GTFogOfWar.h"
+#include "GTGroundQuery.h"
+#include "GTNavClusterGraph.h"
+#include "GTPathCache.h"
+#include "GTSpatialGrid.h"
+#include "GTTargetAcquisition.h"
+#include "GTUnitCommand.h"
+#include "GTUnitEntity.h"
+#include "GTUnitMovementState.h"
+#include "GTUnitProxyMeshes.h"
+#include "GTUnitSeparation.h"
+#include "GTUnitSignificance.h"
 #include "GameFramework/Actor.h"
+#include <atomic>
 #include "GTPawnMovementManager.generated.h"
 
+class AGTPawnMovementManager;
+class AGTSquad;
+class ACharacter;
+class ANavigationData;
+class FGTNavHeightfield;
+class FGTUnitMovementSimCallback;
 class UGTCharacterMovementComponent;
+class UGTPawnMovementComponent;
+
+/** Target of a unit, with the generation of the target's unit id when it was taken. */
+struct FGTUnitTarget
+{
+	int32 UnitId = INDEX_NONE;
+	uint32 Generation = 0;
+};
+
+/** Unit id of a unit that was just removed. The id is free and can be handed to the next unit. */
+DECLARE_MULTICAST_DELEGATE_OneParam(FGTOnUnitRemoved, int32);
+
+/** Stages of the manager's frame after its actor tick, which gathers the inputs. Each stage waits for the one before. */
+enum class EGTMovementPhase : uint8
+{
+	/** Integrates the velocity of the staged nav walking units, on task threads. */
+	SolveVelocities,
+	/** Pushes apart the staged units that would overlap after their move, on task threads. */
+	Separation,
+	/** Projects the staged moves onto the navmesh, on task threads. */
+	NavQueries,
+	/** Moves the components of every bucket, on the game thread before physics. */
+	CommitTransforms,
+	/** Rebuilds the unit grid, compacts path buffers and publishes stats, on the game thread. */
+	PostMove,
+	Num,
+};
+
+/**
+ * Runs one EGTMovementPhase of the manager. The task-thread stages only touch the manager's staged copies of the hot
+ * records, so they overlap with animation and the game-thread ticks of other actors instead of adding to them.
+ */
+USTRUCT()
+struct FGTMovementPhaseTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	AGTPawnMovementManager* Manager = nullptr;
+	EGTMovementPhase Phase = EGTMovementPhase::SolveVelocities;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FGTMovementPhaseTickFunction> : public TStructOpsTypeTraitsBase2<FGTMovementPhaseTickFunction>
+{
+	enum { WithCopy = false };
+};
+
 UCLASS()
 class GITTEST_API AGTPawnMovementManager : public AActor
 {
@@ -14,13 +86,541 @@ class GITTEST_API AGTPawnMovementManager : public AActor
 	
 public:
 
-	UPROPERTY(BlueprintReadWrite)
+	/**
+	 * Movement is batched per component type, each type in its own contiguous bucket updated by one batch function.
+	 * Character units are the bucket with dense per-unit rows, every per-unit array below is indexed by the same slot.
+	 * Use unit ids to keep a reference to a unit. Entity units without an actor have no component, see CreateUnitEntity.
+	 */
+	UPROPERTY(BlueprintReadOnly)
 	TArray<UGTCharacterMovementComponent*> MovementComponents;
+
+	/**
+	 * Pawn-style units, moved by UGTPawnMovementComponent::UpdateMovementBatch from the input their controller adds.
+	 * They have no unit id or per-unit rows, so EnqueueCommand and selection skip them, their controller steers them.
+	 */
+	UPROPERTY(BlueprintReadOnly)
+	TArray<UGTPawnMovementComponent*> PawnMovementComponents;
+
+	/** Squads are updated before the units so their move requests are consumed in the same frame. */
+	UPROPERTY(BlueprintReadOnly)
+	TArray<AGTSquad*> Squads;
+
+	/** Distance at which an intermediate path corner counts as reached. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float PathCornerRadius = 30.f;
 	
 	AGTPawnMovementManager();
 	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the movement manager placed in World, without allocating an actor list like GetAllActorsOfClass. */
+	static AGTPawnMovementManager* Get(const UWorld* World);
+
+	void RegisterMovementComponent(UGTCharacterMovementComponent* MovementComponent);
+	void UnregisterMovementComponent(UGTCharacterMovementComponent* MovementComponent);
+
+	void RegisterPawnMovementComponent(UGTPawnMovementComponent* MovementComponent);
+	void UnregisterPawnMovementComponent(UGTPawnMovementComponent* MovementComponent);
+
+	/**
+	 * Batch update of each bucket. Tick and the phase tick functions run the character update stage by stage, this runs
+	 * all of its stages at once so a benchmark can time one bucket on its own.
+	 */
+	void UpdateCharacterMovement(float DeltaTime);
+	void UpdatePawnMovement(float DeltaTime);
+
+	void RegisterSquad(AGTSquad* Squad);
+	void UnregisterSquad(AGTSquad* Squad);
+
+	/**
+	 * Creates a unit without an actor, standing at Location on the navmesh, and returns its unit id. It walks, follows
+	 * orders and is drawn as a proxy from the manager's rows alone. An actor of UnitClass, which has to move with a
+	 * UGTCharacterMovementComponent, is spawned for it while it needs one: while its significance bucket has
+	 * bNeedsActor, while it is in combat, or while a player views it from within EntityHydrationDistance.
+	 * Destroying that actor removes the unit, dehydrating it does not.
+	 */
+	int32 CreateUnitEntity(TSubclassOf<ACharacter> UnitClass, const FVector& Location, const FGenericTeamId& TeamId);
+
+	/** Removes a unit and destroys its actor if it has one. */
+	void DestroyUnit(int32 UnitId);
+
+	/** Unit ids are reused, whoever keeps one past the unit's removal has to drop it here. */
+	FGTOnUnitRemoved OnUnitRemoved;
+
+	/** Whether the unit has an actor, units registered by their own actor always have one. */
+	bool IsUnitHydrated(int32 UnitId) const;
+
+	/** Spawns actors for entity units that need one and destroys those of entity units that no longer do. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bHydrateEntities = true;
+
+	/** Entity units within this distance of a player's view point have an actor, so it can be replicated to them. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float EntityHydrationDistance = 3000.f;
+
+	/** Time an entity unit keeps its actor after it last needed it, so units on the edge do not respawn every frame. */
+	UPROPERTY(EditAnywhere)
+	float EntityDehydrationDelay = 2.f;
+
+	/** Actors spawned and destroyed for entity units per frame, each. */
+	UPROPERTY(EditAnywhere)
+	int32 MaxEntityHydrationsPerFrame = 16;
+
+	/** Grows the per-unit storage ahead of a bulk spawn so registration does not reallocate every few units. */
+	void ReserveUnits(int32 AdditionalUnits);
+
+	/** Finds a path for the unit and stores it in the shared waypoint buffer, replacing the path it was following. */
+	bool RequestMove(int32 UnitId, const FVector& Destination, float AcceptanceRadius = 50.f);
+
+	/** Copies the path into the shared buffers and makes the unit follow it from its first corner. */
+	void SetUnitPath(int32 UnitId, const FNavigationPath& Path, float AcceptanceRadius);
+	void SetUnitPath(int32 UnitId, TConstArrayView<FNavPathPoint> PathPoints, TConstArrayView<NavNodeRef> Corridor, float AcceptanceRadius);
+
+	/** Stops the unit and drops every order it had queued. */
+	void StopUnit(int32 UnitId);
+	bool IsFollowingPath(int32 UnitId) const;
+	bool IsAttackMoving(int32 UnitId) const;
+
+	/** Velocity the unit should walk at this frame, requests are consumed by the next movement update. */
+	void RequestUnitVelocity(int32 UnitId, const FVector& Velocity);
+
+	/** Reads the unit's movement state from its component again before its next update. */
+	void MarkMovementStateDirty(int32 UnitId);
+
+	/** Records a command, applied with every other recorded command at the start of the next tick. */
+	void EnqueueCommand(const FGTUnitCommand& Command);
+	void EnqueueCommands(TConstArrayView<FGTUnitCommand> Commands);
+
+	/** Every applied command in order, with its frame, while bRecordCommands is set. */
+	TConstArrayView<FGTUnitCommand> GetCommandLog() const { return CommandLog; }
+	void ClearCommandLog() { CommandLog.Reset(); }
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bRecordCommands = false;
+
+	int32 GetUnitSlot(int32 UnitId) const { return UnitSlots.IsValidIndex(UnitId) ? UnitSlots[UnitId] : INDEX_NONE; }
+	UGTCharacterMovementComponent* GetUnitMovementComponent(int32 UnitId) const;
+	/** Feet location of the unit, from its hot record while it has no actor. */
+	FVector GetUnitLocation(int32 UnitId) const;
+	/** Team of the unit, NoTeam for ids that are free. */
+	FGenericTeamId GetUnitTeamId(int32 UnitId) const;
+	int32 GetNumUnits() const { return MovementComponents.Num(); }
+
+	TConstArrayView<FGTPathWaypoint> GetUnitWaypoints(int32 UnitId) const;
+	TConstArrayView<NavNodeRef> GetUnitCorridor(int32 UnitId) const;
+
+	const FGTPathCache& GetPathCache() const { return PathCache; }
+
+	/** Units sent from the same area to the same goal poly share one search through the path cache. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bUsePathCache = true;
+
+	/** Orders longer than HierarchicalPathDistance get a coarse cluster route that is refined as the unit advances. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bUseHierarchicalPathfinding = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float HierarchicalPathDistance = 15000.f;
+
+	UPROPERTY(EditAnywhere)
+	float NavClusterSize = 5000.f;
+
+	/** Time spent building or repairing the cluster graph per frame, in milliseconds. */
+	UPROPERTY(EditAnywhere)
+	float NavClusterUpdateBudgetMs = 1.f;
+
+	const FGTNavClusterGraph& GetNavClusterGraph() const { return NavClusterGraph; }
+
+	/** Cursor and ground snapping queries against the navmesh heightfield, initialized on first use. */
+	FGTGroundQuery& GetGroundQuery();
+
+	/** Unit ids bucketed by location after the units moved this frame, for selection and neighbour queries. */
+	const FGTSpatialGrid& GetUnitGrid() const { return UnitGrid; }
+
+	UPROPERTY(EditAnywhere)
+	float UnitGridCellSize = 500.f;
+
+	/** Units are reordered along a Z-order curve every SpatialSortInterval frames, so neighbouring slots are neighbours in the world. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bSortUnitsSpatially = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 SpatialSortInterval = 30;
+
+	/** Quantization of unit locations for the Z-order key, units closer than this share a key. */
+	UPROPERTY(EditAnywhere)
+	float SpatialSortCellSize = 200.f;
+
+	/**
+	 * Order SortUnitsSpatially reorders the rows in, OutSlotOrder[Index] is the slot that moves to Index. Units sharing a
+	 * cell of CellSize keep their relative order. Returns how many units change slot.
+	 */
+	static int32 GetSpatialSlotOrder(TConstArrayView<FGTUnitMovementHot> MovementStates, float CellSize, TArrayView<int32> OutSlotOrder);
+
+	/** Time spent repairing paths broken by navmesh rebuilds per frame, in milliseconds. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float PathRepairBudgetMs = 0.5f;
+
+	/** Units walking on the navmesh without root motion, avoidance or player input are moved from their hot record. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bUseHotNavWalking = true;
+
+	/**
+	 * Hot nav walking units are simulated by a callback on the physics thread instead of the task-thread stages. The game
+	 * thread packs their requested velocities and writes back the transforms the simulation reported, once per frame.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bSimulateOnPhysicsThread = false;
+
+	/** Cell size of the navmesh heightfield the physics thread and EGTNavProjection::Heightfield walk units on, the fog of war reads its heights too. */
+	UPROPERTY(EditAnywhere)
+	float PhysicsThreadNavCellSize = 100.f;
+
+	/**
+	 * Hot nav walking units are pushed apart as circles instead of sweeping their capsules, see FGTUnitSeparation.
+	 * Every other character unit is an obstacle that does not move. Pushes never take a unit off the navmesh.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bSeparateUnits = true;
+
+	UPROPERTY(EditAnywhere)
+	int32 SeparationIterations = 3;
+
+	/** Share of the overlap resolved per iteration. */
+	UPROPERTY(EditAnywhere)
+	float SeparationStiffness = 0.5f;
+
+	/** How much more an idle unit gives way to a moving unit of its team than the other way round. */
+	UPROPERTY(EditAnywhere)
+	float FriendlyPushRatio = 4.f;
+
+	/** Fastest a unit is pushed, so a crowd spreads over a few frames instead of popping apart. */
+	UPROPERTY(EditAnywhere)
+	float MaxSeparationSpeed = 300.f;
+
+	/**
+	 * New and repaired paths avoid crowds: walking through a poly costs more the more units stood around it lately, see
+	 * FGTCrowdDensity. Paths already being followed are not searched again when a crowd forms on them.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bUseCongestionCosts = true;
+
+	/** Extra cost per unit near a poly, relative to walking through it empty. */
+	UPROPERTY(EditAnywhere)
+	float CongestionCostPerUnit = 0.05f;
+
+	/** Size of the cells units are counted in for the congestion costs. */
+	UPROPERTY(EditAnywhere)
+	float CongestionCellSize = 800.f;
+
+	/**
+	 * Character units are scored by significance under the first local player's camera and given the budgets of the
+	 * first bucket their score qualifies for, see FGTSignificanceScorer. Ordered from the most to the least significant,
+	 * the last bucket takes every unit left. Without a player camera units keep the bucket they have.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<FGTSignificanceBudget> SignificanceBudgets;
+
+	/** Every unit is scored again once over this many frames, a slice of them each frame. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 SignificanceRescoreFrames = 8;
+
+	/** Score of a unit filling the screen height. */
+	UPROPERTY(EditAnywhere)
+	float ScreenSizeSignificance = 10.f;
+
+	UPROPERTY(EditAnywhere)
+	float SelectedSignificance = 1.f;
+
+	/** Added while the unit is attack moving, or for CombatSignificanceTime after NotifyUnitInCombat. */
+	UPROPERTY(EditAnywhere)
+	float CombatSignificance = 0.5f;
+
+	UPROPERTY(EditAnywhere)
+	float CombatSignificanceTime = 3.f;
+
+	/** Added for units on the local player's team. */
+	UPROPERTY(EditAnywhere)
+	float OwnedSignificance = 0.25f;
+
+	/** Marks the unit selected by the local player, which raises its significance. */
+	void SetUnitSelected(int32 UnitId, bool bSelected);
+
+	/** Raises the unit's significance for CombatSignificanceTime. */
+	void NotifyUnitInCombat(int32 UnitId);
+
+	float GetUnitSignificance(int32 UnitId) const;
+
+	/** Budgets of the unit's significance bucket, the last bucket's for unknown units. */
+	const FGTSignificanceBudget& GetUnitBudget(int32 UnitId) const;
+
+	/** Usage of each of SignificanceBudgets this frame, indexed like SignificanceBudgets. */
+	TConstArrayView<FGTSignificanceBucketUsage> GetSignificanceUsage() const { return SignificanceUsage; }
+
+	/**
+	 * Closest hostile unit within TargetAcquisitionRange of the unit, INDEX_NONE without one. Every unit due a search
+	 * is given its target at once in PostMove, see FGTTargetAcquisition; a unit searches every TargetingInterval frames
+	 * of its significance bucket, and right away when its target is removed.
+	 */
+	int32 GetUnitTarget(int32 UnitId) const;
+
+	/** Units without a team neither search for targets nor are found as one. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bAcquireTargets = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float TargetAcquisitionRange = 1500.f;
+
+	/** Smallest cell of the per-team grids targets are searched in. */
+	UPROPERTY(EditAnywhere)
+	float TargetGridCellSize = 500.f;
+
+	/**
+	 * Animates the meshes of the units, which do not tick on their own, see FGTCrowdAnimation. Character units follow
+	 * their significance budget, pawn units always share a pose.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bAnimateCrowd = true;
+
+	UPROPERTY(EditAnywhere)
+	TSoftObjectPtr<UAnimSequenceBase> IdleAnimation = TSoftObjectPtr<UAnimSequenceBase>(FSoftObjectPath(TEXT("/Game/Characters/Mannequins/Animations/Manny/MM_Idle.MM_Idle")));
+
+	UPROPERTY(EditAnywhere)
+	TSoftObjectPtr<UAnimSequenceBase> JogAnimation = TSoftObjectPtr<UAnimSequenceBase>(FSoftObjectPath(TEXT("/Game/Characters/Mannequins/Animations/Manny/MM_Run_Fwd.MM_Run_Fwd")));
+
+	/** Units sharing a pose are spread over this many leaders per state, each further along its animation. */
+	UPROPERTY(EditAnywhere)
+	int32 AnimationPhaseBuckets = 4;
+
+	/** Units faster than this share the jog pose, slower ones the idle pose. */
+	UPROPERTY(EditAnywhere)
+	float JogAnimationSpeed = 50.f;
+
+	UPROPERTY(EditAnywhere)
+	bool bInterpolateSkippedAnimation = true;
+
+	/** Draws units of buckets with bDrawAsProxy as instances of a static mesh per unit type, see FGTUnitProxyMeshes. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bDrawUnitProxies = true;
+
+	/** Proxy mesh of each unit class, classes without one use DefaultUnitProxyMesh. */
+	UPROPERTY(EditAnywhere)
+	TMap<TSubclassOf<AActor>, TSoftObjectPtr<UStaticMesh>> UnitProxyMeshes;
+
+	UPROPERTY(EditAnywhere)
+	TSoftObjectPtr<UStaticMesh> DefaultUnitProxyMesh = TSoftObjectPtr<UStaticMesh>(FSoftObjectPath(TEXT("/Engine/BasicShapes/Cylinder.Cylinder")));
+
+	/** What each team's units see, updated by PostMove for the units that crossed a cell, see FGTFogOfWar. */
+	const FGTFogOfWar& GetFogOfWar() const { return FogOfWar; }
+
+	/** Units without a team see nothing. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bUpdateFogOfWar = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float UnitSightRadius = 1500.f;
+
+	/** Size of the fog of war cells, grown on large navmeshes like the congestion cells. */
+	UPROPERTY(EditAnywhere)
+	float FogOfWarCellSize = 200.f;
+
+	/** Cells this much higher than a unit's cell hide what lies behind them from it. */
+	UPROPERTY(EditAnywhere)
+	float FogOfWarBlockingHeight = 200.f;
+
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
 protected:
+	UFUNCTION()
+	void OnNavigationGenerationFinished(ANavigationData* NavData);
+
+	UFUNCTION()
+	void OnPawnControllerChanged(APawn* Pawn, AController* Controller);
+
 	virtual void BeginPlay() override;
-	
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void RegisterActorTickFunctions(bool bRegister) override;
+
+private:
+	friend struct FGTMovementPhaseTickFunction;
+
+	enum class EStagedMove : uint8
+	{
+		Stopped,
+		Moved,
+		LeftNavMesh,
+	};
+
+	void RemoveUnitAtSlot(int32 Slot);
+	void ApplyCommands();
+	void ApplyCommand(int32 Slot, const FGTUnitCommand& Command);
+	void QueueWaypoint(FGTUnitOrderState& OrderState, const FVector& Waypoint);
+	void StartNextQueuedWaypoint(int32 UnitId);
+	void ClearOrders(FGTUnitOrderState& OrderState);
+	bool FindUnitPath(int32 Slot, const FVector& Destination, float AcceptanceRadius);
+	void ClearPath(FGTPathFollowState& PathState);
+	void ClearRoute(FGTPathFollowState& PathState);
+	void RefineRoute(int32 UnitId);
+	void UpdateNavClusterGraph();
+	void DetectBrokenPaths(const ANavigationData& NavData);
+	void ProcessPathRepairs();
+	bool RepairPath(int32 Slot, const ANavigationData& NavData);
+	void AdvancePathFollowing();
+	void SyncMovementStates();
+	void SyncMovementState(int32 Slot);
+	void RunPhase(EGTMovementPhase Phase);
+	void StageNavWalking(float DeltaTime);
+	void SolveStagedVelocities();
+	void SeparateStagedUnits();
+	void ProjectStagedMoves();
+	void CommitCharacterMovement();
+	void UpdatePostMove();
+	void UpdateSimCallback();
+	void UnregisterSimCallback();
+	void PushSimInputs();
+	void ApplySimOutputs();
+	/** Heightfield of NavData at PhysicsThreadNavCellSize, built again when the navmesh changed since the last one. */
+	const FGTNavHeightfield* GetSimHeightfield(const ANavigationData& NavData);
+	/** Slot of a unit the physics thread simulation reported on, INDEX_NONE if the report is for a unit it no longer owns. */
+	int32 GetSimulatedSlot(int32 UnitId, uint32 Generation) const;
+	void CompactPathBuffers();
+	void UpdateUnitGrid();
+	void UpdateCrowdDensity();
+	void UpdateFogOfWar();
+	void UpdateTargets();
+	/** Whether the unit's target still exists and is still hostile to it. */
+	bool HasValidTarget(int32 Slot) const;
+	void UpdateSignificance();
+	void UpdateEntityHydration();
+	void HydrateUnit(int32 Slot);
+	void DehydrateUnit(int32 Slot);
+	/** Component a unit's paths are searched for, the class default one's for entity units without an actor. */
+	const UGTCharacterMovementComponent* GetPathQuerier(int32 Slot) const;
+	FVector GetUnitFeetLocation(int32 Slot) const;
+	void UpdateCrowdAnimation();
+	void UpdateUnitProxies();
+	UStaticMesh* GetUnitProxyMesh(const UClass& UnitClass) const;
+	/** Shared pose a unit moving at Velocity plays. */
+	EGTCrowdAnimState GetCrowdAnimState(const FVector& Velocity) const;
+	void RescoreUnit(int32 Slot, const FGenericTeamId& PlayerTeamId, double Now);
+	/** Adds Units, which may be negative, to the unit count of the bucket as units are registered and removed. */
+	void AddSignificanceUsage(int32 Bucket, int32 Units);
+	/** Budgets of the bucket at Index, clamped to the buckets there are. */
+	const FGTSignificanceBudget& GetBudget(int32 Index) const;
+	/** Filter for new and repaired paths on NavData, nullptr for the default one. */
+	FSharedConstNavQueryFilter GetPathFilter(const ANavigationData& NavData);
+	void SortUnitsSpatially();
+	/** Unit id for a new unit, a freed one if there is any. Its slot is left INDEX_NONE. */
+	int32 AllocateUnitId();
+
+	/** Unit id of each slot. */
+	TArray<int32> UnitIds;
+	/** Slot of each unit id, INDEX_NONE for ids that are free. */
+	TArray<int32> UnitSlots;
+	/** Bumped each time a unit id is freed, so an id kept past its unit's removal can tell it now names another unit. */
+	TArray<uint32> UnitIdGenerations;
+	TArray<int32> FreeUnitIds;
+
+	TArray<FGTPathFollowState> PathStates;
+	TGTSpanPool<FGTPathWaypoint> WaypointPool;
+	TGTSpanPool<NavNodeRef> CorridorPool;
+	TGTSpanPool<FVector> RoutePool;
+
+	TArray<FGTUnitOrderState> OrderStates;
+	TArray<FGTUnitMovementHot, TAlignedHeapAllocator<alignof(FGTUnitMovementHot)>> MovementStates;
+	TArray<FGTUnitBody> UnitBodies;
+	TArray<FGTUnitSignificance> Significances;
+	TArray<FGTUnitAnimation> UnitAnimations;
+	TArray<FGTUnitProxy> UnitProxies;
+	TArray<FGTUnitEntity> UnitEntities;
+	/** Target of each unit, INDEX_NONE unit id without one. */
+	TArray<FGTUnitTarget> UnitTargets;
+	TGTSpanPool<FVector> OrderQueuePool;
+
+	TArray<FGTUnitCommand> PendingCommands;
+	TArray<FGTUnitCommand> CommandLog;
+	uint32 NextCommandSequence = 0;
+	uint32 FrameNumber = 0;
+
+	/** Path instance reused by every query, its corners are copied into the pools right away. */
+	FNavPathSharedPtr ScratchPath;
+
+	FGTPathCache PathCache;
+	FGTNavClusterGraph NavClusterGraph;
+	TArray<FVector> ScratchRoute;
+
+	/** Units whose corridor crosses a rebuilt tile, repaired in order under PathRepairBudgetMs. */
+	TArray<int32> PendingRepairs;
+	TSet<int32> PendingRepairSet;
+	FGTGroundQuery GroundQuery;
+	FGTSpatialGrid UnitGrid;
+
+	/** Shared with every copy of CongestionFilter the navigation system makes, updated by PostMove. */
+	TSharedPtr<FGTCrowdDensity, ESPMode::ThreadSafe> CrowdDensity = MakeShared<FGTCrowdDensity, ESPMode::ThreadSafe>();
+	FSharedConstNavQueryFilter CongestionFilter;
+	TWeakObjectPtr<const ANavigationData> CongestionFilterNavData;
+
+	FGTFogOfWar FogOfWar;
+	FGTTargetAcquisition TargetAcquisition;
+	FGTCrowdAnimation CrowdAnimation;
+	FGTUnitProxyMeshes ProxyMeshes;
+	/** UnitProxyMeshes and DefaultUnitProxyMesh loaded at BeginPlay, so a unit turning into a proxy only looks its class up. */
+	TMap<const UClass*, UStaticMesh*> LoadedUnitProxyMeshes;
+	UStaticMesh* LoadedDefaultUnitProxyMesh = nullptr;
+	/** Actor spawned by HydrateUnit, its movement component takes over the row of HydratingUnitId when it registers. */
+	const AActor* HydratingActor = nullptr;
+	int32 HydratingUnitId = INDEX_NONE;
+	/** Animation of each pawn unit, indexed like PawnMovementComponents. */
+	TArray<FGTUnitAnimation> PawnAnimations;
+
+	FGTSignificanceScorer SignificanceScorer;
+	TArray<FGTSignificanceBucketUsage> SignificanceUsage;
+	/** Slot the next rescoring slice starts at. */
+	int32 SignificanceCursor = 0;
+
+	TArray<FNavPathPoint> ScratchPathPoints;
+	TArray<NavNodeRef> ScratchCorridor;
+
+	FGTMovementPhaseTickFunction PhaseTickFunctions[static_cast<int32>(EGTMovementPhase::Num)];
+
+	/**
+	 * Copies of the hot records of the nav walking units, taken at the end of Tick. The task-thread stages work on these
+	 * alone, so units registered or removed meanwhile do not move memory under them, and CommitTransforms finds each
+	 * unit again by id.
+	 */
+	TArray<FGTUnitMovementHot, TAlignedHeapAllocator<alignof(FGTUnitMovementHot)>> StagedStates;
+	TArray<int32> StagedUnitIds;
+	TArray<EStagedMove> StagedMoves;
+	/** Time each staged unit moves over, longer than the frame for units whose bucket skipped frames. */
+	TArray<float> StagedDeltaTimes;
+	/** Staged units whose moves are projected onto the heightfield rather than the navmesh. */
+	TBitArray<> StagedHeightfieldProjections;
+	TSharedPtr<const FGTNavHeightfield, ESPMode::ThreadSafe> StagedHeightfield;
+	/** Staged units [0, NumSeparatedStaged) are separated, the rest walk through other units. */
+	int32 NumSeparatedStaged = 0;
+	/** Staged units first, in staging order, then every other unit as an obstacle. */
+	TArray<FGTSeparationBody> SeparationBodies;
+	/** Push of each staged unit, empty when the separation pass did not run. */
+	TArray<FVector2f> StagedPushes;
+	FGTUnitSeparation Separation;
+	const ANavigationData* StagedNavData = nullptr;
+	FVector StagedQueryExtent = FVector::ZeroVector;
+	float StagedDeltaTime = 0.f;
+	bool bStagedNavWalking = false;
+	/** Set by Tick, cleared by PostMove. */
+	bool bPhasesPending = false;
+
+	FGTUnitMovementSimCallback* SimCallback = nullptr;
+	TSharedPtr<const FGTNavHeightfield, ESPMode::ThreadSafe> SimHeightfield;
+	bool bSimHeightfieldDirty = true;
+	/** Last heightfield sent to the simulation, which is sent again whenever SimHeightfield was rebuilt. */
+	TSharedPtr<const FGTNavHeightfield, ESPMode::ThreadSafe> PushedSimHeightfield;
+	/** Units the simulation drops with the next input. */
+	TArray<int32> SimRemovedUnitIds;
+	/** Bumped each time a unit id is handed to the simulation, indexed by unit id. */
+	TArray<uint32> SimGenerations;
 
+	/** Time the stages spent on the game thread this frame, and time their batches spent on task threads. */
+	uint64 GameThreadCycles = 0;
+	std::atomic<uint64> TaskThreadCycles{0};
+	uint64 CharacterCommitCycles = 0;
+	uint64 PawnCommitCycles = 0;
 };
@@ -0,0 +1,186 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GTSpatialGrid.h"
+
+DECLARE_CYCLE_STAT(TEXT("FGTSpatialGrid Build"), STAT_FGTSpatialGrid_Build, STATGROUP_Game);
+DECLARE_CYCLE_STAT(TEXT("FGTSpatialGrid QueryConvexQuad"), STAT_FGTSpatialGrid_QueryConvexQuad, STATGROUP_Game);
+
+FIntPoint FGTSpatialGrid::GetCell(const FVector2D& Location) const
+{
+	return Layout.GetClampedCell(FVector2f(Location));
+}
+
+void FGTSpatialGrid::Build(TConstArrayView<FVector> Locations, TConstArrayView<int32> Ids)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FGTSpatialGrid_Build);
+	check(Locations.Num() == Ids.Num());
+
+	const int32 NumEntries = Locations.Num();
+	EntryLocations.SetNumUninitialized(NumEntries, false);
+	EntryIds.SetNumUninitialized(NumEntries, false);
+	if (NumEntries == 0)
+	{
+		Layout.Reset();
+		CellStarts.Reset();
+		return;
+	}
+
+	FBox2D Bounds(ForceInit);
+	for (const FVector& Location : Locations)
+	{
+		Bounds += FVector2D(Location);
+	}
+
+	Layout.Initialize(Bounds, CellSize, MaxCellsPerAxis);
+
+	// Counting sort: count per cell, prefix sum into starts, then scatter.
+	CellStarts.SetNumUninitialized(Layout.Num() + 1, false);
+	FMemory::Memzero(CellStarts.GetData(), CellStarts.Num() * sizeof(int32));
+	ScratchCells.SetNumUninitialized(NumEntries, false);
+	for (int32 Index = 0; Index < NumEntries; ++Index)
+	{
+		const FIntPoint Cell = GetCell(FVector2D(Locations[Index]));
+		const int32 CellIndex = Layout.GetCellIndex(Cell);
+		ScratchCells[Index] = CellIndex;
+		++CellStarts[CellIndex + 1];
+	}
+
+	for (int32 CellIndex = 1; CellIndex < CellStarts.Num(); ++CellIndex)
+	{
+		CellStarts[CellIndex] += CellStarts[CellIndex - 1];
+	}
+
+	// Scatter using the starts as write cursors, then shift them back.
+	for (int32 Index = 0; Index < NumEntries; ++Index)
+	{
+		const int32 EntryIndex = CellStarts[ScratchCells[Index]]++;
+		EntryLocations[EntryIndex] = FVector2f(Locations[Index].X, Locations[Index].Y);
+		EntryIds[EntryIndex] = Ids[Index];
+	}
+	for (int32 CellIndex = CellStarts.Num() - 1; CellIndex > 0; --CellIndex)
+	{
+		CellStarts[CellIndex] = CellStarts[CellIndex - 1];
+	}
+	CellStarts[0] = 0;
+}
+
+void FGTSpatialGrid::QueryConvexQuad(const FVector2D (&Corners)[4], TArray<int32>& OutIds) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_FGTSpatialGrid_QueryConvexQuad);
+	if (EntryIds.Num() == 0)
+	{
+		return;
+	}
+
+	// Edge normals pointing inwards whatever the winding, a point is inside when it is on the inner side of every edge.
+	const float Winding = FVector2D::CrossProduct(Corners[1] - Corners[0], Corners[2] - Corners[1]) >= 0.f ? 1.f : -1.f;
+	FVector2f EdgeStarts[4];
+	FVector2f EdgeNormals[4];
+	FBox2D QuadBounds(ForceInit);
+	for (int32 Edge = 0; Edge < 4; ++Edge)
+	{
+		const FVector2D EdgeVector = Corners[(Edge + 1) % 4] - Corners[Edge];
+		EdgeStarts[Edge] = FVector2f(Corners[Edge]);
+		EdgeNormals[Edge] = FVector2f(-EdgeVector.Y * Winding, EdgeVector.X * Winding);
+		QuadBounds += Corners[Edge];
+	}
+
+	const auto IsInside = [&EdgeStarts, &EdgeNormals](const FVector2f& Point)
+	{
+		for (int32 Edge = 0; Edge < 4; ++Edge)
+		{
+			if (FVector2f::DotProduct(Point - EdgeStarts[Edge], EdgeNormals[Edge]) < 0.f)
+			{
+				return false;
+			}
+		}
+		return true;
+	};
+
+	const FIntPoint MinCell = GetCell(QuadBounds.Min);
+	const FIntPoint MaxCell = GetCell(QuadBounds.Max);
+	for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+	{
+		for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+		{
+			const int32 CellIndex = Layout.GetCellIndex(FIntPoint(X, Y));
+			const int32 Start = CellStarts[CellIndex];
+			const int32 End = CellStarts[CellIndex + 1];
+			if (Start == End)
+			{
+				continue;
+			}
+
+			// Cells completely inside the quad are taken whole, only cells on its border test every entry.
+			const FVector2f CellMin = Layout.GetCellMin(FIntPoint(X, Y));
+			const FVector2f CellMax = CellMin + FVector2f(Layout.CellSize);
+			const bool bCellInside = IsInside(CellMin) && IsInside(CellMax) && IsInside(FVector2f(CellMin.X, CellMax.Y)) && IsInside(FVector2f(CellMax.X, CellMin.Y));
+			if (bCellInside)
+			{
+				OutIds.Append(EntryIds.GetData() + Start, End - Start);
+				continue;
+			}
+
+			for (int32 EntryIndex = Start; EntryIndex < End; ++EntryIndex)
+			{
+				if (IsInside(EntryLocations[EntryIndex]))
+				{
+					OutIds.Add(EntryIds[EntryIndex]);
+				}
+			}
+		}
+	}
+}
+
+int32 FGTSpatialGrid::FindNearest(const FVector2D& Point, float MaxRadius) const
+{
+	if (EntryIds.Num() == 0)
+	{
+		return INDEX_NONE;
+	}
+
+	const FIntPoint MinCell = GetCell(Point - FVector2D(MaxRadius));
+	const FIntPoint MaxCell = GetCell(Point + FVector2D(MaxRadius));
+	const FIntPoint Center = GetCell(Point);
+	const FVector2f Point2f(Point);
+
+	// Rings of cells outwards from the point's cell. Every cell of ring R is at least R - 1 cells away, so once a ring
+	// is further than the nearest entry found, the rings after it cannot hold a nearer one.
+	int32 NearestId = INDEX_NONE;
+	float NearestDistanceSquared = FMath::Square(MaxRadius);
+	const int32 MaxRing = FMath::Max(FMath::Max(Center.X - MinCell.X, MaxCell.X - Center.X), FMath::Max(Center.Y - MinCell.Y, MaxCell.Y - Center.Y));
+	for (int32 Ring = 0; Ring <= MaxRing; ++Ring)
+	{
+		if (NearestId != INDEX_NONE && FMath::Square((Ring - 1) * Layout.CellSize) > NearestDistanceSquared)
+		{
+			break;
+		}
+
+		for (int32 Y = FMath::Max(Center.Y - Ring, MinCell.Y); Y <= FMath::Min(Center.Y + Ring, MaxCell.Y); ++Y)
+		{
+			// Rows inside the ring only have its two side cells.
+			const bool bEdgeRow = FMath::Abs(Y - Center.Y) == Ring;
+			const int32 Step = bEdgeRow ? 1 : FMath::Max(2 * Ring, 1);
+			for (int32 X = Center.X - Ring; X <= Center.X + Ring; X += Step)
+			{
+				if (X < MinCell.X || X > MaxCell.X)
+				{
+					continue;
+				}
+
+				const int32 CellIndex = Layout.GetCellIndex(FIntPoint(X, Y));
+				for (int32 EntryIndex = CellStarts[CellIndex]; EntryIndex < CellStarts[CellIndex + 1]; ++EntryIndex)
+				{
+					const float DistanceSquared = FVector2f::DistSquared(EntryLocations[EntryIndex], Point2f);
+					if (DistanceSquared <= NearestDistanceSquared)
+					{
+						NearestDistanceSquared = DistanceSquared;
+						NearestId = EntryIds[EntryIndex];
+					}
+				}
+			}
+		}
+	}
+	return NearestId;
+}
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GTGridLayout.h"
+
+/**
+ * Uniform 2D grid over unit locations, rebuilt from scratch with a counting sort.
+ * Entries of a cell are contiguous, so a query touches a few runs of memory instead of every unit.
+ */
+class GITTEST_API FGTSpatialGrid
+{
+public:
+	/** Rebuilds the grid, Ids[Index] is reported for Locations[Index]. */
+	void Build(TConstArrayView<FVector> Locations, TConstArrayView<int32> Ids);
+
+	/** Appends the ids of every entry inside the convex quad, corners in either winding order. */
+	void QueryConvexQuad(const FVector2D (&Corners)[4], TArray<int32>& OutIds) const;
+
+	/**
+	 * Id of the entry closest to Point within MaxRadius, INDEX_NONE if there is none. Cells are searched in rings
+	 * outwards from Point, so a query in a dense crowd stops after the few cells around it whatever MaxRadius is.
+	 */
+	int32 FindNearest(const FVector2D& Point, float MaxRadius) const;
+
+	/** Calls Visit with the id of every entry within Radius of Point, located where it was when the grid was built. */
+	template<typename VisitorType>
+	void ForEachInRadius(const FVector2f& Point, float Radius, VisitorType&& Visit) const
+	{
+		if (EntryIds.Num() == 0)
+		{
+			return;
+		}
+
+		const FIntPoint MinCell = GetCell(FVector2D(Point - FVector2f(Radius)));
+		const FIntPoint MaxCell = GetCell(FVector2D(Point + FVector2f(Radius)));
+		const float RadiusSquared = FMath::Square(Radius);
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+			{
+				const int32 CellIndex = Layout.GetCellIndex(FIntPoint(X, Y));
+				for (int32 EntryIndex = CellStarts[CellIndex]; EntryIndex < CellStarts[CellIndex + 1]; ++EntryIndex)
+				{
+					if (FVector2f::DistSquared(EntryLocations[EntryIndex], Point) <= RadiusSquared)
+					{
+						Visit(EntryIds[EntryIndex]);
+					}
+				}
+			}
+		}
+	}
+
+	int32 Num() const { return EntryIds.Num(); }
+	SIZE_T GetAllocatedSize() const { return CellStarts.GetAllocatedSize() + EntryLocations.GetAllocatedSize() + EntryIds.GetAllocatedSize() + ScratchCells.GetAllocatedSize(); }
+
+	/** Laid out over the bounds of the units at every Build, see FGTGridLayout. */
+	float CellSize = 500.f;
+	int32 MaxCellsPerAxis = 256;
+
+private:
+	FIntPoint GetCell(const FVector2D& Location) const;
+
+	FGTGridLayout Layout;
+
+	/** First entry of each cell, with one extra element holding the entry count. */
+	TArray<int32> CellStarts;
+	TArray<FVector2f> EntryLocations;
+	TArray<int32> EntryIds;
+	TArray<int32> ScratchCells;
+};
@@ -0,0 +1,331 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GTSquad.h"
+
+#include "GTCharacterMovementComponent.h"
+#include "GTPawnMovementManager.h"
+#include "NavigationSystem.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+
+DECLARE_CYCLE_STAT(TEXT("AGTSquad UpdateSquad"), STAT_AGTSquad_UpdateSquad, STATGROUP_Game);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AGTSquad Removed Controllers"), STAT_AGTSquad_RemovedControllers, STATGROUP_Game);
+DECLARE_MEMORY_STAT(TEXT("AGTSquad Removed Controller Memory"), STAT_AGTSquad_RemovedControllerMemory, STATGROUP_Game);
+
+AGTSquad::AGTSquad()
+{
+	PrimaryActorTick.bCanEverTick = false;
+}
+
+void AGTSquad::BeginPlay()
+{
+	Super::BeginPlay();
+
+	PawnMovementManager = AGTPawnMovementManager::Get(GetWorld());
+	if (PawnMovementManager)
+	{
+		PawnMovementManager->RegisterSquad(this);
+	}
+	else
+	{
+		UE_LOG(LogTemp, Error, TEXT("The movement manager has not been found") );
+	}
+}
+
+void AGTSquad::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	if (IsValid(PawnMovementManager))
+	{
+		PawnMovementManager->UnregisterSquad(this);
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("%s removed %d controllers, about %lld KB"), *GetName(), NumRemovedControllers, RemovedControllerBytes / 1024);
+}
+
+void AGTSquad::AddUnit(APawn* Unit)
+{
+	if (!IsValid(Unit) || Units.Contains(Unit))
+	{
+		return;
+	}
+
+	UGTCharacterMovementComponent* MovementComponent = Cast<UGTCharacterMovementComponent>(Unit->GetMovementComponent());
+	if (MovementComponent == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s can only drive units with a UGTCharacterMovementComponent, %s was ignored"), *GetName(), *Unit->GetName());
+		return;
+	}
+
+	RemoveController(Unit);
+	MovementComponent->bRunPhysicsWithNoController = true;
+	MovementComponent->RefreshMovementState();
+
+	Units.Add(Unit);
+	UnitMovementComponents.Add(MovementComponent);
+	UnitOffsets.Add(ToLeaderFrame(Unit->GetActorLocation() - LeaderLocation));
+	Unit->OnDestroyed.AddDynamic(this, &AGTSquad::OnUnitDestroyed);
+}
+
+void AGTSquad::RemoveUnit(APawn* Unit)
+{
+	const int32 Index = Units.Find(Unit);
+	if (Index != INDEX_NONE)
+	{
+		if (IsValid(Unit))
+		{
+			Unit->OnDestroyed.RemoveDynamic(this, &AGTSquad::OnUnitDestroyed);
+		}
+		Units.RemoveAtSwap(Index);
+		UnitMovementComponents.RemoveAtSwap(Index);
+		UnitOffsets.RemoveAtSwap(Index);
+	}
+}
+
+void AGTSquad::OnUnitDestroyed(AActor* DestroyedActor)
+{
+	RemoveUnit(Cast<APawn>(DestroyedActor));
+}
+
+void AGTSquad::RemoveInvalidUnits()
+{
+	for (int32 Index = Units.Num() - 1; Index >= 0; --Index)
+	{
+		if (!IsValid(Units[Index]) || !IsValid(UnitMovementComponents[Index]))
+		{
+			Units.RemoveAtSwap(Index);
+			UnitMovementComponents.RemoveAtSwap(Index);
+			UnitOffsets.RemoveAtSwap(Index);
+		}
+	}
+}
+
+void AGTSquad::RemoveController(APawn* Unit)
+{
+	AController* Controller = Unit->GetController();
+	if (Controller == nullptr)
+	{
+		return;
+	}
+
+	int64 ControllerBytes = Controller->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+	TInlineComponentArray<UActorComponent*> Components(Controller);
+	for (const UActorComponent* Component : Components)
+	{
+		ControllerBytes += Component->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+	}
+
+	Controller->UnPossess();
+	Controller->Destroy();
+
+	++NumRemovedControllers;
+	RemovedControllerBytes += ControllerBytes;
+	INC_DWORD_STAT(STAT_AGTSquad_RemovedControllers);
+	INC_MEMORY_STAT_BY(STAT_AGTSquad_RemovedControllerMemory, ControllerBytes);
+}
+
+FVector AGTSquad::GetSquadCenter() const
+{
+	if (Units.Num() == 0)
+	{
+		return GetActorLocation();
+	}
+
+	FVector Center = FVector::ZeroVector;
+	for (const APawn* Unit : Units)
+	{
+		Center += Unit->GetActorLocation();
+	}
+	return Center / Units.Num();
+}
+
+bool AGTSquad::MoveTo(const FVector& Destination)
+{
+	UNavigationSystemV1* NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	const ANavigationData* NavData = NavigationSystem ? NavigationSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+	RemoveInvalidUnits();
+	if (NavData == nullptr || Units.Num() == 0)
+	{
+		return false;
+	}
+
+	const FVector Center = GetSquadCenter();
+	const FPathFindingQuery Query(this, *NavData, Center, Destination);
+	const FPathFindingResult Result = NavigationSystem->FindPathSync(Query);
+	if (!Result.IsSuccessful() || !Result.Path.IsValid())
+	{
+		return false;
+	}
+
+	PathPoints.Reset();
+	PathDistances.Reset();
+	float PathLength = 0.f;
+	for (const FNavPathPoint& PathPoint : Result.Path->GetPathPoints())
+	{
+		if (PathPoints.Num() > 0)
+		{
+			PathLength += FVector::Dist2D(PathPoints.Last(), PathPoint.Location);
+		}
+		PathPoints.Add(PathPoint.Location);
+		PathDistances.Add(PathLength);
+	}
+
+	LeaderDistance = 0.f;
+	LeaderLocation = Center;
+	LeaderDirection = GetDirectionAlongPath(0.f);
+
+	if (bUseFormation)
+	{
+		AssignFormationSlots(PathPoints.Last());
+	}
+	else
+	{
+		for (int32 Index = 0; Index < Units.Num(); ++Index)
+		{
+			UnitOffsets[Index] = ToLeaderFrame(Units[Index]->GetActorLocation() - Center);
+		}
+	}
+
+	// The squad path replaces whatever the units were following on their own.
+	if (IsValid(PawnMovementManager))
+	{
+		for (const UGTCharacterMovementComponent* MovementComponent : UnitMovementComponents)
+		{
+			PawnMovementManager->StopUnit(MovementComponent->GetUnitId());
+		}
+	}
+	return true;
+}
+
+void AGTSquad::AssignFormationSlots(const FVector& Destination)
+{
+	// The formation faces along the last leg of the path, which is how the leader arrives.
+	const FVector ArrivalDirection = GetDirectionAlongPath(PathDistances.Last());
+	Formation.BuildLocalSlots(Units.Num(), ScratchLocalSlots);
+
+	ScratchSlotLocations.Reset(ScratchLocalSlots.Num());
+	for (const FVector2D& LocalSlot : ScratchLocalSlots)
+	{
+		ScratchSlotLocations.Add(Destination + GTFormation::ToWorldOffset(LocalSlot, ArrivalDirection));
+	}
+
+	ScratchUnitLocations.Reset(Units.Num());
+	for (const APawn* Unit : Units)
+	{
+		ScratchUnitLocations.Add(Unit->GetActorLocation());
+	}
+
+	GTFormation::AssignSlots(ScratchUnitLocations, ScratchSlotLocations, ScratchSlotForUnit);
+	for (int32 Index = 0; Index < Units.Num(); ++Index)
+	{
+		UnitOffsets[Index] = ScratchLocalSlots[ScratchSlotForUnit[Index]];
+	}
+}
+
+FVector2D AGTSquad::ToLeaderFrame(const FVector& WorldOffset) const
+{
+	const FVector Right(-LeaderDirection.Y, LeaderDirection.X, 0.f);
+	return FVector2D(FVector::DotProduct(WorldOffset, LeaderDirection), FVector::DotProduct(WorldOffset, Right));
+}
+
+void AGTSquad::StopMovement()
+{
+	PathPoints.Reset();
+	PathDistances.Reset();
+	LeaderDistance = 0.f;
+
+	RemoveInvalidUnits();
+	for (UGTCharacterMovementComponent* MovementComponent : UnitMovementComponents)
+	{
+		MovementComponent->StopActiveMovement();
+	}
+}
+
+FVector AGTSquad::GetLocationAlongPath(float Distance) const
+{
+	for (int32 Index = 1; Index < PathPoints.Num(); ++Index)
+	{
+		if (Distance <= PathDistances[Index])
+		{
+			const float SegmentLength = PathDistances[Index] - PathDistances[Index - 1];
+			const float Alpha = SegmentLength > UE_KINDA_SMALL_NUMBER ? (Distance - PathDistances[Index - 1]) / SegmentLength : 1.f;
+			return FMath::Lerp(PathPoints[Index - 1], PathPoints[Index], Alpha);
+		}
+	}
+	return PathPoints.Last();
+}
+
+FVector AGTSquad::GetDirectionAlongPath(float Distance) const
+{
+	for (int32 Index = 1; Index < PathPoints.Num(); ++Index)
+	{
+		if (Distance <= PathDistances[Index] || Index == PathPoints.Num() - 1)
+		{
+			const FVector Direction = (PathPoints[Index] - PathPoints[Index - 1]).GetSafeNormal2D();
+			if (!Direction.IsNearlyZero())
+			{
+				return Direction;
+			}
+		}
+	}
+	return LeaderDirection;
+}
+
+void AGTSquad::UpdateSquad(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AGTSquad_UpdateSquad);
+	if (PathPoints.Num() == 0 || DeltaTime <= 0.f)
+	{
+		return;
+	}
+
+	RemoveInvalidUnits();
+	float LeaderSpeed = TNumericLimits<float>::Max();
+	float TotalLag = 0.f;
+	for (int32 Index = 0; Index < Units.Num(); ++Index)
+	{
+		LeaderSpeed = FMath::Min(LeaderSpeed, UnitMovementComponents[Index]->GetMaxSpeed());
+		TotalLag += FVector::Dist2D(Units[Index]->GetActorLocation(), LeaderLocation + GTFormation::ToWorldOffset(UnitOffsets[Index], LeaderDirection));
+	}
+
+	// The leader walks at the pace of the slowest unit and waits for the squad when it falls behind.
+	const float AverageLag = Units.Num() > 0 ? TotalLag / Units.Num() : 0.f;
+	const float LeaderPace = FMath::Clamp(1.f - AverageLag / FMath::Max(MaxLeaderLead, 1.f), 0.f, 1.f);
+	const float PathLength = PathDistances.Last();
+	LeaderDistance = FMath::Min(LeaderDistance + LeaderSpeed * LeaderPace * DeltaTime, PathLength);
+	LeaderLocation = GetLocationAlongPath(LeaderDistance);
+
+	// Turning the whole formation at once would sweep the outer slots sideways at corners.
+	const float TargetYaw = GetDirectionAlongPath(LeaderDistance).Rotation().Yaw;
+	const float LeaderYaw = FMath::FixedTurn(LeaderDirection.Rotation().Yaw, TargetYaw, FormationTurnRate * DeltaTime);
+	LeaderDirection = FRotator(0.f, LeaderYaw, 0.f).Vector();
+
+	const bool bLeaderArrived = LeaderDistance >= PathLength;
+	int32 NumArrived = 0;
+
+	for (int32 Index = 0; Index < Units.Num(); ++Index)
+	{
+		UGTCharacterMovementComponent* MovementComponent = UnitMovementComponents[Index];
+		const FVector SlotLocation = LeaderLocation + GTFormation::ToWorldOffset(UnitOffsets[Index], LeaderDirection);
+		const FVector ToSlot = (SlotLocation - Units[Index]->GetActorLocation()) * FVector(1.f, 1.f, 0.f);
+		const float DistanceToSlot = ToSlot.Size();
+
+		if (bLeaderArrived && DistanceToSlot <= AcceptanceRadius)
+		{
+			++NumArrived;
+			continue;
+		}
+
+		const float MaxSpeed = MovementComponent->GetMaxSpeed();
+		const float Speed = MaxSpeed * FMath::Clamp(DistanceToSlot / FMath::Max(SlowDownDistance, 1.f), 0.f, 1.f);
+		PawnMovementManager->RequestUnitVelocity(MovementComponent->GetUnitId(), ToSlot.GetSafeNormal() * Speed);
+	}
+
+	if (bLeaderArrived && NumArrived == Units.Num())
+	{
+		PathPoints.Reset();
+		PathDistances.Reset();
+	}
+}
@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "GTFormation.h"
+#include "GTSquad.generated.h"
+
+class AGTPawnMovementManager;
+class UGTCharacterMovementComponent;
+
+/**
+ * Owns orders and path following for a group of units that have no controller of their own.
+ * One path is found per order and every unit steers towards a virtual leader walking that path, keeping its formation
+ * slot, or the offset it had from the squad center when formations are off, in the leader's frame. Driven by the movement
+ * manager before the units move.
+ */
+UCLASS()
+class GITTEST_API AGTSquad : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AGTSquad();
+
+	/** Adds Unit to the squad, destroying its controller if it has one. */
+	UFUNCTION(BlueprintCallable)
+	void AddUnit(APawn* Unit);
+
+	UFUNCTION(BlueprintCallable)
+	void RemoveUnit(APawn* Unit);
+
+	UFUNCTION(BlueprintCallable)
+	bool MoveTo(const FVector& Destination);
+
+	UFUNCTION(BlueprintCallable)
+	void StopMovement();
+
+	UFUNCTION(BlueprintPure)
+	bool IsMoving() const { return PathPoints.Num() > 0; }
+
+	UFUNCTION(BlueprintPure)
+	FVector GetLeaderLocation() const { return LeaderLocation; }
+
+	void UpdateSquad(float DeltaTime);
+
+	UPROPERTY(BlueprintReadOnly)
+	TArray<APawn*> Units;
+
+	/** Units closer than this to their slot are considered arrived. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float AcceptanceRadius = 50.f;
+
+	/** Units start slowing down when they are this close to their slot. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float SlowDownDistance = 150.f;
+
+	/** The leader waits when the average unit is further than this behind its slot. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MaxLeaderLead = 400.f;
+
+	/** Units take slots of Formation around the destination, otherwise they keep their current spread. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bUseFormation = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FGTFormationLayout Formation;
+
+	/** How fast the formation turns to follow the path, in degrees per second. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float FormationTurnRate = 90.f;
+
+	/** Controllers removed from the world by this squad and their approximate memory. */
+	UFUNCTION(BlueprintPure)
+	int32 GetNumRemovedControllers() const { return NumRemovedControllers; }
+
+	UFUNCTION(BlueprintPure)
+	int64 GetRemovedControllerBytes() const { return RemovedControllerBytes; }
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	UFUNCTION()
+	void OnUnitDestroyed(AActor* DestroyedActor);
+
+	/** Drops units whose pawn or movement component is gone without OnDestroyed, like pawns of an unloaded level. */
+	void RemoveInvalidUnits();
+
+	void RemoveController(APawn* Unit);
+	FVector GetSquadCenter() const;
+	FVector GetLocationAlongPath(float Distance) const;
+	FVector GetDirectionAlongPath(float Distance) const;
+	FVector2D ToLeaderFrame(const FVector& WorldOffset) const;
+	void AssignFormationSlots(const FVector& Destination);
+
+	UPROPERTY()
+	TArray<UGTCharacterMovementComponent*> UnitMovementComponents;
+
+	/** Unit offset from the leader in the leader's frame (X forward, Y right), index matches Units. */
+	TArray<FVector2D> UnitOffsets;
+
+	TArray<FVector> PathPoints;
+	/** Distance along the path at each point, same size as PathPoints. */
+	TArray<float> PathDistances;
+	float LeaderDistance = 0.f;
+	FVector LeaderLocation = FVector::ZeroVector;
+	FVector LeaderDirection = FVector::ForwardVector;
+
+	TArray<FVector2D> ScratchLocalSlots;
+	TArray<FVector> ScratchSlotLocations;
+	TArray<FVector> ScratchUnitLocations;
+	TArray<int32> ScratchSlotForUnit;
+
+	UPROPERTY()
+	AGTPawnMovementManager* PawnMovementManager;
+
+	int32 NumRemovedControllers = 0;
+	int64 RemovedControllerBytes = 0;
+};
@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GTTargetAcquisition.h"
+
+#include "Async/ParallelFor.h"
+#include <atomic>
+
+DECLARE_CYCLE_STAT(TEXT("FGTTargetAcquisition Acquire"), STAT_FGTTargetAcquisition_Acquire, STATGROUP_Game);
+
+namespace GTTargetAcquisition
+{
+	constexpr int32 BatchSize = 256;
+
+	/** Team ids a body can have, NoTeamId itself is not one. */
+	constexpr int32 NumTeams = FGenericTeamId::NoTeamId;
+}
+
+void FGTTargetAcquisition::Acquire(TConstArrayView<FGTTargetingBody> Bodies, TArrayView<int32> OutTargets)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FGTTargetAcquisition_Acquire);
+	using namespace GTTargetAcquisition;
+	check(Bodies.Num() <= OutTargets.Num());
+
+	LastAcquireCycles = 0;
+	SearchingBodies.Reset();
+	int32 TeamStarts[NumTeams + 1] = {};
+	for (int32 Index = 0; Index < Bodies.Num(); ++Index)
+	{
+		const uint8 Team = Bodies[Index].TeamId.GetId();
+		if (Team == FGenericTeamId::NoTeamId)
+		{
+			continue;
+		}
+		++TeamStarts[Team + 1];
+		if (Bodies[Index].bSearching)
+		{
+			SearchingBodies.Add(Index);
+		}
+	}
+	if (SearchingBodies.Num() == 0)
+	{
+		return;
+	}
+
+	// Counting sort by team, so each team's grid is built from one run of the scratch arrays.
+	for (int32 Team = 1; Team <= NumTeams; ++Team)
+	{
+		TeamStarts[Team] += TeamStarts[Team - 1];
+	}
+	int32 TeamCursors[NumTeams];
+	FMemory::Memcpy(TeamCursors, TeamStarts, sizeof(TeamCursors));
+	GridLocations.SetNumUninitialized(TeamStarts[NumTeams], false);
+	GridIds.SetNumUninitialized(TeamStarts[NumTeams], false);
+	for (int32 Index = 0; Index < Bodies.Num(); ++Index)
+	{
+		const uint8 Team = Bodies[Index].TeamId.GetId();
+		if (Team != FGenericTeamId::NoTeamId)
+		{
+			const int32 GridIndex = TeamCursors[Team]++;
+			GridLocations[GridIndex] = FVector(Bodies[Index].Position.X, Bodies[Index].Position.Y, 0.f);
+			GridIds[GridIndex] = Index;
+		}
+	}
+
+	TArray<uint8, TInlineAllocator<8>> PresentTeams;
+	TeamGrids.SetNum(NumTeams);
+	for (int32 Team = 0; Team < NumTeams; ++Team)
+	{
+		const int32 NumTeamBodies = TeamStarts[Team + 1] - TeamStarts[Team];
+		if (NumTeamBodies > 0)
+		{
+			PresentTeams.Add(static_cast<uint8>(Team));
+			TeamGrids[Team].CellSize = CellSize;
+			TeamGrids[Team].Build(MakeArrayView(GridLocations.GetData() + TeamStarts[Team], NumTeamBodies), MakeArrayView(GridIds.GetData() + TeamStarts[Team], NumTeamBodies));
+		}
+	}
+
+	HostileTeams.Reset();
+	HostileStarts.SetNumUninitialized(NumTeams + 1, false);
+	for (int32 Team = 0; Team < NumTeams; ++Team)
+	{
+		HostileStarts[Team] = HostileTeams.Num();
+		if (TeamStarts[Team + 1] == TeamStarts[Team])
+		{
+			continue;
+		}
+		for (const uint8 Other : PresentTeams)
+		{
+			if (FGenericTeamId::GetAttitude(FGenericTeamId(static_cast<uint8>(Team)), FGenericTeamId(Other)) == ETeamAttitude::Hostile)
+			{
+				HostileTeams.Add(Other);
+			}
+		}
+	}
+	HostileStarts[NumTeams] = HostileTeams.Num();
+
+	std::atomic<uint64> Cycles(0);
+	ParallelFor(FMath::DivideAndRoundUp(SearchingBodies.Num(), BatchSize), [this, Bodies, OutTargets, &Cycles](int32 Batch)
+	{
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		const int32 End = FMath::Min(SearchingBodies.Num(), (Batch + 1) * BatchSize);
+		for (int32 Searching = Batch * BatchSize; Searching < End; ++Searching)
+		{
+			const int32 Index = SearchingBodies[Searching];
+			const FGTTargetingBody& Body = Bodies[Index];
+			const uint8 Team = Body.TeamId.GetId();
+
+			// Each hostile team only has to beat the nearest body found in the teams before it.
+			int32 Target = INDEX_NONE;
+			float TargetDistance = Range;
+			for (int32 Hostile = HostileStarts[Team]; Hostile < HostileStarts[Team + 1]; ++Hostile)
+			{
+				const int32 Found = TeamGrids[HostileTeams[Hostile]].FindNearest(FVector2D(Body.Position), TargetDistance);
+				if (Found != INDEX_NONE)
+				{
+					Target = Found;
+					TargetDistance = FVector2f::Distance(Bodies[Found].Position, Body.Position);
+				}
+			}
+			OutTargets[Index] = Target;
+		}
+		Cycles += FPlatformTime::Cycles64() - StartCycles;
+	});
+	LastAcquireCycles = Cycles;
+}
+
+SIZE_T FGTTargetAcquisition::GetAllocatedSize() const
+{
+	SIZE_T Size = TeamGrids.GetAllocatedSize() + HostileTeams.GetAllocatedSize() + HostileStarts.GetAllocatedSize() + GridLocations.GetAllocatedSize()
+		+ GridIds.GetAllocatedSize() + SearchingBodies.GetAllocatedSize();
+	for (const FGTSpatialGrid& Grid : TeamGrids)
+	{
+		Size += Grid.GetAllocatedSize();
+	}
+	return Size;
+}
@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GenericTeamAgentInterface.h"
+#include "GTSpatialGrid.h"
+
+/** A unit as target acquisition sees it, a point on the plane. */
+struct FGTTargetingBody
+{
+	FVector2f Position = FVector2f::ZeroVector;
+	/** Bodies without a team neither search nor are found. */
+	FGenericTeamId TeamId;
+	/** Looks for a target this pass, every body with a team can be found whether it searches or not. */
+	bool bSearching = false;
+};
+
+/**
+ * Finds the closest hostile body in range of many bodies at once. Bodies are bucketed into one grid per team, and
+ * each searching body asks the grids of the teams hostile to it for their nearest entry, in parallel. Which teams are
+ * hostile comes from FGenericTeamId::GetAttitude, worked out once per team pair rather than per body.
+ */
+class GITTEST_API FGTTargetAcquisition
+{
+public:
+	/** Furthest a target is found. */
+	float Range = 1500.f;
+	/** Smallest cell of the team grids. */
+	float CellSize = 500.f;
+
+	/**
+	 * OutTargets[Index] is the index of the hostile body closest to searching body Index within Range, INDEX_NONE if
+	 * there is none. Entries of bodies that do not search are left as they were.
+	 */
+	void Acquire(TConstArrayView<FGTTargetingBody> Bodies, TArrayView<int32> OutTargets);
+
+	/**
+	 * Cycles the workers spent searching the team grids in the last Acquire, zero when no body searched. Bucketing the
+	 * bodies into the grids runs on the calling thread and is not included.
+	 */
+	uint64 GetLastAcquireCycles() const { return LastAcquireCycles; }
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	/** Grid of each team id, only those of teams with bodies are built. */
+	TArray<FGTSpatialGrid> TeamGrids;
+	/** Hostile teams of each team id, HostileTeams[HostileStarts[Team], HostileStarts[Team + 1]). */
+	TArray<uint8> HostileTeams;
+	TArray<int32> HostileStarts;
+	TArray<FVector> GridLocations;
+	TArray<int32> GridIds;
+	TArray<int32> SearchingBodies;
+	uint64 LastAcquireCycles = 0;
+};
@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GTPathBuffer.h"
+#include "GTUnitCommand.generated.h"
+
+UENUM(BlueprintType)
+enum class EGTUnitCommandType : uint8
+{
+	/** Replaces the unit's orders with a move to Target. */
+	Move,
+	/** Drops every order and stops the unit where it is. */
+	Stop,
+	/** Appends Target to the unit's orders, a plain move when it has none. */
+	QueueWaypoint,
+	/** Move that engages enemies met on the way. */
+	AttackMove
+};
+
+/**
+ * Order for one unit, recorded by input or gameplay code and applied by the movement manager at the start of its tick.
+ * Plain data so buffers can be copied, replayed or sent over the network as a block.
+ */
+struct FGTUnitCommand
+{
+	FVector Target = FVector::ZeroVector;
+	int32 UnitId = INDEX_NONE;
+	/** Order in which commands were recorded, keeps commands for the same unit in order when the buffer is sorted. */
+	uint32 Sequence = 0;
+	/** Manager frame the command was applied in, set when it is applied. */
+	uint32 Frame = 0;
+	EGTUnitCommandType Type = EGTUnitCommandType::Move;
+};
+
+static_assert(std::is_trivially_copyable_v<FGTUnitCommand>, "FGTUnitCommand has to stay plain data");
+
+/** Orders of one unit after its current path, the waypoints live in the manager's order queue pool. */
+struct FGTUnitOrderState
+{
+	FGTPathSpan QueuedWaypoints;
+	/** Index of the next queued waypoint, relative to QueuedWaypoints.Offset. */
+	int32 QueueIndex = 0;
+	float AcceptanceRadius = 50.f;
+	bool bAttackMove = false;
+
+	bool HasQueuedWaypoints() const { return QueuedWaypoints.IsSet() && QueueIndex < QueuedWaypoints.Count; }
+};
@@ -0,0 +1,21 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Actor of a unit created by the manager rather than registered by one, one row per character unit in the manager.
+ * Such a unit lives in the manager's rows alone: its hot record holds its transform, velocity and nav state, and its
+ * path, orders and team are the same rows every unit has. An actor of ActorClass is spawned for it only while it
+ * needs one, and destroyed again afterwards without the unit losing anything.
+ */
+struct FGTUnitEntity
+{
+	/** Class spawned for the unit, nullptr for units that registered with an actor of their own and always keep it. */
+	UClass* ActorClass = nullptr;
+	/** Last time the unit needed its actor. */
+	double LastNeededTime = 0.0;
+
+	bool IsEntity() const { return ActorClass != nullptr; }
+};
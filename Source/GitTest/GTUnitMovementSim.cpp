@@ -0,0 +1,175 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GTUnitMovementSim.h"
+
+#include "NavigationData.h"
+#include "GameFramework/CharacterMovementComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("FGTNavHeightfield Build"), STAT_FGTNavHeightfield_Build, STATGROUP_Game);
+DECLARE_CYCLE_STAT(TEXT("FGTUnitMovementSimCallback Simulate"), STAT_FGTUnitMovementSimCallback_Simulate, STATGROUP_Game);
+
+TSharedPtr<const FGTNavHeightfield, ESPMode::ThreadSafe> FGTNavHeightfield::Build(const ANavigationData& NavData, float CellSize)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FGTNavHeightfield_Build);
+
+	const FBox Bounds = NavData.GetBounds();
+	if (!Bounds.IsValid || CellSize <= 0.f)
+	{
+		return nullptr;
+	}
+
+	TSharedPtr<FGTNavHeightfield, ESPMode::ThreadSafe> Heightfield = MakeShared<FGTNavHeightfield, ESPMode::ThreadSafe>();
+	Heightfield->Origin = FVector2f(Bounds.Min.X, Bounds.Min.Y);
+	Heightfield->CellSize = CellSize;
+	Heightfield->SizeX = FMath::Max(FMath::CeilToInt((Bounds.Max.X - Bounds.Min.X) / CellSize), 1);
+	Heightfield->SizeY = FMath::Max(FMath::CeilToInt((Bounds.Max.Y - Bounds.Min.Y) / CellSize), 1);
+
+	// Built once per navmesh rebuild rather than per frame, so the workload lives on the heap instead of the frame arena.
+	TArray<FNavigationProjectionWork> Workload;
+	Workload.Reserve(Heightfield->SizeX * Heightfield->SizeY);
+	for (int32 Y = 0; Y < Heightfield->SizeY; ++Y)
+	{
+		for (int32 X = 0; X < Heightfield->SizeX; ++X)
+		{
+			Workload.Emplace(FVector(Bounds.Min.X + (X + 0.5f) * CellSize, Bounds.Min.Y + (Y + 0.5f) * CellSize, Bounds.GetCenter().Z));
+		}
+	}
+	NavData.BatchProjectPoints(Workload, FVector(CellSize * 0.5f, CellSize * 0.5f, Bounds.GetExtent().Z + 100.f));
+
+	Heightfield->Heights.SetNumUninitialized(Workload.Num());
+	for (int32 Index = 0; Index < Workload.Num(); ++Index)
+	{
+		Heightfield->Heights[Index] = Workload[Index].bResult ? Workload[Index].OutLocation.Location.Z : NoGround;
+	}
+	return Heightfield;
+}
+
+bool FGTNavHeightfield::GetHeight(const FVector2f& Location, float& OutHeight) const
+{
+	const int32 X = FMath::FloorToInt((Location.X - Origin.X) / CellSize);
+	const int32 Y = FMath::FloorToInt((Location.Y - Origin.Y) / CellSize);
+	if (X < 0 || Y < 0 || X >= SizeX || Y >= SizeY)
+	{
+		return false;
+	}
+
+	OutHeight = Heights[Y * SizeX + X];
+	return OutHeight != NoGround;
+}
+
+void FGTUnitMovementSimCallback::OnPreSimulate_Internal()
+{
+	SCOPE_CYCLE_COUNTER(STAT_FGTUnitMovementSimCallback_Simulate);
+
+	if (const FGTUnitMovementSimInput* Input = GetConsumerInput_Internal())
+	{
+		ApplyInput(*Input);
+	}
+
+	FGTUnitMovementSimOutput& Output = GetProducerOutputData_Internal();
+	const float DeltaTime = GetDeltaTime_Internal();
+	if (!Heightfield.IsValid() || DeltaTime < UCharacterMovementComponent::MIN_TICK_TIME)
+	{
+		return;
+	}
+
+	for (int32 Slot = 0; Slot < States.Num();)
+	{
+		FGTUnitMovementHot& State = States[Slot];
+		const bool bWasMoving = !State.Velocity.IsZero();
+		const FVector3f Velocity = State.CalcNavWalkingVelocity(DeltaTime);
+		const FVector3f Delta = Velocity * DeltaTime;
+		if (Delta.IsNearlyZero())
+		{
+			// Stopping is reported once, units standing still cost nothing to marshal.
+			State.Velocity = FVector3f::ZeroVector;
+			if (bWasMoving)
+			{
+				Output.UnitIds.Add(UnitIds[Slot]);
+				Output.Generations.Add(Generations[Slot]);
+				Output.Locations.Add(State.Location);
+				Output.Velocities.Add(State.Velocity);
+			}
+			++Slot;
+			continue;
+		}
+
+		const FVector2f NewLocation2D(State.Location.X + Delta.X, State.Location.Y + Delta.Y);
+		float Height;
+		if (!Heightfield->GetHeight(NewLocation2D, Height))
+		{
+			Output.LeftNavMeshUnitIds.Add(UnitIds[Slot]);
+			Output.LeftNavMeshGenerations.Add(Generations[Slot]);
+			RemoveUnit(UnitIds[Slot]);
+			continue;
+		}
+
+		// Same as PhysNavWalking, velocity reflects the move that was made.
+		State.Location = FVector3f(NewLocation2D.X, NewLocation2D.Y, Height);
+		State.Velocity = FVector3f(Delta.X, Delta.Y, 0.f) / DeltaTime;
+		Output.UnitIds.Add(UnitIds[Slot]);
+		Output.Generations.Add(Generations[Slot]);
+		Output.Locations.Add(State.Location);
+		Output.Velocities.Add(State.Velocity);
+		++Slot;
+	}
+}
+
+void FGTUnitMovementSimCallback::ApplyInput(const FGTUnitMovementSimInput& Input)
+{
+	if (Input.Heightfield.IsValid())
+	{
+		Heightfield = Input.Heightfield;
+	}
+
+	for (const int32 UnitId : Input.RemovedUnitIds)
+	{
+		RemoveUnit(UnitId);
+	}
+
+	for (int32 Index = 0; Index < Input.AddedUnitIds.Num(); ++Index)
+	{
+		AddUnit(Input.AddedUnitIds[Index], Input.AddedGenerations[Index], Input.AddedStates[Index]);
+	}
+
+	for (int32 Index = 0; Index < Input.RequestUnitIds.Num(); ++Index)
+	{
+		const int32 UnitId = Input.RequestUnitIds[Index];
+		if (UnitSlots.IsValidIndex(UnitId) && UnitSlots[UnitId] != INDEX_NONE)
+		{
+			States[UnitSlots[UnitId]].RequestedVelocity = Input.RequestedVelocities[Index];
+		}
+	}
+}
+
+void FGTUnitMovementSimCallback::AddUnit(int32 UnitId, uint32 Generation, const FGTUnitMovementHot& State)
+{
+	RemoveUnit(UnitId);
+	while (UnitSlots.Num() <= UnitId)
+	{
+		UnitSlots.Add(INDEX_NONE);
+	}
+
+	UnitSlots[UnitId] = States.Add(State);
+	UnitIds.Add(UnitId);
+	Generations.Add(Generation);
+}
+
+void FGTUnitMovementSimCallback::RemoveUnit(int32 UnitId)
+{
+	const int32 Slot = UnitSlots.IsValidIndex(UnitId) ? UnitSlots[UnitId] : INDEX_NONE;
+	if (Slot == INDEX_NONE)
+	{
+		return;
+	}
+
+	UnitSlots[UnitId] = INDEX_NONE;
+	States.RemoveAtSwap(Slot, 1, false);
+	UnitIds.RemoveAtSwap(Slot, 1, false);
+	Generations.RemoveAtSwap(Slot, 1, false);
+	if (UnitIds.IsValidIndex(Slot))
+	{
+		UnitSlots[UnitIds[Slot]] = Slot;
+	}
+}
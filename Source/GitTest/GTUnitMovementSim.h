@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Chaos/SimCallbackInput.h"
+#include "Chaos/SimCallbackObject.h"
+#include "GTUnitMovementState.h"
+
+class ANavigationData;
+
+/**
+ * Navmesh heights sampled on a regular grid, immutable once built so the physics thread can read it while the game
+ * thread attaches rebuilt navmesh tiles. One layer per cell, like FGTGroundQuery.
+ */
+class GITTEST_API FGTNavHeightfield
+{
+public:
+	/** Samples every cell of NavData's bounds in one batch query, nullptr without bounds. */
+	static TSharedPtr<const FGTNavHeightfield, ESPMode::ThreadSafe> Build(const ANavigationData& NavData, float CellSize);
+
+	/** Height of the navmesh in the cell containing Location, false off the navmesh. */
+	bool GetHeight(const FVector2f& Location, float& OutHeight) const;
+
+	SIZE_T GetAllocatedSize() const { return Heights.GetAllocatedSize(); }
+
+private:
+	static constexpr float NoGround = -UE_BIG_NUMBER;
+
+	FVector2f Origin = FVector2f::ZeroVector;
+	float CellSize = 100.f;
+	int32 SizeX = 0;
+	int32 SizeY = 0;
+	TArray<float> Heights;
+};
+
+/** Everything the game thread sends for one frame. Removals are applied before additions, additions before requests. */
+struct FGTUnitMovementSimInput : public Chaos::FSimCallbackInput
+{
+	/** Units the simulation takes over, or takes over again after their record was read from the component. */
+	TArray<FGTUnitMovementHot, TAlignedHeapAllocator<alignof(FGTUnitMovementHot)>> AddedStates;
+	TArray<int32> AddedUnitIds;
+	TArray<uint32> AddedGenerations;
+
+	TArray<int32> RemovedUnitIds;
+
+	/** Requested velocity of every simulated unit, zero brakes. Kept for the steps until the next input arrives. */
+	TArray<int32> RequestUnitIds;
+	TArray<FVector3f> RequestedVelocities;
+
+	/** Set when the navmesh changed, the simulation keeps the last one it received. */
+	TSharedPtr<const FGTNavHeightfield, ESPMode::ThreadSafe> Heightfield;
+
+	void Reset()
+	{
+		AddedStates.Reset();
+		AddedUnitIds.Reset();
+		AddedGenerations.Reset();
+		RemovedUnitIds.Reset();
+		RequestUnitIds.Reset();
+		RequestedVelocities.Reset();
+		Heightfield.Reset();
+	}
+};
+
+/** Units moved by one physics step. Generation tells an output for a recycled unit id apart from one for its new unit. */
+struct FGTUnitMovementSimOutput : public Chaos::FSimCallbackOutput
+{
+	TArray<int32> UnitIds;
+	TArray<uint32> Generations;
+	TArray<FVector3f> Locations;
+	TArray<FVector3f> Velocities;
+
+	/** Units that walked off the heightfield, the simulation dropped them and their component takes over. */
+	TArray<int32> LeftNavMeshUnitIds;
+	TArray<uint32> LeftNavMeshGenerations;
+
+	void Reset()
+	{
+		UnitIds.Reset();
+		Generations.Reset();
+		Locations.Reset();
+		Velocities.Reset();
+		LeftNavMeshUnitIds.Reset();
+		LeftNavMeshGenerations.Reset();
+	}
+};
+
+/**
+ * Nav walking for the movement manager's hot units on the physics thread, before each physics step. The simulation
+ * owns the location and velocity of every unit it was given, and reports the units that moved; the game thread only
+ * packs requested velocities and writes transforms back.
+ */
+class GITTEST_API FGTUnitMovementSimCallback : public Chaos::TSimCallbackObject<FGTUnitMovementSimInput, FGTUnitMovementSimOutput>
+{
+public:
+	int32 GetNumUnits_Internal() const { return States.Num(); }
+
+private:
+	virtual void OnPreSimulate_Internal() override;
+
+	void ApplyInput(const FGTUnitMovementSimInput& Input);
+	void AddUnit(int32 UnitId, uint32 Generation, const FGTUnitMovementHot& State);
+	void RemoveUnit(int32 UnitId);
+
+	/** Same layout as the manager's rows: dense states, and a slot per unit id. */
+	TArray<FGTUnitMovementHot, TAlignedHeapAllocator<alignof(FGTUnitMovementHot)>> States;
+	TArray<int32> UnitIds;
+	TArray<uint32> Generations;
+	TArray<int32> UnitSlots;
+
+	TSharedPtr<const FGTNavHeightfield, ESPMode::ThreadSafe> Heightfield;
+};
@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "GenericTeamAgentInterface.h"
+
+/**
+ * Everything the nav walking update reads and writes for one unit, packed into a single cache line.
+ * The character movement component stays the cold storage: it is read when the unit's movement mode or parameters
+ * change, and written once per update with the resulting velocity for animation.
+ *
+ * Updating a unit through UCharacterMovementComponent::PerformMovement touches the component, its owner, the capsule
+ * and the controller, a dozen or more scattered cache lines out of a component several kilobytes large
+ * (GT.Benchmark.MovementState prints the sizes). The hot update reads this record and touches the capsule transform it
+ * moves and the component's Velocity it writes back.
+ */
+struct alignas(PLATFORM_CACHE_LINE_SIZE) FGTUnitMovementHot
+{
+	enum EFlags : uint32
+	{
+		/** Moved by the manager's nav walking update rather than the component's PerformMovement. */
+		NavWalking = 1 << 0,
+		/** Cold state changed, the record is read again from the component before the next update. */
+		Dirty = 1 << 1,
+		/** Owned by the physics thread simulation, Location and Velocity are what it last reported. */
+		Simulated = 1 << 2,
+	};
+
+	/** Poly the unit stood on after its last move. */
+	NavNodeRef NodeRef = INVALID_NAVNODEREF;
+	FVector3f Location = FVector3f::ZeroVector;
+	FVector3f Velocity = FVector3f::ZeroVector;
+	/** Velocity asked for by path following or a squad, acceleration is along it at MaxAcceleration. */
+	FVector3f RequestedVelocity = FVector3f::ZeroVector;
+	float MaxSpeed = 0.f;
+	float MaxAcceleration = 0.f;
+	float GroundFriction = 0.f;
+	float BrakingDeceleration = 0.f;
+	uint32 Flags = Dirty;
+
+	bool IsNavWalking() const { return (Flags & (NavWalking | Dirty)) == NavWalking; }
+
+	/**
+	 * CalcVelocity for a requested move without root motion or avoidance: friction turns the velocity towards the
+	 * requested direction, acceleration brings it up to the requested speed, and no request brakes.
+	 */
+	FVector3f CalcNavWalkingVelocity(float DeltaTime) const
+	{
+		FVector3f NewVelocity(Velocity.X, Velocity.Y, 0.f);
+		const FVector3f Requested(RequestedVelocity.X, RequestedVelocity.Y, 0.f);
+		const float RequestedSpeed = FMath::Min(Requested.Size(), MaxSpeed);
+		if (RequestedSpeed > UE_KINDA_SMALL_NUMBER)
+		{
+			const FVector3f Direction = Requested.GetUnsafeNormal();
+			NewVelocity -= (NewVelocity - Direction * NewVelocity.Size()) * FMath::Min(DeltaTime * GroundFriction, 1.f);
+			return (NewVelocity + Direction * MaxAcceleration * DeltaTime).GetClampedToMaxSize(RequestedSpeed);
+		}
+
+		if (!NewVelocity.IsZero())
+		{
+			const FVector3f OldVelocity = NewVelocity;
+			const FVector3f Braking = -GroundFriction * NewVelocity - BrakingDeceleration * NewVelocity.GetUnsafeNormal();
+			NewVelocity += Braking * DeltaTime;
+			if ((NewVelocity | OldVelocity) <= 0.f || NewVelocity.SizeSquared() < UE_KINDA_SMALL_NUMBER)
+			{
+				NewVelocity = FVector3f::ZeroVector;
+			}
+		}
+		return NewVelocity;
+	}
+};
+
+/** Shape and team of a unit, read from its component along with its hot record. */
+struct FGTUnitBody
+{
+	float Radius = 0.f;
+	FGenericTeamId TeamId;
+};
+
+static_assert(sizeof(FGTUnitMovementHot) == PLATFORM_CACHE_LINE_SIZE, "FGTUnitMovementHot has to fit in one cache line");
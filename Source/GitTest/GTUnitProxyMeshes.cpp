@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GTUnitProxyMeshes.h"
+
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/StaticMesh.h"
+
+DECLARE_CYCLE_STAT(TEXT("FGTUnitProxyMeshes CommitInstances"), STAT_FGTUnitProxyMeshes_CommitInstances, STATGROUP_Game);
+
+void FGTUnitProxyMeshes::SetProxy(FGTUnitProxy& Unit, UStaticMesh& StaticMesh, AActor& Owner)
+{
+	Unit.Type = FindOrAddType(StaticMesh, Owner);
+	Unit.MeshTransform = Unit.Mesh->GetRelativeTransform();
+	Unit.Yaw = Unit.Mesh->GetOwner()->GetActorRotation().Yaw;
+	Unit.Mesh->UnregisterComponent();
+}
+
+int32 FGTUnitProxyMeshes::FindOrAddType(UStaticMesh& StaticMesh, AActor& Owner)
+{
+	if (const int32* TypeIndex = TypeIndices.Find(&StaticMesh))
+	{
+		return *TypeIndex;
+	}
+
+	UInstancedStaticMeshComponent* Component = NewObject<UInstancedStaticMeshComponent>(&Owner);
+	Component->SetStaticMesh(&StaticMesh);
+	Component->SetMobility(EComponentMobility::Movable);
+	Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Component->SetCanEverAffectNavigation(false);
+	Component->RegisterComponent();
+
+	const int32 TypeIndex = Types.Num();
+	Types.AddDefaulted_GetRef().Component = Component;
+	TypeIndices.Add(&StaticMesh, TypeIndex);
+	return TypeIndex;
+}
+
+void FGTUnitProxyMeshes::SetFullActor(FGTUnitProxy& Unit) const
+{
+	Unit.Type = INDEX_NONE;
+	if (IsValid(Unit.Mesh) && !Unit.Mesh->IsRegistered())
+	{
+		Unit.Mesh->RegisterComponent();
+	}
+}
+
+void FGTUnitProxyMeshes::AddInstance(const FGTUnitProxy& Unit, const FVector& Location)
+{
+	Types[Unit.Type].Transforms.Add(Unit.MeshTransform * FTransform(FRotator(0.f, Unit.Yaw, 0.f), Location));
+}
+
+void FGTUnitProxyMeshes::CommitInstances()
+{
+	SCOPE_CYCLE_COUNTER(STAT_FGTUnitProxyMeshes_CommitInstances);
+	for (FType& Type : Types)
+	{
+		UInstancedStaticMeshComponent* Component = Type.Component;
+		if (!IsValid(Component))
+		{
+			Type.Transforms.Reset();
+			continue;
+		}
+
+		// Only the tail changes size, removing the last instances does not shift the others.
+		const int32 NumInstances = Component->GetInstanceCount();
+		if (Type.Transforms.Num() > NumInstances)
+		{
+			// AddInstances only takes a whole array, the new tail is copied into one kept across commits.
+			ScratchAddedInstances.Reset();
+			ScratchAddedInstances.Append(Type.Transforms.GetData() + NumInstances, Type.Transforms.Num() - NumInstances);
+			Component->AddInstances(ScratchAddedInstances, false, true);
+		}
+		else if (Type.Transforms.Num() < NumInstances)
+		{
+			ScratchRemovedInstances.Reset();
+			for (int32 Instance = NumInstances - 1; Instance >= Type.Transforms.Num(); --Instance)
+			{
+				ScratchRemovedInstances.Add(Instance);
+			}
+			Component->RemoveInstances(ScratchRemovedInstances);
+		}
+
+		if (Type.Transforms.Num() > 0)
+		{
+			Component->BatchUpdateInstancesTransforms(0, Type.Transforms, /*bWorldSpace=*/true, /*bMarkRenderStateDirty=*/true, /*bTeleport=*/true);
+		}
+		Type.Transforms.Reset();
+	}
+}
+
+void FGTUnitProxyMeshes::Reset()
+{
+	for (const FType& Type : Types)
+	{
+		if (IsValid(Type.Component))
+		{
+			Type.Component->DestroyComponent();
+		}
+	}
+	Types.Reset();
+	TypeIndices.Reset();
+}
+
+int32 FGTUnitProxyMeshes::GetNumInstances() const
+{
+	int32 NumInstances = 0;
+	for (const FType& Type : Types)
+	{
+		NumInstances += IsValid(Type.Component) ? Type.Component->GetInstanceCount() : 0;
+	}
+	return NumInstances;
+}
+
+void FGTUnitProxyMeshes::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	for (FType& Type : Types)
+	{
+		Collector.AddReferencedObject(Type.Component);
+	}
+}
@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AActor;
+class UInstancedStaticMeshComponent;
+class USkeletalMeshComponent;
+class UStaticMesh;
+
+/** How one unit is drawn, one row per character unit in the manager. */
+struct FGTUnitProxy
+{
+	/** The unit's skeletal mesh, nullptr while the unit has no actor and is always drawn as a proxy. */
+	USkeletalMeshComponent* Mesh = nullptr;
+	/** Instanced mesh the unit is drawn by while it is a proxy, INDEX_NONE while its own mesh is registered. */
+	int32 Type = INDEX_NONE;
+	/** Facing of the proxy, kept while the unit stands still. */
+	float Yaw = 0.f;
+	/** Where the unit's mesh sits relative to the unit, the proxy is placed the same way. */
+	FTransform MeshTransform = FTransform::Identity;
+
+	bool IsProxy() const { return Type != INDEX_NONE; }
+};
+
+/**
+ * Draws units as instances of one instanced static mesh per unit type instead of their skeletal meshes.
+ * A proxy unit's skeletal mesh is unregistered, so it has no scene proxy, bone transforms or tick. Every frame the
+ * transforms of the proxies are gathered from the manager's arrays and each instanced mesh is updated in one call;
+ * instance I of a type is simply the I-th proxy gathered for it, no instance is tied to a unit.
+ */
+class GITTEST_API FGTUnitProxyMeshes
+{
+public:
+	/** Unregisters the unit's mesh and draws it with StaticMesh, whose instanced mesh is created on Owner if needed. */
+	void SetProxy(FGTUnitProxy& Unit, UStaticMesh& StaticMesh, AActor& Owner);
+
+	/** Type drawing StaticMesh, for units drawn without a mesh of their own. */
+	int32 FindOrAddType(UStaticMesh& StaticMesh, AActor& Owner);
+
+	/** Registers the unit's mesh again. */
+	void SetFullActor(FGTUnitProxy& Unit) const;
+
+	/** Adds a proxy unit standing at Location this frame. */
+	void AddInstance(const FGTUnitProxy& Unit, const FVector& Location);
+
+	/** Hands every instanced mesh the transforms added since the last commit. */
+	void CommitInstances();
+
+	/** Destroys every instanced mesh. Proxy units have to be set back to full actors first. */
+	void Reset();
+
+	int32 GetNumTypes() const { return Types.Num(); }
+	int32 GetNumInstances() const;
+
+	void AddReferencedObjects(FReferenceCollector& Collector);
+
+private:
+	struct FType
+	{
+		UInstancedStaticMeshComponent* Component = nullptr;
+		/** Gathered since the last commit, reused so a steady crowd allocates nothing. */
+		TArray<FTransform> Transforms;
+	};
+
+	TArray<FType> Types;
+	TMap<const UStaticMesh*, int32> TypeIndices;
+	TArray<FTransform> ScratchAddedInstances;
+	TArray<int32> ScratchRemovedInstances;
+};
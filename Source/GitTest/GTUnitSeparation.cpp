@@ -0,0 +1,169 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GTUnitSeparation.h"
+#include "GTFrameArena.h"
+
+#include "Async/ParallelFor.h"
+#include <atomic>
+
+DECLARE_CYCLE_STAT(TEXT("FGTUnitSeparation Solve"), STAT_FGTUnitSeparation_Solve, STATGROUP_Game);
+
+namespace GTUnitSeparation
+{
+	constexpr int32 BatchSize = 256;
+
+	/** Direction to split two units standing on the same spot, opposite for each of the two. */
+	FVector2f TieBreakDirection(int32 Index, int32 Other)
+	{
+		const uint32 Hash = HashCombine(GetTypeHash(FMath::Min(Index, Other)), GetTypeHash(FMath::Max(Index, Other)));
+		const float Angle = (Hash & 0xffff) * (UE_TWO_PI / 65536.f);
+		const FVector2f Direction(FMath::Cos(Angle), FMath::Sin(Angle));
+		return Index < Other ? Direction : -Direction;
+	}
+
+	float MaxRadius(TConstArrayView<FGTSeparationBody> Bodies)
+	{
+		float Radius = 0.f;
+		for (const FGTSeparationBody& Body : Bodies)
+		{
+			Radius = FMath::Max(Radius, Body.Radius);
+		}
+		return Radius;
+	}
+}
+
+void FGTUnitSeparation::Solve(TConstArrayView<FGTSeparationBody> Bodies, int32 NumMovable, TArrayView<FVector2f> OutPushes)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FGTUnitSeparation_Solve);
+	check(NumMovable <= Bodies.Num() && NumMovable <= OutPushes.Num());
+
+	LastSolveCycles = 0;
+	for (int32 Index = 0; Index < NumMovable; ++Index)
+	{
+		OutPushes[Index] = FVector2f::ZeroVector;
+	}
+	if (NumMovable == 0 || Iterations <= 0)
+	{
+		return;
+	}
+
+	GridLocations.SetNumUninitialized(Bodies.Num(), false);
+	GridIds.SetNumUninitialized(Bodies.Num(), false);
+	for (int32 Index = 0; Index < Bodies.Num(); ++Index)
+	{
+		GridLocations[Index] = FVector(Bodies[Index].Position.X, Bodies[Index].Position.Y, 0.f);
+		GridIds[Index] = Index;
+	}
+
+	const float MaxRadius = GTUnitSeparation::MaxRadius(Bodies);
+	Grid.CellSize = FMath::Max(MaxRadius * 2.f, 1.f);
+	Grid.Build(GridLocations, GridIds);
+
+	FGTFrameArenaScope ArenaScope;
+	TGTFrameArray<FVector2f> Positions;
+	Positions.SetNumUninitialized(NumMovable);
+	for (int32 Index = 0; Index < NumMovable; ++Index)
+	{
+		Positions[Index] = Bodies[Index].Position;
+	}
+	TGTFrameArray<FVector2f> NewPositions;
+	NewPositions.SetNumUninitialized(NumMovable);
+
+	const auto GetShare = [this](const FGTSeparationBody& Body, const FGTSeparationBody& Other, bool bOtherMovable)
+	{
+		if (!bOtherMovable)
+		{
+			return 1.f;
+		}
+		if (Body.TeamId != Other.TeamId || Body.bMoving == Other.bMoving)
+		{
+			return 0.5f;
+		}
+		return Body.bMoving ? 1.f / (1.f + FriendlyPushRatio) : FriendlyPushRatio / (1.f + FriendlyPushRatio);
+	};
+
+	// Units move a little during the iterations, so neighbours are looked for a bit further than they could touch.
+	const float QueryMargin = MaxRadius * 0.5f;
+	std::atomic<uint64> Cycles{0};
+	for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+	{
+		ParallelFor(FMath::DivideAndRoundUp(NumMovable, GTUnitSeparation::BatchSize), [&](int32 Batch)
+		{
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			const int32 End = FMath::Min(NumMovable, (Batch + 1) * GTUnitSeparation::BatchSize);
+			for (int32 Index = Batch * GTUnitSeparation::BatchSize; Index < End; ++Index)
+			{
+				const FGTSeparationBody& Body = Bodies[Index];
+				const FVector2f Position = Positions[Index];
+				FVector2f Correction = FVector2f::ZeroVector;
+				Grid.ForEachInRadius(Position, Body.Radius + MaxRadius + QueryMargin, [&](int32 Other)
+				{
+					if (Other == Index)
+					{
+						return;
+					}
+
+					const FGTSeparationBody& OtherBody = Bodies[Other];
+					const bool bOtherMovable = Other < NumMovable;
+					const FVector2f Offset = Position - (bOtherMovable ? Positions[Other] : OtherBody.Position);
+					const float MinDistance = Body.Radius + OtherBody.Radius;
+					const float DistanceSquared = Offset.SizeSquared();
+					if (DistanceSquared >= FMath::Square(MinDistance))
+					{
+						return;
+					}
+
+					const float Distance = FMath::Sqrt(DistanceSquared);
+					const FVector2f Direction = Distance > UE_KINDA_SMALL_NUMBER ? Offset / Distance : GTUnitSeparation::TieBreakDirection(Index, Other);
+					Correction += Direction * (MinDistance - Distance) * GetShare(Body, OtherBody, bOtherMovable);
+				});
+				NewPositions[Index] = Position + Correction * Stiffness;
+			}
+			Cycles += FPlatformTime::Cycles64() - StartCycles;
+		});
+		FMemory::Memcpy(Positions.GetData(), NewPositions.GetData(), NumMovable * sizeof(FVector2f));
+	}
+
+	for (int32 Index = 0; Index < NumMovable; ++Index)
+	{
+		OutPushes[Index] = Positions[Index] - Bodies[Index].Position;
+	}
+	LastSolveCycles = Cycles;
+}
+
+float FGTUnitSeparation::MeasureOverlap(TConstArrayView<FGTSeparationBody> Bodies, TConstArrayView<FVector2f> Pushes)
+{
+	FGTFrameArenaScope ArenaScope;
+	TGTFrameArray<FVector2f> Positions;
+	TGTFrameArray<FVector> Locations;
+	TGTFrameArray<int32> Ids;
+	Positions.SetNumUninitialized(Bodies.Num());
+	Locations.SetNumUninitialized(Bodies.Num());
+	Ids.SetNumUninitialized(Bodies.Num());
+	for (int32 Index = 0; Index < Bodies.Num(); ++Index)
+	{
+		Positions[Index] = Bodies[Index].Position + (Pushes.IsValidIndex(Index) ? Pushes[Index] : FVector2f::ZeroVector);
+		Locations[Index] = FVector(Positions[Index].X, Positions[Index].Y, 0.f);
+		Ids[Index] = Index;
+	}
+
+	const float MaxRadius = GTUnitSeparation::MaxRadius(Bodies);
+	FGTSpatialGrid OverlapGrid;
+	OverlapGrid.CellSize = FMath::Max(MaxRadius * 2.f, 1.f);
+	OverlapGrid.Build(Locations, Ids);
+
+	float Overlap = 0.f;
+	for (int32 Index = 0; Index < Bodies.Num(); ++Index)
+	{
+		OverlapGrid.ForEachInRadius(Positions[Index], Bodies[Index].Radius + MaxRadius, [&](int32 Other)
+		{
+			// Each pair once.
+			if (Other > Index)
+			{
+				Overlap += FMath::Max(0.f, Bodies[Index].Radius + Bodies[Other].Radius - FVector2f::Distance(Positions[Index], Positions[Other]));
+			}
+		});
+	}
+	return Overlap;
+}
@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GenericTeamAgentInterface.h"
+#include "GTSpatialGrid.h"
+
+/** A unit as the separation pass sees it, a circle on the plane. */
+struct FGTSeparationBody
+{
+	FVector2f Position = FVector2f::ZeroVector;
+	float Radius = 0.f;
+	FGenericTeamId TeamId;
+	/** Walking somewhere this frame. Idle units give way to moving units of their own team. */
+	bool bMoving = false;
+};
+
+/**
+ * Pushes overlapping units apart on the plane, in place of sweeping capsules against each other. A position-based
+ * relaxation: every iteration moves each unit by its share of the overlaps with its neighbours, found in a grid built
+ * once from the starting positions. Each iteration reads the positions of the one before, so units are solved in
+ * parallel. Units of the same team push each other, a moving unit shoving idle friends out of its way; units of other
+ * teams block each other evenly. Nothing here knows the navmesh, the caller keeps the pushed units on it.
+ */
+class GITTEST_API FGTUnitSeparation
+{
+public:
+	int32 Iterations = 3;
+	/** Share of the overlap resolved per iteration. */
+	float Stiffness = 0.5f;
+	/** How much more an idle unit gives way to a moving unit of its team than the other way round. */
+	float FriendlyPushRatio = 4.f;
+
+	/**
+	 * Bodies [0, NumMovable) are moved, the rest are obstacles that stay where they are. OutPushes[Index] is how far
+	 * movable body Index was pushed.
+	 */
+	void Solve(TConstArrayView<FGTSeparationBody> Bodies, int32 NumMovable, TArrayView<FVector2f> OutPushes);
+
+	/** Cycles the workers spent pushing bodies apart in the last Solve, which the manager counts as task thread time. */
+	uint64 GetLastSolveCycles() const { return LastSolveCycles; }
+
+	/** Sum of the overlap depths between every pair of bodies, for benchmarks. */
+	static float MeasureOverlap(TConstArrayView<FGTSeparationBody> Bodies, TConstArrayView<FVector2f> Pushes);
+
+private:
+	FGTSpatialGrid Grid;
+	TArray<FVector> GridLocations;
+	TArray<int32> GridIds;
+	uint64 LastSolveCycles = 0;
+};
@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GTUnitSignificance.h"
+
+#include "SceneManagement.h"
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/PlayerController.h"
+#include "Kismet/GameplayStatics.h"
+
+bool FGTSignificanceScorer::SetView(const APlayerController& PlayerController)
+{
+	bHasView = false;
+	if (PlayerController.PlayerCameraManager == nullptr)
+	{
+		return false;
+	}
+
+	const FMinimalViewInfo& ViewInfo = PlayerController.PlayerCameraManager->GetCameraCacheView();
+	FMatrix ViewMatrix;
+	FMatrix ViewProjectionMatrix;
+	UGameplayStatics::GetViewProjectionMatrix(ViewInfo, ViewMatrix, ProjectionMatrix, ViewProjectionMatrix);
+	GetViewFrustumBounds(ViewFrustum, ViewProjectionMatrix, false);
+	ViewOrigin = ViewInfo.Location;
+	bHasView = true;
+	return true;
+}
+
+float FGTSignificanceScorer::Score(const FGTSignificanceFactors& Factors) const
+{
+	float Score = 0.f;
+	if (bHasView && ViewFrustum.IntersectSphere(Factors.Location, Factors.Radius))
+	{
+		Score += ScreenSizeWeight * ComputeBoundsScreenSize(Factors.Location, Factors.Radius, ViewOrigin, ProjectionMatrix);
+	}
+	Score += Factors.bSelected ? SelectedBonus : 0.f;
+	Score += Factors.bInCombat ? CombatBonus : 0.f;
+	Score += Factors.bOwnedByPlayer ? OwnedBonus : 0.f;
+	return Score;
+}
+
+int32 FGTSignificanceScorer::PickBucket(TConstArrayView<FGTSignificanceBudget> Budgets, TConstArrayView<FGTSignificanceBucketUsage> Usage, float Score, int32& OutOverflowed)
+{
+	OutOverflowed = INDEX_NONE;
+	const int32 LastBucket = Budgets.Num() - 1;
+	for (int32 Bucket = 0; Bucket < LastBucket; ++Bucket)
+	{
+		const FGTSignificanceBudget& Budget = Budgets[Bucket];
+		if (Score < Budget.MinSignificance)
+		{
+			continue;
+		}
+		if (Budget.MaxUnits <= 0 || Usage[Bucket].Units < Budget.MaxUnits)
+		{
+			return Bucket;
+		}
+		if (OutOverflowed == INDEX_NONE)
+		{
+			OutOverflowed = Bucket;
+		}
+	}
+	return FMath::Max(LastBucket, 0);
+}
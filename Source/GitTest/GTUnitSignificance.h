@@ -0,0 +1,140 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ConvexVolume.h"
+#include "GTUnitSignificance.generated.h"
+
+class APlayerController;
+
+UENUM(BlueprintType)
+enum class EGTAvoidanceQuality : uint8
+{
+	/** Walks through other units, nothing is solved for it. */
+	None,
+	/** Pushed apart from its neighbours as a circle, see FGTUnitSeparation. */
+	Separation,
+	/** The component's RVO avoidance, which steers ahead of contact but moves the unit through PerformMovement. */
+	RVO
+};
+
+UENUM(BlueprintType)
+enum class EGTNavProjection : uint8
+{
+	/** Every move is projected onto the navmesh, which also tracks the poly the unit stands on. */
+	NavMesh,
+	/** Heights come from the navmesh heightfield, the navmesh is only queried where the heightfield has no ground. */
+	Heightfield
+};
+
+/** What a unit in one significance bucket gets to spend on its update. */
+USTRUCT(BlueprintType)
+struct GITTEST_API FGTSignificanceBudget
+{
+	GENERATED_BODY()
+
+	/** Units scoring at least this fall in the bucket while it has room. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MinSignificance = 0.f;
+
+	/** Most units the bucket holds, 0 for no limit. Units past it fall to the next bucket. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 MaxUnits = 0;
+
+	/** Hot nav walking units move every this many frames, over the time since their last move. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 MovementUpdateInterval = 1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EGTAvoidanceQuality Avoidance = EGTAvoidanceQuality::Separation;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EGTNavProjection NavProjection = EGTNavProjection::NavMesh;
+
+	/** Frames between evaluations of the unit's own animation, skipped frames are interpolated. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 AnimationUpdateRate = 1;
+
+	/** The unit's mesh copies a pose shared by every unit in its animation state instead of evaluating its own. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bShareAnimation = false;
+
+	/** The unit is drawn as an instance of its type's proxy mesh, its skeletal mesh is unregistered. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bDrawAsProxy = false;
+
+	/** Units created as entities get an actor spawned while they are in the bucket, see AGTPawnMovementManager::CreateUnitEntity. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bNeedsActor = false;
+
+	/** Frames between searches for the unit's closest hostile unit, it keeps its target in between. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 TargetingInterval = 1;
+};
+
+/** How one bucket's budget was used this frame. */
+struct FGTSignificanceBucketUsage
+{
+	int32 Units = 0;
+	/** Units rescored this frame that scored high enough for the bucket but found it full. */
+	int32 OverflowedUnits = 0;
+	/** Hot nav walking units of the bucket moved this frame. */
+	int32 MovementUpdates = 0;
+};
+
+/** Significance of a unit and the bucket of budgets it was given, one row per character unit in the manager. */
+struct FGTUnitSignificance
+{
+	float Score = 0.f;
+	/** Index into the manager's SignificanceBudgets. Units start in the first bucket until they are scored. */
+	uint8 Bucket = 0;
+	bool bSelected = false;
+	/** Time the unit's hot nav walking move is owed, moves skipped by its bucket's update interval add up here. */
+	float PendingDeltaTime = 0.f;
+	double LastCombatTime = -UE_BIG_NUMBER;
+};
+
+/** What the scoring knows about a unit. */
+struct FGTSignificanceFactors
+{
+	FVector Location = FVector::ZeroVector;
+	float Radius = 0.f;
+	bool bSelected = false;
+	bool bInCombat = false;
+	bool bOwnedByPlayer = false;
+};
+
+/**
+ * Scores units by how much the player would notice them being updated cheaply: how large they are on screen under
+ * the player's camera, whether they are selected, fighting, or the player's own. Off-screen units only score their
+ * bonuses. A score is a sum, a unit that is both selected and large on screen outranks one that is only selected.
+ */
+class GITTEST_API FGTSignificanceScorer
+{
+public:
+	/** Score of a unit filling the screen height, screen size is the fraction of it the unit's bounds cover. */
+	float ScreenSizeWeight = 10.f;
+	float SelectedBonus = 1.f;
+	float CombatBonus = 0.5f;
+	float OwnedBonus = 0.25f;
+
+	/** Reads the view of PlayerController's camera, false while it has none. */
+	bool SetView(const APlayerController& PlayerController);
+	bool HasView() const { return bHasView; }
+
+	float Score(const FGTSignificanceFactors& Factors) const;
+
+	/**
+	 * First bucket Score qualifies for that has room, given how many units each bucket holds. Budgets are ordered from
+	 * the most to the least significant, the last bucket takes every unit left. OutOverflowed is the bucket the score
+	 * qualified for first, INDEX_NONE if that one had room.
+	 */
+	static int32 PickBucket(TConstArrayView<FGTSignificanceBudget> Budgets, TConstArrayView<FGTSignificanceBucketUsage> Usage, float Score, int32& OutOverflowed);
+
+private:
+	FVector ViewOrigin = FVector::ZeroVector;
+	FMatrix ProjectionMatrix = FMatrix::Identity;
+	FConvexVolume ViewFrustum;
+	bool bHasView = false;
+};
@@ -0,0 +1,335 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GTUnitSpawner.h"
+
+#include "GTPawnMovementManager.h"
+#include "GTSquad.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("AGTUnitSpawner Tick"), STAT_AGTUnitSpawner_Tick, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AGTUnitSpawner Spawned This Frame"), STAT_AGTUnitSpawner_SpawnedThisFrame, STATGROUP_Game);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AGTUnitSpawner Pending Spawns"), STAT_AGTUnitSpawner_PendingSpawns, STATGROUP_Game);
+
+AGTUnitSpawner::AGTUnitSpawner()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	PreloadUnitClasses.Add(TSoftClassPtr<APawn>(FSoftObjectPath(TEXT("/Game/TopDown/Blueprints/BP_CharacterUnit.BP_CharacterUnit_C"))));
+	PreloadUnitClasses.Add(TSoftClassPtr<APawn>(FSoftObjectPath(TEXT("/Game/TopDown/Blueprints/BP_GTNewCharacter.BP_GTNewCharacter_C"))));
+}
+
+void AGTUnitSpawner::BeginPlay()
+{
+	Super::BeginPlay();
+
+	TArray<FSoftObjectPath> ClassPaths;
+	for (const TSoftClassPtr<APawn>& UnitClass : PreloadUnitClasses)
+	{
+		if (!UnitClass.IsNull() && !UnitClass.Get())
+		{
+			ClassPaths.Add(UnitClass.ToSoftObjectPath());
+		}
+	}
+
+	if (ClassPaths.Num() == 0)
+	{
+		bPreloadCompleted = true;
+		return;
+	}
+
+	PreloadHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(ClassPaths, FStreamableDelegate::CreateUObject(this, &AGTUnitSpawner::OnPreloadCompleted));
+	if (!PreloadHandle.IsValid())
+	{
+		bPreloadCompleted = true;
+	}
+}
+
+void AGTUnitSpawner::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (PreloadHandle.IsValid())
+	{
+		PreloadHandle->CancelHandle();
+		PreloadHandle.Reset();
+	}
+
+	for (TPair<int32, FActiveRequest>& Pair : ActiveRequests)
+	{
+		if (Pair.Value.LoadHandle.IsValid())
+		{
+			Pair.Value.LoadHandle->CancelHandle();
+		}
+	}
+	ActiveRequests.Empty();
+	PendingSpawns.Empty();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AGTUnitSpawner::OnPreloadCompleted()
+{
+	bPreloadCompleted = true;
+	PreloadHandle.Reset();
+}
+
+int32 AGTUnitSpawner::QueueSpawnRequest(const FGTSpawnRequest& Request)
+{
+	if (Request.UnitClass.IsNull() || Request.Count <= 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s ignored a spawn request without a unit class or count"), *GetName());
+		return INDEX_NONE;
+	}
+
+	const int32 RequestId = NextRequestId++;
+	FActiveRequest& ActiveRequest = ActiveRequests.Add(RequestId);
+	ActiveRequest.Id = RequestId;
+	ActiveRequest.Request = Request;
+	ActiveRequest.Remaining = Request.Count;
+	ActiveRequest.SpawnedUnits.Reserve(Request.Count);
+
+	if (AGTPawnMovementManager* MovementManager = AGTPawnMovementManager::Get(GetWorld()))
+	{
+		MovementManager->ReserveUnits(Request.Count);
+	}
+
+	if (Request.UnitClass.Get())
+	{
+		BuildSpawnLocations(ActiveRequest, PendingSpawns);
+		return RequestId;
+	}
+
+	// Classes that are not part of the preload list are streamed per request, its spawns are parked until the class
+	// is in. The load can complete before RequestAsyncLoad returns, so the spawns are parked first.
+	BuildSpawnLocations(ActiveRequest, ActiveRequest.WaitingSpawns);
+	TSharedPtr<FStreamableHandle> LoadHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(Request.UnitClass.ToSoftObjectPath(),
+		FStreamableDelegate::CreateUObject(this, &AGTUnitSpawner::OnRequestClassLoaded, RequestId));
+	if (!LoadHandle.IsValid())
+	{
+		OnRequestClassLoaded(RequestId);
+	}
+	else if (FActiveRequest* LoadingRequest = ActiveRequests.Find(RequestId))
+	{
+		LoadingRequest->LoadHandle = MoveTemp(LoadHandle);
+	}
+	return RequestId;
+}
+
+void AGTUnitSpawner::OnRequestClassLoaded(int32 RequestId)
+{
+	FActiveRequest* ActiveRequest = ActiveRequests.Find(RequestId);
+	if (ActiveRequest == nullptr || ActiveRequest->WaitingSpawns.Num() == 0)
+	{
+		return;
+	}
+
+	if (!ActiveRequest->Request.UnitClass.Get())
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s failed spawn request %d, unit class %s did not load"), *GetName(), RequestId, *ActiveRequest->Request.UnitClass.ToString());
+		CompleteRequest(RequestId);
+		return;
+	}
+
+	PendingSpawns.Append(MoveTemp(ActiveRequest->WaitingSpawns));
+	ActiveRequest->WaitingSpawns.Empty();
+	bPendingSpawnsDirty = true;
+}
+
+int32 AGTUnitSpawner::GetNumPendingSpawns() const
+{
+	int32 NumPendingSpawns = PendingSpawns.Num();
+	for (const TPair<int32, FActiveRequest>& Pair : ActiveRequests)
+	{
+		NumPendingSpawns += Pair.Value.WaitingSpawns.Num();
+	}
+	return NumPendingSpawns;
+}
+
+void AGTUnitSpawner::BuildSpawnLocations(const FActiveRequest& ActiveRequest, TArray<FPendingSpawn>& OutSpawns)
+{
+	const FGTSpawnRequest& Request = ActiveRequest.Request;
+	const float Spacing = FMath::Max(Request.Spacing, 1.f);
+	const int32 FirstSpawn = OutSpawns.Num();
+	OutSpawns.Reserve(OutSpawns.Num() + Request.Count);
+
+	switch (Request.Formation)
+	{
+	case EGTSpawnFormation::Grid:
+		{
+			const int32 Columns = FMath::Max(1, FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Request.Count))));
+			const int32 Rows = FMath::DivideAndRoundUp(Request.Count, Columns);
+			const FVector Origin = Request.Center - FVector((Columns - 1) * Spacing * 0.5f, (Rows - 1) * Spacing * 0.5f, 0.f);
+			for (int32 Index = 0; Index < Request.Count; ++Index)
+			{
+				const FVector Offset((Index % Columns) * Spacing, (Index / Columns) * Spacing, 0.f);
+				OutSpawns.Add({Origin + Offset, ActiveRequest.Id});
+			}
+		}
+		break;
+	case EGTSpawnFormation::Circle:
+		{
+			// Sunflower packing keeps an even density for any count without building explicit rings.
+			const float GoldenAngle = UE_PI * (3.f - FMath::Sqrt(5.f));
+			for (int32 Index = 0; Index < Request.Count; ++Index)
+			{
+				const float Radius = Spacing * 0.5f * FMath::Sqrt(static_cast<float>(Index));
+				const float Angle = Index * GoldenAngle;
+				OutSpawns.Add({Request.Center + FVector(FMath::Cos(Angle) * Radius, FMath::Sin(Angle) * Radius, 0.f), ActiveRequest.Id});
+			}
+		}
+		break;
+	case EGTSpawnFormation::Random:
+		{
+			FRandomStream RandomStream(ActiveRequest.Id);
+			for (int32 Index = 0; Index < Request.Count; ++Index)
+			{
+				const FVector Offset(RandomStream.FRandRange(-Request.Extent.X, Request.Extent.X), RandomStream.FRandRange(-Request.Extent.Y, Request.Extent.Y), 0.f);
+				OutSpawns.Add({Request.Center + Offset, ActiveRequest.Id});
+			}
+		}
+		break;
+	}
+
+	// Snapped in one batch so the whole layout shares the heightfield tiles it samples.
+	if (AGTPawnMovementManager* MovementManager = AGTPawnMovementManager::Get(GetWorld()))
+	{
+		FGTGroundQuery& GroundQuery = MovementManager->GetGroundQuery();
+		for (int32 Index = FirstSpawn; Index < OutSpawns.Num(); ++Index)
+		{
+			FPendingSpawn& PendingSpawn = OutSpawns[Index];
+			float GroundHeight;
+			if (GroundQuery.GetGroundHeight(FVector2D(PendingSpawn.Location), GroundHeight))
+			{
+				PendingSpawn.Location.Z = GroundHeight;
+				PendingSpawn.bOnGround = true;
+			}
+		}
+	}
+
+	bPendingSpawnsDirty = true;
+}
+
+bool AGTUnitSpawner::GetCameraLocation(FVector& OutLocation) const
+{
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	if (PlayerController && PlayerController->PlayerCameraManager)
+	{
+		OutLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+		return true;
+	}
+	return false;
+}
+
+void AGTUnitSpawner::SortPendingSpawns(const FVector& CameraLocation)
+{
+	PendingSpawns.Sort([&CameraLocation](const FPendingSpawn& A, const FPendingSpawn& B)
+	{
+		return FVector::DistSquared2D(A.Location, CameraLocation) > FVector::DistSquared2D(B.Location, CameraLocation);
+	});
+	LastSortCameraLocation = CameraLocation;
+	bPendingSpawnsDirty = false;
+}
+
+void AGTUnitSpawner::SpawnUnit(const FPendingSpawn& PendingSpawn, FActiveRequest& ActiveRequest)
+{
+	FActorSpawnParameters SpawnParameters;
+	// Units are laid out by the formation, the per-spawn encroachment test is most of the spawn cost at this scale.
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	UClass* UnitClass = ActiveRequest.Request.UnitClass.Get();
+	FVector Location = PendingSpawn.Location;
+	if (PendingSpawn.bOnGround)
+	{
+		// Ground snapped locations are at the feet, the unit is spawned at its root.
+		Location.Z += UnitClass->GetDefaultObject<APawn>()->GetDefaultHalfHeight();
+	}
+
+	AGTSquad* Squad = ActiveRequest.Request.Squad;
+	if (IsValid(Squad))
+	{
+		// Deferred so the default controller is never spawned for squad driven units.
+		const FTransform SpawnTransform(Location);
+		if (APawn* Unit = GetWorld()->SpawnActorDeferred<APawn>(UnitClass, SpawnTransform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn))
+		{
+			Unit->AutoPossessAI = EAutoPossessAI::Disabled;
+			Unit->FinishSpawning(SpawnTransform);
+			Squad->AddUnit(Unit);
+			ActiveRequest.SpawnedUnits.Add(Unit);
+		}
+	}
+	else if (APawn* Unit = GetWorld()->SpawnActor<APawn>(UnitClass, Location, FRotator::ZeroRotator, SpawnParameters))
+	{
+		ActiveRequest.SpawnedUnits.Add(Unit);
+	}
+	--ActiveRequest.Remaining;
+}
+
+void AGTUnitSpawner::CompleteRequest(int32 RequestId)
+{
+	FActiveRequest ActiveRequest;
+	if (!ActiveRequests.RemoveAndCopyValue(RequestId, ActiveRequest))
+	{
+		return;
+	}
+
+	TArray<APawn*> SpawnedUnits;
+	SpawnedUnits.Reserve(ActiveRequest.SpawnedUnits.Num());
+	for (const TWeakObjectPtr<APawn>& Unit : ActiveRequest.SpawnedUnits)
+	{
+		if (APawn* SpawnedUnit = Unit.Get())
+		{
+			SpawnedUnits.Add(SpawnedUnit);
+		}
+	}
+	OnSpawnRequestCompleted.Broadcast(RequestId, SpawnedUnits);
+}
+
+void AGTUnitSpawner::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AGTUnitSpawner_Tick);
+	Super::Tick(DeltaTime);
+
+	SET_DWORD_STAT(STAT_AGTUnitSpawner_PendingSpawns, PendingSpawns.Num());
+	if (!bPreloadCompleted || PendingSpawns.Num() == 0)
+	{
+		return;
+	}
+
+	FVector CameraLocation;
+	if (GetCameraLocation(CameraLocation) && (bPendingSpawnsDirty || FVector::DistSquared2D(CameraLocation, LastSortCameraLocation) > FMath::Square(CameraResortDistance)))
+	{
+		SortPendingSpawns(CameraLocation);
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	const double BudgetSeconds = SpawnBudgetMs * 0.001;
+	int32 SpawnedThisFrame = 0;
+
+	while (PendingSpawns.Num() > 0)
+	{
+		if (SpawnedThisFrame >= MinSpawnsPerFrame && FPlatformTime::Seconds() - StartTime > BudgetSeconds)
+		{
+			break;
+		}
+
+		const FPendingSpawn PendingSpawn = PendingSpawns.Pop(false);
+		FActiveRequest* ActiveRequest = ActiveRequests.Find(PendingSpawn.RequestId);
+		if (ActiveRequest == nullptr)
+		{
+			continue;
+		}
+
+		SpawnUnit(PendingSpawn, *ActiveRequest);
+		++SpawnedThisFrame;
+
+		if (ActiveRequest->Remaining <= 0)
+		{
+			CompleteRequest(ActiveRequest->Id);
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_AGTUnitSpawner_SpawnedThisFrame, SpawnedThisFrame);
+}
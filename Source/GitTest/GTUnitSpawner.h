@@ -0,0 +1,138 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "GTUnitSpawner.generated.h"
+
+class AGTSquad;
+struct FStreamableHandle;
+
+UENUM(BlueprintType)
+enum class EGTSpawnFormation : uint8
+{
+	Grid,
+	Circle,
+	Random
+};
+
+USTRUCT(BlueprintType)
+struct FGTSpawnRequest
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TSoftClassPtr<APawn> UnitClass;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(ClampMin="1"))
+	int32 Count = 1;
+
+	/** Center of the spawn area, units keep its Z. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector Center = FVector::ZeroVector;
+
+	/** Half size of the spawn area for Random. Grid and Circle grow with Count and Spacing instead. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector2D Extent = FVector2D(500.f, 500.f);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EGTSpawnFormation Formation = EGTSpawnFormation::Grid;
+
+	/** Distance between neighbouring units for Grid and Circle. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Spacing = 100.f;
+
+	/** When set, units are spawned without an AI controller and added to this squad. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	AGTSquad* Squad = nullptr;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FGTOnSpawnRequestCompleted, int32, RequestId, const TArray<APawn*>&, SpawnedUnits);
+
+/**
+ * Spreads bulk unit spawns over several frames under a time budget.
+ * Spawns closest to the camera go first and unit classes are streamed in before the first batch.
+ */
+UCLASS()
+class GITTEST_API AGTUnitSpawner : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AGTUnitSpawner();
+	virtual void Tick(float DeltaTime) override;
+
+	/** Queues Request and returns its id, which is passed back through OnSpawnRequestCompleted. */
+	UFUNCTION(BlueprintCallable)
+	int32 QueueSpawnRequest(const FGTSpawnRequest& Request);
+
+	UFUNCTION(BlueprintPure)
+	int32 GetNumPendingSpawns() const;
+
+	UPROPERTY(BlueprintAssignable)
+	FGTOnSpawnRequestCompleted OnSpawnRequestCompleted;
+
+	/** Game thread time spent spawning per frame, in milliseconds. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(ClampMin="0.1"))
+	float SpawnBudgetMs = 2.f;
+
+	/** Spawns done every frame even if one spawn is already over budget, so requests always progress. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(ClampMin="1"))
+	int32 MinSpawnsPerFrame = 1;
+
+	/** Pending spawns are re-sorted when the camera moves further than this. */
+	UPROPERTY(EditAnywhere)
+	float CameraResortDistance = 500.f;
+
+	/** Unit classes streamed in at BeginPlay. No spawn happens before they are loaded. */
+	UPROPERTY(EditDefaultsOnly)
+	TArray<TSoftClassPtr<APawn>> PreloadUnitClasses;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	struct FPendingSpawn
+	{
+		FVector Location;
+		int32 RequestId;
+		/** Location was snapped to the ground and is where the unit's feet go. */
+		bool bOnGround = false;
+	};
+
+	struct FActiveRequest
+	{
+		int32 Id = INDEX_NONE;
+		FGTSpawnRequest Request;
+		int32 Remaining = 0;
+		/** Weak, units can be destroyed before the request completes. */
+		TArray<TWeakObjectPtr<APawn>> SpawnedUnits;
+		TSharedPtr<FStreamableHandle> LoadHandle;
+		/** Spawns parked until the unit class has streamed in, they are only sorted with the others after. */
+		TArray<FPendingSpawn> WaitingSpawns;
+	};
+
+	void OnPreloadCompleted();
+	/** Releases the parked spawns of RequestId, or fails the request when its unit class did not load. */
+	void OnRequestClassLoaded(int32 RequestId);
+	void BuildSpawnLocations(const FActiveRequest& ActiveRequest, TArray<FPendingSpawn>& OutSpawns);
+	void SortPendingSpawns(const FVector& CameraLocation);
+	bool GetCameraLocation(FVector& OutLocation) const;
+	void SpawnUnit(const FPendingSpawn& PendingSpawn, FActiveRequest& ActiveRequest);
+	/** Removes the request and broadcasts the units it spawned that are still alive. */
+	void CompleteRequest(int32 RequestId);
+
+	TSharedPtr<FStreamableHandle> PreloadHandle;
+	bool bPreloadCompleted = false;
+
+	TMap<int32, FActiveRequest> ActiveRequests;
+
+	/** Sorted furthest first so the next spawn is popped from the back. */
+	TArray<FPendingSpawn> PendingSpawns;
+	bool bPendingSpawnsDirty = false;
+	FVector LastSortCameraLocation = FVector::ZeroVector;
+
+	int32 NextRequestId = 0;
+};
@@ -2,6 +2,7 @@
 
 #include "GitTestPlayerController.h"
 #include "GameFramework/Pawn.h"
+#include "Algo/BinarySearch.h"
 #include "Blueprint/AIBlueprintHelperLibrary.h"
 #include "NiagaraSystem.h"
 #include "NiagaraFunctionLibrary.h"
@@ -9,6 +10,8 @@
 #include "Engine/World.h"
 #include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
+#include "GTCharacterMovementComponent.h"
+#include "GTPawnMovementManager.h"
 
 AGitTestPlayerController::AGitTestPlayerController()
 {
@@ -49,11 +52,345 @@ void AGitTestPlayerController::SetupInputComponent()
 		EnhancedInputComponent->BindAction(SetDestinationTouchAction, ETriggerEvent::Triggered, this, &AGitTestPlayerController::OnTouchTriggered);
 		EnhancedInputComponent->BindAction(SetDestinationTouchAction, ETriggerEvent::Completed, this, &AGitTestPlayerController::OnTouchReleased);
 		EnhancedInputComponent->BindAction(SetDestinationTouchAction, ETriggerEvent::Canceled, this, &AGitTestPlayerController::OnTouchReleased);
+
+		// Setup selection events
+		if (SelectAction)
+		{
+			EnhancedInputComponent->BindAction(SelectAction, ETriggerEvent::Started, this, &AGitTestPlayerController::OnSelectStarted);
+			EnhancedInputComponent->BindAction(SelectAction, ETriggerEvent::Triggered, this, &AGitTestPlayerController::OnSelectTriggered);
+			EnhancedInputComponent->BindAction(SelectAction, ETriggerEvent::Completed, this, &AGitTestPlayerController::OnSelectReleased);
+			EnhancedInputComponent->BindAction(SelectAction, ETriggerEvent::Canceled, this, &AGitTestPlayerController::OnSelectReleased);
+		}
+
+		// Setup command events
+		if (QueueCommandAction)
+		{
+			EnhancedInputComponent->BindAction(QueueCommandAction, ETriggerEvent::Started, this, &AGitTestPlayerController::OnQueueCommandStarted);
+			EnhancedInputComponent->BindAction(QueueCommandAction, ETriggerEvent::Completed, this, &AGitTestPlayerController::OnQueueCommandReleased);
+			EnhancedInputComponent->BindAction(QueueCommandAction, ETriggerEvent::Canceled, this, &AGitTestPlayerController::OnQueueCommandReleased);
+		}
+		if (AttackMoveAction)
+		{
+			EnhancedInputComponent->BindAction(AttackMoveAction, ETriggerEvent::Started, this, &AGitTestPlayerController::OnAttackMoveStarted);
+		}
+		if (StopAction)
+		{
+			EnhancedInputComponent->BindAction(StopAction, ETriggerEvent::Started, this, &AGitTestPlayerController::OnStopStarted);
+		}
 	}
 }
 
+void AGitTestPlayerController::SetSelectedUnits(const TArray<APawn*>& Units)
+{
+	ScratchSelection.Reset();
+	for (const APawn* Unit : Units)
+	{
+		const UGTCharacterMovementComponent* MovementComponent = IsValid(Unit) ? Cast<UGTCharacterMovementComponent>(Unit->GetMovementComponent()) : nullptr;
+		if (MovementComponent && MovementComponent->GetUnitId() != INDEX_NONE)
+		{
+			ScratchSelection.Add(MovementComponent->GetUnitId());
+		}
+	}
+	SetSelection(ScratchSelection, false);
+}
+
+TArray<APawn*> AGitTestPlayerController::GetSelectedUnits() const
+{
+	TArray<APawn*> Units;
+	if (IsValid(MovementManager))
+	{
+		for (const int32 UnitId : SelectedUnitIds)
+		{
+			if (const UGTCharacterMovementComponent* MovementComponent = MovementManager->GetUnitMovementComponent(UnitId))
+			{
+				Units.Add(MovementComponent->GetPawnOwner());
+			}
+		}
+	}
+	return Units;
+}
+
+void AGitTestPlayerController::SetSelection(TArray<int32>& UnitIds, bool bAddToSelection)
+{
+	if (bAddToSelection)
+	{
+		UnitIds.Append(SelectedUnitIds);
+	}
+
+	// Selected units rank higher in the manager's significance buckets.
+	AGTPawnMovementManager* Manager = GetMovementManager();
+	if (Manager)
+	{
+		for (const int32 UnitId : SelectedUnitIds)
+		{
+			Manager->SetUnitSelected(UnitId, false);
+		}
+	}
+
+	// Sorted and unique, so the commands recorded for it are already in id order.
+	UnitIds.Sort();
+	SelectedUnitIds.Reset(UnitIds.Num());
+	for (int32 Index = 0; Index < UnitIds.Num(); ++Index)
+	{
+		if (Index == 0 || UnitIds[Index] != UnitIds[Index - 1])
+		{
+			SelectedUnitIds.Add(UnitIds[Index]);
+			if (Manager)
+			{
+				Manager->SetUnitSelected(UnitIds[Index], true);
+			}
+		}
+	}
+}
+
+bool AGitTestPlayerController::DeprojectToGround(const FVector2D& ScreenPosition, const FPlane& GroundPlane, FVector& OutLocation) const
+{
+	FVector WorldLocation;
+	FVector WorldDirection;
+	if (!DeprojectScreenPositionToWorld(ScreenPosition.X, ScreenPosition.Y, WorldLocation, WorldDirection) || WorldDirection.Z > -UE_KINDA_SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	OutLocation = FMath::RayPlaneIntersection(WorldLocation, WorldDirection, GroundPlane);
+	return true;
+}
+
+void AGitTestPlayerController::SelectUnitsInScreenBox(const FVector2D& ScreenStart, const FVector2D& ScreenEnd, bool bAddToSelection)
+{
+	AGTPawnMovementManager* Manager = GetMovementManager();
+	if (Manager == nullptr)
+	{
+		return;
+	}
+
+	// The box is projected onto the ground under its center, which turns it into a quad on the plane the units stand on.
+	FHitResult Hit;
+	const FVector2D Center = (ScreenStart + ScreenEnd) * 0.5f;
+	const float GroundZ = GetHitResultAtScreenPosition(Center, ECollisionChannel::ECC_Visibility, true, Hit) ? Hit.Location.Z : 0.f;
+	const FPlane GroundPlane(FVector(0.f, 0.f, GroundZ), FVector::UpVector);
+
+	const FVector2D ScreenCorners[4] = {ScreenStart, FVector2D(ScreenEnd.X, ScreenStart.Y), ScreenEnd, FVector2D(ScreenStart.X, ScreenEnd.Y)};
+	FVector2D GroundCorners[4];
+	for (int32 Index = 0; Index < 4; ++Index)
+	{
+		FVector GroundLocation;
+		if (!DeprojectToGround(ScreenCorners[Index], GroundPlane, GroundLocation))
+		{
+			return;
+		}
+		GroundCorners[Index] = FVector2D(GroundLocation);
+	}
+
+	ScratchSelection.Reset();
+	Manager->GetUnitGrid().QueryConvexQuad(GroundCorners, ScratchSelection);
+	ScratchSelection.RemoveAllSwap([this, Manager](int32 UnitId) { return !CanSelectUnit(*Manager, UnitId); }, false);
+	SetSelection(ScratchSelection, bAddToSelection);
+}
+
+void AGitTestPlayerController::SelectUnitAtScreenPosition(const FVector2D& ScreenPosition, bool bAddToSelection)
+{
+	AGTPawnMovementManager* Manager = GetMovementManager();
+	FHitResult Hit;
+	if (Manager == nullptr || !GetHitResultAtScreenPosition(ScreenPosition, ECollisionChannel::ECC_Visibility, true, Hit))
+	{
+		return;
+	}
+
+	// The nearest unit the player may select, an enemy standing closer to the click does not hide it.
+	int32 NearestUnitId = INDEX_NONE;
+	float NearestDistanceSquared = TNumericLimits<float>::Max();
+	const FVector2f ClickLocation(Hit.Location.X, Hit.Location.Y);
+	Manager->GetUnitGrid().ForEachInRadius(ClickLocation, ClickSelectionRadius, [this, Manager, &ClickLocation, &NearestUnitId, &NearestDistanceSquared](int32 UnitId)
+	{
+		const float DistanceSquared = FVector2f::DistSquared(FVector2f(FVector2D(Manager->GetUnitLocation(UnitId))), ClickLocation);
+		if (DistanceSquared < NearestDistanceSquared && CanSelectUnit(*Manager, UnitId))
+		{
+			NearestDistanceSquared = DistanceSquared;
+			NearestUnitId = UnitId;
+		}
+	});
+
+	ScratchSelection.Reset();
+	if (NearestUnitId != INDEX_NONE)
+	{
+		ScratchSelection.Add(NearestUnitId);
+	}
+	SetSelection(ScratchSelection, bAddToSelection);
+}
+
+bool AGitTestPlayerController::CanSelectUnit(const AGTPawnMovementManager& Manager, int32 UnitId) const
+{
+	const FGenericTeamId PlayerTeamId = FGenericTeamId::GetTeamIdentifier(this);
+	return PlayerTeamId == FGenericTeamId::NoTeam || Manager.GetUnitTeamId(UnitId) == PlayerTeamId;
+}
+
+void AGitTestPlayerController::OnSelectStarted()
+{
+	float MouseX;
+	float MouseY;
+	bIsSelecting = GetMousePosition(MouseX, MouseY);
+	SelectionStart = SelectionEnd = FVector2D(MouseX, MouseY);
+}
+
+void AGitTestPlayerController::OnSelectTriggered()
+{
+	float MouseX;
+	float MouseY;
+	if (bIsSelecting && GetMousePosition(MouseX, MouseY))
+	{
+		SelectionEnd = FVector2D(MouseX, MouseY);
+	}
+}
+
+void AGitTestPlayerController::OnSelectReleased()
+{
+	if (!bIsSelecting)
+	{
+		return;
+	}
+	bIsSelecting = false;
+
+	const bool bAddToSelection = bQueueCommandHeld;
+	const FVector2D BoxSize = (SelectionEnd - SelectionStart).GetAbs();
+	if (FMath::Max(BoxSize.X, BoxSize.Y) < MinSelectionBoxSize)
+	{
+		SelectUnitAtScreenPosition(SelectionEnd, bAddToSelection);
+	}
+	else
+	{
+		SelectUnitsInScreenBox(SelectionStart, SelectionEnd, bAddToSelection);
+	}
+}
+
+void AGitTestPlayerController::OnQueueCommandStarted()
+{
+	bQueueCommandHeld = true;
+}
+
+void AGitTestPlayerController::OnQueueCommandReleased()
+{
+	bQueueCommandHeld = false;
+}
+
+void AGitTestPlayerController::OnAttackMoveStarted()
+{
+	// Armed until the next move order, like pressing attack-move and then clicking the destination.
+	bAttackMoveArmed = SelectedUnitIds.Num() > 0;
+}
+
+void AGitTestPlayerController::OnStopStarted()
+{
+	bAttackMoveArmed = false;
+	IssueCommand(EGTUnitCommandType::Stop, FVector::ZeroVector);
+}
+
+AGTPawnMovementManager* AGitTestPlayerController::GetMovementManager()
+{
+	if (!IsValid(MovementManager))
+	{
+		MovementManager = AGTPawnMovementManager::Get(GetWorld());
+		if (MovementManager)
+		{
+			MovementManager->OnUnitRemoved.AddUObject(this, &AGitTestPlayerController::OnUnitRemoved);
+		}
+	}
+	return MovementManager;
+}
+
+void AGitTestPlayerController::OnUnitRemoved(int32 UnitId)
+{
+	const int32 Index = Algo::BinarySearch(SelectedUnitIds, UnitId);
+	if (Index != INDEX_NONE)
+	{
+		SelectedUnitIds.RemoveAt(Index, 1, false);
+	}
+}
+
+void AGitTestPlayerController::IssueCommand(EGTUnitCommandType Type, const FVector& Target)
+{
+	AGTPawnMovementManager* Manager = GetMovementManager();
+	if (Manager == nullptr)
+	{
+		return;
+	}
+
+	ScratchCommands.Reset();
+	ScratchUnitLocations.Reset();
+	// Entity units without an actor take orders like every other unit, the manager only needs their id.
+	for (const int32 UnitId : SelectedUnitIds)
+	{
+		if (Manager->GetUnitSlot(UnitId) != INDEX_NONE)
+		{
+			FGTUnitCommand& Command = ScratchCommands.AddDefaulted_GetRef();
+			Command.UnitId = UnitId;
+			Command.Type = Type;
+			Command.Target = Target;
+			ScratchUnitLocations.Add(Manager->GetUnitLocation(UnitId));
+		}
+	}
+
+	// Units sent to the same point would pile up on it, so each one gets its own slot around it.
+	if (Type != EGTUnitCommandType::Stop && ScratchCommands.Num() > 1)
+	{
+		FVector GroupCenter = FVector::ZeroVector;
+		for (const FVector& UnitLocation : ScratchUnitLocations)
+		{
+			GroupCenter += UnitLocation;
+		}
+		GroupCenter /= ScratchUnitLocations.Num();
+
+		SelectionFormation.BuildLocalSlots(ScratchCommands.Num(), ScratchLocalSlots);
+		ScratchSlotLocations.Reset(ScratchLocalSlots.Num());
+		for (const FVector2D& LocalSlot : ScratchLocalSlots)
+		{
+			ScratchSlotLocations.Add(Target + GTFormation::ToWorldOffset(LocalSlot, Target - GroupCenter));
+		}
+		Manager->GetGroundQuery().SnapToGround(ScratchSlotLocations);
+
+		GTFormation::AssignSlots(ScratchUnitLocations, ScratchSlotLocations, ScratchSlotForUnit);
+		for (int32 Index = 0; Index < ScratchCommands.Num(); ++Index)
+		{
+			ScratchCommands[Index].Target = ScratchSlotLocations[ScratchSlotForUnit[Index]];
+		}
+	}
+
+	Manager->EnqueueCommands(ScratchCommands);
+}
+
+bool AGitTestPlayerController::GetGroundUnderPointer(FVector& OutLocation)
+{
+	AGTPawnMovementManager* Manager = GetMovementManager();
+	if (Manager == nullptr)
+	{
+		return false;
+	}
+
+	float ScreenX;
+	float ScreenY;
+	bool bIsPressed = true;
+	if (bIsTouch)
+	{
+		GetInputTouchState(ETouchIndex::Touch1, ScreenX, ScreenY, bIsPressed);
+	}
+	else
+	{
+		bIsPressed = GetMousePosition(ScreenX, ScreenY);
+	}
+
+	FVector WorldLocation;
+	FVector WorldDirection;
+	return bIsPressed && DeprojectScreenPositionToWorld(ScreenX, ScreenY, WorldLocation, WorldDirection)
+		&& Manager->GetGroundQuery().TraceRay(WorldLocation, WorldDirection, OutLocation);
+}
+
 void AGitTestPlayerController::OnInputStarted()
 {
+	if (SelectedUnitIds.Num() > 0)
+	{
+		return;
+	}
+
 	StopMovement();
 }
 
@@ -64,26 +401,35 @@ void AGitTestPlayerController::OnSetDestinationTriggered()
 	FollowTime += GetWorld()->GetDeltaSeconds();
 	
 	// We look for the location in the world where the player has pressed the input
-	FHitResult Hit;
-	bool bHitSuccessful = false;
-	if (bIsTouch)
+	FVector GroundLocation;
+	if (GetGroundUnderPointer(GroundLocation))
 	{
-		bHitSuccessful = GetHitResultUnderFinger(ETouchIndex::Touch1, ECollisionChannel::ECC_Visibility, true, Hit);
+		CachedDestination = GroundLocation;
 	}
 	else
 	{
-		bHitSuccessful = GetHitResultUnderCursor(ECollisionChannel::ECC_Visibility, true, Hit);
-	}
+		// Nothing the ground query knows about, fall back to a full trace
+		FHitResult Hit;
+		bool bHitSuccessful = false;
+		if (bIsTouch)
+		{
+			bHitSuccessful = GetHitResultUnderFinger(ETouchIndex::Touch1, ECollisionChannel::ECC_Visibility, true, Hit);
+		}
+		else
+		{
+			bHitSuccessful = GetHitResultUnderCursor(ECollisionChannel::ECC_Visibility, true, Hit);
+		}
 
-	// If we hit a surface, cache the location
-	if (bHitSuccessful)
-	{
-		CachedDestination = Hit.Location;
+		// If we hit a surface, cache the location
+		if (bHitSuccessful)
+		{
+			CachedDestination = Hit.Location;
+		}
 	}
 	
-	// Move towards mouse pointer or touch
+	// Move towards mouse pointer or touch, selected units only get an order on release
 	APawn* ControlledPawn = GetPawn();
-	if (ControlledPawn != nullptr)
+	if (ControlledPawn != nullptr && SelectedUnitIds.Num() == 0)
 	{
 		FVector WorldDirection = (CachedDestination - ControlledPawn->GetActorLocation()).GetSafeNormal();
 		ControlledPawn->AddMovementInput(WorldDirection, 1.0, false);
@@ -96,7 +442,15 @@ void AGitTestPlayerController::OnSetDestinationReleased()
 	if (FollowTime <= ShortPressThreshold)
 	{
 		// We move there and spawn some particles
-		UAIBlueprintHelperLibrary::SimpleMoveToLocation(this, CachedDestination);
+		if (SelectedUnitIds.Num() > 0)
+		{
+			IssueCommand(bQueueCommandHeld ? EGTUnitCommandType::QueueWaypoint : bAttackMoveArmed ? EGTUnitCommandType::AttackMove : EGTUnitCommandType::Move, CachedDestination);
+			bAttackMoveArmed = false;
+		}
+		else
+		{
+			UAIBlueprintHelperLibrary::SimpleMoveToLocation(this, CachedDestination);
+		}
 		UNiagaraFunctionLibrary::SpawnSystemAtLocation(this, FXCursor, CachedDestination, FRotator::ZeroRotator, FVector(1.f, 1.f, 1.f), true, true, ENCPoolMethod::None, true);
 	}
 
@@ -6,10 +6,13 @@
 #include "Templates/SubclassOf.h"
 #include "GameFramework/PlayerController.h"
 #include "InputActionValue.h"
+#include "GTFormation.h"
+#include "GTUnitCommand.h"
 #include "GitTestPlayerController.generated.h"
 
 /** Forward declaration to improve compiling times */
 class UNiagaraSystem;
+class AGTPawnMovementManager;
 
 UCLASS()
 class AGitTestPlayerController : public APlayerController
@@ -39,6 +42,62 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Input, meta=(AllowPrivateAccess = "true"))
 	class UInputAction* SetDestinationTouchAction;
 
+	/** Click selects the unit under the cursor, drag selects every unit inside the box. Held with QueueCommandAction, adds to the selection. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Input, meta=(AllowPrivateAccess = "true"))
+	class UInputAction* SelectAction;
+
+	/** Held modifier, move orders are queued as waypoints and selections add to the current one. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Input, meta=(AllowPrivateAccess = "true"))
+	class UInputAction* QueueCommandAction;
+
+	/** Turns the next move order into an attack-move. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Input, meta=(AllowPrivateAccess = "true"))
+	class UInputAction* AttackMoveAction;
+
+	/** Stops the selected units. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Input, meta=(AllowPrivateAccess = "true"))
+	class UInputAction* StopAction;
+
+	/** Drags shorter than this, in pixels, are clicks. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Selection)
+	float MinSelectionBoxSize = 8.f;
+
+	/** How far from the clicked ground point a unit can be picked by a click. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Selection)
+	float ClickSelectionRadius = 100.f;
+
+	/** Layout the selected units spread into around a clicked destination. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Selection)
+	FGTFormationLayout SelectionFormation;
+
+	UFUNCTION(BlueprintCallable, Category = Selection)
+	void SetSelectedUnits(const TArray<APawn*>& Units);
+
+	/** Pawns of the selected units. Entity units without an actor have none and are only in GetSelectedUnitIds. */
+	UFUNCTION(BlueprintPure, Category = Selection)
+	TArray<APawn*> GetSelectedUnits() const;
+
+	/** Unit ids of the selection, sorted. While empty, the controlled pawn is moved directly. */
+	TConstArrayView<int32> GetSelectedUnitIds() const { return SelectedUnitIds; }
+
+	/** Selects the units inside the screen rectangle through the movement manager's unit grid. */
+	void SelectUnitsInScreenBox(const FVector2D& ScreenStart, const FVector2D& ScreenEnd, bool bAddToSelection);
+	void SelectUnitAtScreenPosition(const FVector2D& ScreenPosition, bool bAddToSelection);
+
+	/** Selection box being dragged, in screen space, for the HUD to draw. */
+	UPROPERTY(BlueprintReadOnly, Category = Selection)
+	bool bIsSelecting = false;
+
+	UPROPERTY(BlueprintReadOnly, Category = Selection)
+	FVector2D SelectionStart = FVector2D::ZeroVector;
+
+	UPROPERTY(BlueprintReadOnly, Category = Selection)
+	FVector2D SelectionEnd = FVector2D::ZeroVector;
+
+	/** Records Type for every selected unit, move orders spread the units over SelectionFormation around Target. */
+	UFUNCTION(BlueprintCallable, Category = Selection)
+	void IssueCommand(EGTUnitCommandType Type, const FVector& Target);
+
 protected:
 	/** True if the controlled character should navigate to the mouse cursor. */
 	uint32 bMoveToMouseCursor : 1;
@@ -55,9 +114,45 @@ protected:
 	void OnTouchTriggered();
 	void OnTouchReleased();
 
+	/** Input handlers for Select action. */
+	void OnSelectStarted();
+	void OnSelectTriggered();
+	void OnSelectReleased();
+
+	/** Input handlers for the command actions. */
+	void OnQueueCommandStarted();
+	void OnQueueCommandReleased();
+	void OnAttackMoveStarted();
+	void OnStopStarted();
+
 private:
+	AGTPawnMovementManager* GetMovementManager();
+	/** Ground under the cursor or finger from the movement manager's ground query, without a physics trace against static geometry. */
+	bool GetGroundUnderPointer(FVector& OutLocation);
+	bool DeprojectToGround(const FVector2D& ScreenPosition, const FPlane& GroundPlane, FVector& OutLocation) const;
+	void SetSelection(TArray<int32>& UnitIds, bool bAddToSelection);
+	/** Whether the player may select the unit, only units of the player's team while the player has one. */
+	bool CanSelectUnit(const AGTPawnMovementManager& Manager, int32 UnitId) const;
+	/** Drops a removed unit from the selection before its id is handed to another unit. */
+	void OnUnitRemoved(int32 UnitId);
+
+	TArray<int32> SelectedUnitIds;
+	TArray<int32> ScratchSelection;
+
 	FVector CachedDestination;
 
+	UPROPERTY()
+	AGTPawnMovementManager* MovementManager;
+
+	TArray<FGTUnitCommand> ScratchCommands;
+	TArray<FVector> ScratchUnitLocations;
+	TArray<FVector> ScratchSlotLocations;
+	TArray<FVector2D> ScratchLocalSlots;
+	TArray<int32> ScratchSlotForUnit;
+
+	bool bQueueCommandHeld = false;
+	bool bAttackMoveArmed = false;
+
 	bool bIsTouch; // Is it a touch device
 	float FollowTime; // For how long it has been pressed
 };